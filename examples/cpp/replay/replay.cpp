@@ -0,0 +1,94 @@
+//
+// Re-runs slow-cell captures as a benchmark.
+//
+// Captures are written by PHREEQC when a calculation exceeds the KNOBS
+// -capture_iterations or -capture_time threshold, for example
+//
+//   KNOBS
+//     -capture_iterations 50
+//     -capture_file       slow_cell
+//
+// Usage: replay [-n repeats] database capture [capture ...]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <IPhreeqc.hpp>
+
+// reads "#   database_hash xxxxxxxx" from the capture header
+static std::string CaptureHash(const char *filename)
+{
+	std::ifstream ifs(filename);
+	std::string line;
+	while (std::getline(ifs, line) && line.size() > 0 && line[0] == '#')
+	{
+		std::istringstream iss(line.substr(1));
+		std::string key, value;
+		if ((iss >> key >> value) && key == "database_hash")
+		{
+			return value;
+		}
+	}
+	return std::string("unknown");
+}
+
+int main(int argc, char *argv[])
+{
+	int repeats = 10;
+	int arg = 1;
+	if (argc > 2 && strcmp(argv[1], "-n") == 0)
+	{
+		repeats = atoi(argv[2]);
+		arg = 3;
+	}
+	if (argc - arg < 2 || repeats < 1)
+	{
+		fprintf(stderr, "Usage: %s [-n repeats] database capture [capture ...]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	const char *database = argv[arg++];
+
+	IPhreeqc iphreeqc;
+	if (iphreeqc.LoadDatabase(database) != 0)
+	{
+		iphreeqc.OutputErrorString();
+		return EXIT_FAILURE;
+	}
+	std::string db_hash = iphreeqc.GetDatabaseHash();
+
+	int failures = 0;
+	double total = 0.0;
+	printf("%-40s %10s %12s %12s\n", "capture", "runs", "total(s)", "per run(s)");
+	for (; arg < argc; ++arg)
+	{
+		const char *capture = argv[arg];
+		std::string hash = CaptureHash(capture);
+		if (hash != db_hash)
+		{
+			fprintf(stderr, "Warning: %s was captured with database %s, not %s.\n",
+				capture, hash.c_str(), db_hash.c_str());
+		}
+		clock_t start = clock();
+		int errors = 0;
+		for (int i = 0; i < repeats && errors == 0; ++i)
+		{
+			errors = iphreeqc.RunFile(capture);
+		}
+		double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+		if (errors != 0)
+		{
+			fprintf(stderr, "%s", iphreeqc.GetErrorString());
+			++failures;
+			continue;
+		}
+		total += seconds;
+		printf("%-40s %10d %12.6f %12.6f\n", capture, repeats, seconds, seconds / repeats);
+	}
+	printf("%-40s %10s %12.6f\n", "total", "", total);
+	return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
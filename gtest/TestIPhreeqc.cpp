@@ -4,7 +4,12 @@
 #include <cmath>
 #include <cfloat>
 #include <cassert>
+#include <fstream>
+#include <iterator>
+#include <atomic>
+#include <thread>
 #include "IPhreeqc.hpp"
+#include "IPhreeqcPool.hpp"
 #include "Phreeqc.h"
 #include "FileTest.h"
 #undef true
@@ -4896,3 +4901,1434 @@ TEST(TestIPhreeqc, TestEx10)
 		ASSERT_EQ(std::string(expected), obj.GetAccumulatedLines());
 	}
 }
+
+TEST(TestIPhreeqc, TestGetCellCost)
+{
+	const char input[] =
+		"SOLUTION 0\n"
+		"  units mmol/kgw\n"
+		"  Ca 1\n"
+		"  Cl 2\n"
+		"SOLUTION 1-3\n"
+		"  units mmol/kgw\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"RATES\n"
+		"Dissolve\n"
+		"  -start\n"
+		"  10 rate = 1e-4 * M\n"
+		"  20 SAVE rate * TIME\n"
+		"  -end\n"
+		"KINETICS 1-3\n"
+		"Dissolve\n"
+		"  -formula NaCl 1\n"
+		"  -m 1\n"
+		"  -tol 1e-8\n"
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"  -cell_cost true\n"
+		"TRANSPORT\n"
+		"  -cells 3\n"
+		"  -shifts 2\n"
+		"  -time_step 100\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, obj.GetCellCostCount());
+	ASSERT_EQ(VR_INVALIDARG, obj.GetCellCost(0, NULL, NULL, NULL, NULL, NULL));
+
+	ASSERT_EQ(0, obj.RunString(input));
+	ASSERT_TRUE(obj.GetCellCostCount() >= 5);
+
+	for (int cell = 1; cell <= 3; ++cell)
+	{
+		int iterations = -1, retries = -1, solves = -1, kinetic_steps = -1;
+		double seconds = -1;
+		ASSERT_EQ(VR_OK, obj.GetCellCost(cell, &iterations, &retries, &solves, &kinetic_steps, &seconds));
+		ASSERT_GT(iterations, 0);
+		ASSERT_EQ(0, retries);
+		ASSERT_GT(solves, 0);
+		ASSERT_GT(kinetic_steps, 0);
+		ASSERT_GT(seconds, 0.0);
+	}
+	ASSERT_EQ(VR_INVALIDARG, obj.GetCellCost(-1, NULL, NULL, NULL, NULL, NULL));
+
+	// a run stopped inside the kinetics does not keep later runs from timing cells
+	IPhreeqc stopped;
+	ASSERT_EQ(0, stopped.LoadDatabase("phreeqc.dat"));
+	ASSERT_GT(stopped.RunString(
+		"SOLUTION 0-1\n"
+		"RATES\n"
+		"Stop\n"
+		"  -start\n"
+		"  10 GOTO 100\n"
+		"  20 SAVE 0\n"
+		"  -end\n"
+		"KINETICS 1\n"
+		"Stop\n"
+		"  -formula NaCl 1\n"
+		"  -m 1\n"
+		"TRANSPORT\n"
+		"  -cells 1\n"
+		"  -shifts 1\n"
+		"  -time_step 100\n"
+		"END\n"), 0);
+	ASSERT_EQ(0, stopped.RunString(input));
+	for (int cell = 1; cell <= 3; ++cell)
+	{
+		double seconds = -1;
+		ASSERT_EQ(VR_OK, stopped.GetCellCost(cell, NULL, NULL, NULL, NULL, &seconds));
+		ASSERT_GT(seconds, 0.0);
+	}
+	ASSERT_EQ(VR_INVALIDARG, obj.GetCellCost(obj.GetCellCostCount(), NULL, NULL, NULL, NULL, NULL));
+
+	// -cell_cost columns
+	ASSERT_EQ(5, obj.GetSelectedOutputColumnCount());
+	CVar v;
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(0, 0, &v));
+	ASSERT_EQ(std::string("cost_iter"), std::string(v.sVal));
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(0, 4, &v));
+	ASSERT_EQ(std::string("cost_time"), std::string(v.sVal));
+
+	// rows of the last shift are cells 0 to 4; cell 3 is next to last
+	int iterations;
+	ASSERT_EQ(VR_OK, obj.GetCellCost(3, &iterations, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(obj.GetSelectedOutputRowCount() - 2, 0, &v));
+	ASSERT_EQ(TT_LONG, v.type);
+	ASSERT_EQ((long)iterations, v.lVal);
+
+	// -reset true leaves the cost columns off, as it does -new_line
+	IPhreeqc reset;
+	ASSERT_EQ(0, reset.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, reset.RunString("SOLUTION 1\nSELECTED_OUTPUT\n  -reset true\nEND\n"));
+	ASSERT_GT(reset.GetSelectedOutputColumnCount(), 0);
+	for (int j = 0; j < reset.GetSelectedOutputColumnCount(); ++j)
+	{
+		ASSERT_EQ(VR_OK, reset.GetSelectedOutputValue(0, j, &v));
+		ASSERT_EQ(std::string::npos, std::string(v.sVal).find("cost_"));
+	}
+}
+
+TEST(TestIPhreeqc, TestCaptureSlowCells)
+{
+	const char input[] =
+		"KNOBS\n"
+		"  -capture_iterations 1\n"
+		"  -capture_file       capture_test\n"
+		"  -capture_max        2\n"
+		"SOLUTION 0\n"
+		"  units mmol/kgw\n"
+		"  Ca 1\n"
+		"  Cl 2\n"
+		"SOLUTION 1-3\n"
+		"  units mmol/kgw\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"RATES\n"
+		"Dissolve\n"
+		"  -start\n"
+		"  10 rate = 1e-4 * M\n"
+		"  20 SAVE rate * TIME\n"
+		"  -end\n"
+		"KINETICS 1-3\n"
+		"Dissolve\n"
+		"  -formula NaCl 1\n"
+		"  -m 1\n"
+		"  -tol 1e-8\n"
+		"TRANSPORT\n"
+		"  -cells 3\n"
+		"  -shifts 2\n"
+		"  -time_step 100\n"
+		"END\n";
+
+	FileTest capture1("capture_test_1.pqi");
+	FileTest capture2("capture_test_2.pqi");
+	FileTest capture3("capture_test_3.pqi");
+	ASSERT_TRUE(capture1.RemoveExisting());
+	ASSERT_TRUE(capture2.RemoveExisting());
+	ASSERT_TRUE(capture3.RemoveExisting());
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, obj.RunString(input));
+
+	// -capture_max limits the number of files
+	ASSERT_TRUE(capture1.VerifyExists());
+	ASSERT_TRUE(capture2.VerifyExists());
+	ASSERT_TRUE(capture3.VerifyMissing());
+
+	std::ifstream ifs(capture1.GetName().c_str());
+	std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ifs.close();
+	ASSERT_EQ(8u, ::strlen(obj.GetDatabaseHash()));
+	ASSERT_NE(std::string::npos, text.find(std::string("database_hash ") + obj.GetDatabaseHash()));
+	ASSERT_NE(std::string::npos, text.find("KNOBS"));
+
+	// each capture replays on its own
+	IPhreeqc replay;
+	ASSERT_STREQ("", replay.GetDatabaseHash());
+	ASSERT_EQ(0, replay.LoadDatabase("phreeqc.dat"));
+	ASSERT_STREQ(obj.GetDatabaseHash(), replay.GetDatabaseHash());
+	ASSERT_EQ(0, replay.RunFile(capture1.GetName().c_str()));
+	ASSERT_EQ(0, replay.RunFile(capture2.GetName().c_str()));
+
+	ASSERT_TRUE(capture1.RemoveExisting());
+	ASSERT_TRUE(capture2.RemoveExisting());
+
+	// the reaction pressure is part of the capture
+	IPhreeqc pressure;
+	ASSERT_EQ(0, pressure.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, pressure.RunString(
+		"KNOBS\n"
+		"  -capture_iterations 1\n"
+		"  -capture_file       capture_test\n"
+		"  -capture_max        1\n"
+		"SOLUTION 1\n"
+		"EQUILIBRIUM_PHASES 1\n"
+		"  Calcite 0 10\n"
+		"REACTION_PRESSURE 1\n"
+		"  500\n"
+		"END\n"));
+	ASSERT_TRUE(capture1.VerifyExists());
+	ifs.open(capture1.GetName().c_str());
+	text.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ifs.close();
+	ASSERT_NE(std::string::npos, text.find("REACTION_PRESSURE_RAW"));
+	ASSERT_NE(std::string::npos, text.find("USE reaction_pressure 1"));
+
+	ASSERT_EQ(0, replay.RunString("SELECTED_OUTPUT 1\n  -reset false\nUSER_PUNCH 1\n  10 PUNCH PRESSURE\nEND\n"));
+	ASSERT_EQ(0, replay.RunFile(capture1.GetName().c_str()));
+	CVar v;
+	ASSERT_EQ(VR_OK, replay.GetSelectedOutputValue(replay.GetSelectedOutputRowCount() - 1, 0, &v));
+	ASSERT_NEAR(500.0, v.dVal, 1e-6);
+	ASSERT_TRUE(capture1.RemoveExisting());
+
+	// kinetics are folded into the captured reaction step
+	IPhreeqc batch;
+	ASSERT_EQ(0, batch.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, batch.RunString(
+		"KNOBS\n"
+		"  -capture_iterations 1\n"
+		"  -capture_file       capture_test\n"
+		"  -capture_max        1000\n"
+		"  -delay_mass_water   true\n"
+		"SOLUTION 1\n"
+		"  units mmol/kgw\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"RATES\n"
+		"Dissolve\n"
+		"  -start\n"
+		"  10 rate = 1e-4 * M\n"
+		"  20 SAVE rate * TIME\n"
+		"  -end\n"
+		"KINETICS 1\n"
+		"Dissolve\n"
+		"  -formula NaCl 1\n"
+		"  -m 1\n"
+		"  -steps 100 200 300\n"
+		"REACTION 1\n"
+		"  CaCl2 1\n"
+		"  1 2 3 mmol\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -totals Na Ca\n"
+		"END\n"));
+	CVar na, ca;
+	ASSERT_EQ(VR_OK, batch.GetSelectedOutputValue(batch.GetSelectedOutputRowCount() - 1, 0, &na));
+	ASSERT_EQ(VR_OK, batch.GetSelectedOutputValue(batch.GetSelectedOutputRowCount() - 1, 1, &ca));
+
+	// the last capture is the final calculation of the last step
+	int count = 0;
+	while (::FileExists(("capture_test_" + std::to_string(count + 1) + ".pqi").c_str()))
+	{
+		++count;
+	}
+	ASSERT_GT(count, 1);
+	std::string last("capture_test_" + std::to_string(count) + ".pqi");
+	ifs.open(last.c_str());
+	text.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ifs.close();
+	ASSERT_NE(std::string::npos, text.find("-delay_mass_water      true"));
+	ASSERT_NE(std::string::npos, text.find("-scale_pure_phases"));
+	ASSERT_NE(std::string::npos, text.find("-force_numerical_fixed_volume"));
+	ASSERT_EQ(std::string::npos, text.find("KINETICS_RAW"));
+	ASSERT_EQ(std::string::npos, text.find("USE kinetics"));
+	ASSERT_NE(std::string::npos, text.find("USE reaction 1"));
+
+	IPhreeqc folded;
+	ASSERT_EQ(0, folded.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, folded.RunString("SELECTED_OUTPUT 1\n  -reset false\n  -totals Na Ca\nEND\n"));
+	ASSERT_EQ(0, folded.RunFile(last.c_str()));
+	ASSERT_EQ(VR_OK, folded.GetSelectedOutputValue(folded.GetSelectedOutputRowCount() - 1, 0, &v));
+	ASSERT_NEAR(na.dVal, v.dVal, 1e-10);
+	ASSERT_EQ(VR_OK, folded.GetSelectedOutputValue(folded.GetSelectedOutputRowCount() - 1, 1, &v));
+	ASSERT_NEAR(ca.dVal, v.dVal, 1e-10);
+
+	for (int n = 1; n <= count; ++n)
+	{
+		FileTest capture("capture_test_" + std::to_string(n) + ".pqi");
+		ASSERT_TRUE(capture.RemoveExisting());
+	}
+}
+
+TEST(TestIPhreeqc, TestGetPhaseCounters)
+{
+	const char input[] =
+		"SOLUTION 1\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"RATES\n"
+		"Dissolve\n"
+		"  -start\n"
+		"  10 rate = 1e-4 * M\n"
+		"  20 SAVE rate * TIME\n"
+		"  -end\n"
+		"KINETICS 1\n"
+		"Dissolve\n"
+		"  -formula NaCl 1\n"
+		"  -m 1\n"
+		"  -steps 100 in 2\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(VR_INVALIDARG, obj.GetPhaseCounters(-1, NULL, NULL, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(VR_INVALIDARG, obj.GetPhaseCounters(5, NULL, NULL, NULL, NULL, NULL, NULL));
+
+	// off by default
+	ASSERT_EQ(0, obj.RunString(input));
+	for (int phase = 0; phase < 5; ++phase)
+	{
+		int calls = -1;
+		ASSERT_EQ(VR_OK, obj.GetPhaseCounters(phase, &calls, NULL, NULL, NULL, NULL, NULL));
+		ASSERT_EQ(0, calls);
+	}
+
+	std::string on = std::string("KNOBS\n  -phase_counters true\n") + input;
+	ASSERT_EQ(0, obj.RunString(on.c_str()));
+
+	bool hardware = false;
+	for (int phase = 0; phase < 5; ++phase)
+	{
+		int calls = -1;
+		double seconds = -1, cycles = -2, instructions = -2, cache_misses = -2, branch_misses = -2;
+		ASSERT_EQ(VR_OK, obj.GetPhaseCounters(phase, &calls, &seconds, &cycles, &instructions, &cache_misses, &branch_misses));
+		ASSERT_GT(calls, 0);
+		ASSERT_GE(seconds, 0.0);
+		// either counted or unavailable
+		ASSERT_TRUE(cycles == -1 || cycles >= 0);
+		ASSERT_TRUE(instructions == -1 || instructions >= 0);
+		ASSERT_TRUE(cache_misses == -1 || cache_misses >= 0);
+		ASSERT_TRUE(branch_misses == -1 || branch_misses >= 0);
+		if (phase == 0) hardware = (instructions > 0);
+		ASSERT_EQ(hardware, instructions > 0);
+	}
+
+	// model includes gammas
+	double model_seconds, gammas_seconds;
+	int model_calls, gammas_calls;
+	ASSERT_EQ(VR_OK, obj.GetPhaseCounters(1, &model_calls, &model_seconds, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(VR_OK, obj.GetPhaseCounters(3, &gammas_calls, &gammas_seconds, NULL, NULL, NULL, NULL));
+	ASSERT_GE(gammas_calls, model_calls);
+
+	// counters follow a run on another thread
+	ASSERT_EQ(VR_OK, obj.RunStringAsync(on.c_str()));
+	ASSERT_EQ(0, obj.WaitRun());
+	double instructions = -2;
+	ASSERT_EQ(VR_OK, obj.GetPhaseCounters(1, &model_calls, &model_seconds, NULL, &instructions, NULL, NULL));
+	ASSERT_GT(model_calls, 0);
+	ASSERT_GT(model_seconds, 0.0);
+	ASSERT_EQ(hardware, instructions > 0);
+
+	// counters are cleared at the start of each run
+	ASSERT_EQ(0, obj.RunString("SOLUTION 1\nEND\n"));
+	int basic_calls = -1;
+	ASSERT_EQ(VR_OK, obj.GetPhaseCounters(4, &basic_calls, NULL, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(0, basic_calls);
+}
+
+TEST(TestIPhreeqc, TestGetRunStatistics)
+{
+	const char input[] =
+		"SOLUTION 1\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"RATES\n"
+		"Dissolve\n"
+		"  -start\n"
+		"  10 rate = 1e-4 * M\n"
+		"  20 SAVE rate * TIME\n"
+		"  -end\n"
+		"KINETICS 1\n"
+		"Dissolve\n"
+		"  -formula NaCl 1\n"
+		"  -m 1\n"
+		"  -steps 100 in 2\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(VR_INVALIDARG, obj.GetRunStatistics(NULL));
+
+	// Runge-Kutta
+	std::string rk = std::string(input) + "END\n";
+	ASSERT_EQ(0, obj.RunString(rk.c_str()));
+
+	RUN_STATISTICS stats;
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_GT(stats.iterations, 0);
+	ASSERT_GE(stats.calculations[1], 1);    // initial solution
+	ASSERT_GT(stats.calculations[5], 0);    // reaction
+	ASSERT_EQ(0, stats.calculations[8]);    // transport
+	ASSERT_GT(stats.attempts[0], 0);
+	ASSERT_EQ(0, stats.failures);
+	ASSERT_GT(stats.rk_steps, 0);
+	ASSERT_GE(stats.rk_rejected, 0);
+	ASSERT_EQ(0, stats.cvode_steps);
+
+	int models = 0;
+	for (int i = 0; i < RS_CALCULATION_COUNT; ++i)
+	{
+		models += stats.calculations[i];
+	}
+	ASSERT_GE(stats.iterations, stats.calculations[5]);
+	ASSERT_GE(models, stats.attempts[0]);
+
+	// CVODE
+	std::string cvode = std::string(input) + "  -cvode true\nEND\n";
+	ASSERT_EQ(0, obj.RunString(cvode.c_str()));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_GT(stats.cvode_steps, 0);
+	ASSERT_EQ(0, stats.rk_steps);
+
+	// statistics are cleared at the start of each run
+	ASSERT_EQ(0, obj.RunString("SOLUTION 1\nEND\n"));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_EQ(1, stats.calculations[1]);
+	ASSERT_EQ(0, stats.calculations[5]);
+	ASSERT_EQ(0, stats.attempts[0]);
+	ASSERT_EQ(0, stats.cvode_steps);
+}
+
+TEST(TestIPhreeqc, TestCalculateValuesOnDemand)
+{
+	const char input[] =
+		"CALCULATE_VALUES\n"
+		"Count\n"
+		"  -start\n"
+		"  10 PUT(GET(1) + 1, 1)\n"
+		"  20 SAVE 2\n"
+		"  -end\n"
+		"Twice\n"
+		"  -start\n"
+		"  10 SAVE CALC_VALUE(\"Count\") + CALC_VALUE(\"Count\")\n"
+		"  -end\n"
+		"Circular\n"
+		"  -start\n"
+		"  10 SAVE CALC_VALUE(\"Circular\")\n"
+		"  -end\n"
+		"SOLUTION 1\n"
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"USER_PUNCH\n"
+		"  -headings twice count\n"
+		"  10 PUNCH CALC_VALUE(\"Twice\"), GET(1)\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, obj.RunString(input));
+	ASSERT_EQ(2, obj.GetSelectedOutputRowCount());
+
+	// Count is run once for the solution, not once for each reference
+	CVar v;
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 0, &v));
+	ASSERT_EQ(TT_DOUBLE, v.type);
+	ASSERT_EQ(4.0, v.dVal);
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 1, &v));
+	ASSERT_EQ(TT_DOUBLE, v.type);
+	ASSERT_EQ(1.0, v.dVal);
+
+	// a value that uses itself is reported instead of recursing
+	obj.SetOutputStringOn(true);
+	obj.RunString(
+		"SOLUTION 1\n"
+		"USER_PRINT\n"
+		"  10 PRINT CALC_VALUE(\"Circular\")\n"
+		"END\n");
+	ASSERT_NE(std::string::npos, std::string(obj.GetOutputString()).find("Circular reference in CALCULATE_VALUES Circular"));
+}
+
+TEST(TestIPhreeqc, TestSolidSolutionGaps)
+{
+	// two solid solutions of the same name, with different Guggenheim
+	// parameters, taken to the same temperature
+	const char def[] =
+		"SOLID_SOLUTIONS 1\n"
+		"  Ca(x)Sr(1-x)CO3\n"
+		"    -comp1 Aragonite 0\n"
+		"    -comp2 Strontianite 0\n"
+		"    -Gugg_nondim 3.43 -1.82\n"
+		"SOLID_SOLUTIONS 2\n"
+		"  Ca(x)Sr(1-x)CO3\n"
+		"    -comp1 Aragonite 0\n"
+		"    -comp2 Strontianite 0\n"
+		"    -Gugg_nondim 2.9 -0.6\n"
+		"SOLUTION 1\n"
+		"  -units mmol/kgw\n"
+		"  pH 5.93 charge\n"
+		"  Ca 3.932\n"
+		"  C 7.864\n"
+		"EQUILIBRIUM_PHASES 1\n"
+		"  CO2(g) -0.01265 10\n"
+		"  Aragonite\n"
+		"SAVE solution 1\n"
+		"END\n";
+	const char format[] =
+		"USE solution 1\n"
+		"USE solid_solution %d\n"
+		"REACTION 1\n"
+		"  SrCO3 1\n"
+		"  0.0005 0.001 0.002\n"
+		"REACTION_TEMPERATURE 1\n"
+		"  50\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -solid_solutions Aragonite Strontianite\n"
+		"  -totals Sr\n"
+		"END\n";
+	char input[2][1024];
+	for (int i = 0; i < 2; ++i)
+	{
+		snprintf(input[i], sizeof(input[i]), format, i + 1);
+	}
+
+	// each solid solution on its own
+	double expected[2][3][3];
+	CVar v;
+	for (int i = 0; i < 2; ++i)
+	{
+		IPhreeqc obj;
+		ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+		ASSERT_EQ(0, obj.RunString(def));
+		ASSERT_EQ(0, obj.RunString(input[i]));
+		ASSERT_EQ(4, obj.GetSelectedOutputRowCount());
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r + 1, c, &v));
+				expected[i][r][c] = v.dVal;
+			}
+		}
+	}
+	ASSERT_GT(fabs(expected[0][0][0] - expected[1][0][0]), 1e-5);
+
+	// gaps found for the first are not used for the second, and are
+	// found again after the solid solutions are redefined
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, obj.RunString(def));
+	for (int k = 0; k < 3; ++k)
+	{
+		if (k == 2)
+		{
+			ASSERT_EQ(0, obj.RunString(def));
+		}
+		for (int i = 0; i < 2; ++i)
+		{
+			ASSERT_EQ(0, obj.RunString(input[i]));
+			for (int r = 0; r < 3; ++r)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r + 1, c, &v));
+					EXPECT_NEAR(expected[i][r][c], v.dVal, 1e-12) << k << " " << i << " " << r << " " << c;
+				}
+			}
+		}
+	}
+}
+
+TEST(TestIPhreeqc, TestIncrementalTidy)
+{
+	const char *inputs[] =
+	{
+		"PHASES\n"
+		"Calc2\n"
+		"  CaCO3 = Calcite(s)\n"
+		"  log_k 0.1\n"
+		"  -no_check\n",
+
+		"PHASES\n"
+		"Calcite\n"
+		"  CaCO3 = CO3-2 + Ca+2\n"
+		"  log_k -8.0\n",
+
+		"SOLUTION_SPECIES\n"
+		"Ca+2 + H+ + CO3-2 = CaHCO3+\n"
+		"  log_k 12.0\n",
+
+		"SOLUTION_SPECIES\n"
+		"Ca+2 + CO3-2 = CaCO3\n"
+		"  log_k 3.5\n"
+		"PHASES\n"
+		"Aragonite\n"
+		"  CaCO3 = CO3-2 + Ca+2\n"
+		"  log_k -8.0\n",
+	};
+	const char solution[] =
+		"SOLUTION 1\n"
+		"  pH 7 charge\n"
+		"  Ca 1\n"
+		"  Mg 0.5\n"
+		"  C 2\n"
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"  -si Calcite Calc2 Aragonite Dolomite\n"
+		"  -molalities CaHCO3+ CaCO3\n"
+		"END\n";
+
+	// edits of existing species and phases are tidied incrementally
+	IPhreeqc incremental;
+	ASSERT_EQ(0, incremental.LoadDatabase("phreeqc.dat"));
+	incremental.SetSelectedOutputStringOn(true);
+
+	// RATES forces a full tidy of the database
+	IPhreeqc full;
+	ASSERT_EQ(0, full.LoadDatabase("phreeqc.dat"));
+	full.SetSelectedOutputStringOn(true);
+
+	std::vector<std::string> results;
+	for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); ++i)
+	{
+		ASSERT_EQ(0, incremental.RunString((std::string(inputs[i]) + solution).c_str()));
+		ASSERT_EQ(0, full.RunString((std::string("RATES\n") + inputs[i] + solution).c_str()));
+		ASSERT_EQ(std::string(full.GetSelectedOutputString()), std::string(incremental.GetSelectedOutputString()));
+		results.push_back(incremental.GetSelectedOutputString());
+	}
+
+	// Calc2 is written in terms of Calcite and follows its log K
+	CVar calcite, calc2;
+	ASSERT_EQ(VR_OK, incremental.GetSelectedOutputValue(0, 2, &calcite));
+	ASSERT_EQ(std::string("si_Calcite"), calcite.sVal);
+	ASSERT_EQ(VR_OK, incremental.GetSelectedOutputValue(0, 3, &calc2));
+	ASSERT_EQ(std::string("si_Calc2"), calc2.sVal);
+	ASSERT_EQ(VR_OK, incremental.GetSelectedOutputValue(1, 2, &calcite));
+	ASSERT_EQ(VR_OK, incremental.GetSelectedOutputValue(1, 3, &calc2));
+	ASSERT_NEAR(-0.1, calc2.dVal - calcite.dVal, 1e-10);
+
+	// each edit changes the results
+	for (size_t i = 1; i < results.size(); ++i)
+	{
+		ASSERT_NE(results[i - 1], results[i]);
+	}
+}
+
+TEST(TestIPhreeqc, TestModelScope)
+{
+	const char *solutions[] =
+	{
+		"SOLUTION 1\n"
+		"  Na 1\n"
+		"  Cl 1\n",
+
+		"SOLUTION 1\n"
+		"  pH 7 charge\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"  Ca 1\n"
+		"  C 2\n",
+
+		"SOLUTION 1\n"
+		"  Na 1\n"
+		"  Cl 1\n",
+	};
+	const char punch[] =
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"  -si Halite Calcite\n"
+		"END\n";
+
+	// the phases of a run are picked from the elements of the solution;
+	// each run must match a run on a new instance
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	obj.SetSelectedOutputStringOn(true);
+	for (size_t i = 0; i < sizeof(solutions) / sizeof(solutions[0]); ++i)
+	{
+		IPhreeqc fresh;
+		ASSERT_EQ(0, fresh.LoadDatabase("phreeqc.dat"));
+		fresh.SetSelectedOutputStringOn(true);
+		ASSERT_EQ(0, fresh.RunString((std::string(solutions[i]) + punch).c_str()));
+		ASSERT_EQ(0, obj.RunString((std::string(solutions[i]) + punch).c_str()));
+		ASSERT_EQ(std::string(fresh.GetSelectedOutputString()), std::string(obj.GetSelectedOutputString()));
+
+		CVar calcite;
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 1, &calcite));
+		if (i == 1)
+		{
+			ASSERT_GT(calcite.dVal, -999.0);
+		}
+		else
+		{
+			ASSERT_NEAR(-999.999, calcite.dVal, 1e-10);
+		}
+	}
+}
+
+TEST(TestIPhreeqc, TestLineSearch)
+{
+	const char input[] =
+		"SOLUTION 1\n"
+		"  pH 7\n"
+		"EQUILIBRIUM_PHASES 1\n"
+		"  Gypsum 0 1\n"
+		"  Anhydrite 0 1\n"
+		"REACTION_TEMPERATURE 1\n"
+		"  25 75 in 51 steps\n"
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"  -temperature\n"
+		"  -si Anhydrite Gypsum\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	obj.SetSelectedOutputStringOn(true);
+
+	// off by default
+	RUN_STATISTICS stats;
+	ASSERT_EQ(0, obj.RunString(input));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_EQ(0, stats.line_searches);
+	ASSERT_EQ(0, stats.failures);
+	ASSERT_EQ(53, obj.GetSelectedOutputRowCount());
+	std::vector<double> si;
+	for (int r = 1; r < obj.GetSelectedOutputRowCount(); ++r)
+	{
+		CVar v;
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 1, &v));
+		si.push_back(v.dVal);
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 2, &v));
+		si.push_back(v.dVal);
+	}
+
+	// a shortened step converges to the same equilibrium
+	ASSERT_EQ(0, obj.RunString((std::string("KNOBS\n  -line_search true\n") + input).c_str()));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_GT(stats.line_searches, 0);
+	ASSERT_EQ(0, stats.failures);
+	ASSERT_EQ(53, obj.GetSelectedOutputRowCount());
+	for (int r = 1; r < obj.GetSelectedOutputRowCount(); ++r)
+	{
+		CVar v;
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 1, &v));
+		ASSERT_NEAR(si[2 * (r - 1)], v.dVal, 1e-3);
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 2, &v));
+		ASSERT_NEAR(si[2 * (r - 1) + 1], v.dVal, 1e-3);
+	}
+
+	// KNOBS settings persist until changed
+	ASSERT_EQ(0, obj.RunString((std::string("KNOBS\n  -line_search false\n") + input).c_str()));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_EQ(0, stats.line_searches);
+
+	// models whose state is not restored by a shortened step are rejected
+	const char* unsupported[] =
+	{
+		"SOLUTION 1\n"
+		"SURFACE 1\n"
+		"  -equilibrate 1\n"
+		"  Hfo_wOH 1e-3 600 1\n"
+		"  -diffuse_layer\n"
+		"END\n",
+		"SOLUTION 1\n"
+		"GAS_PHASE 1\n"
+		"  -fixed_volume\n"
+		"  -volume 1\n"
+		"  CO2(g) 0.01\n"
+		"END\n"
+	};
+	const char* messages[] = { "diffuse-layer", "fixed-volume" };
+	for (int i = 0; i < 2; ++i)
+	{
+		ASSERT_EQ(0, obj.RunString(unsupported[i]));
+		ASSERT_GT(obj.RunString((std::string("KNOBS\n  -line_search true\n") + unsupported[i]).c_str()), 0);
+		ASSERT_THAT(obj.GetErrorString(), HasSubstr(messages[i]));
+		ASSERT_EQ(0, obj.RunString((std::string("KNOBS\n  -line_search false\n") + unsupported[i]).c_str()));
+	}
+
+	IPhreeqc pz;
+	ASSERT_EQ(0, pz.LoadDatabase("pitzer.dat"));
+	ASSERT_EQ(0, pz.RunString("SOLUTION 1\n  Na 1\n  Cl 1\nEND\n"));
+	ASSERT_GT(pz.RunString("KNOBS\n  -line_search true\nSOLUTION 1\n  Na 1\n  Cl 1\nEND\n"), 0);
+	ASSERT_THAT(pz.GetErrorString(), HasSubstr("PITZER"));
+}
+
+TEST(TestIPhreeqc, TestLoopThreads)
+{
+	const char input[] =
+		"SOLUTION 1\n"
+		"  pH 7.5\n"
+		"  Na 10\n"
+		"  Ca 2\n"
+		"  Mg 1\n"
+		"  Fe 0.01\n"
+		"  Al 0.001\n"
+		"  Si 0.5\n"
+		"  C 4\n"
+		"  S(6) 3\n"
+		"  Cl 10 charge\n"
+		"EXCHANGE 1\n"
+		"  -equilibrate 1\n"
+		"  X 0.01\n"
+		"EQUILIBRIUM_PHASES 1\n"
+		"  Calcite 0 1\n"
+		"REACTION 1\n"
+		"  NaCl 1\n"
+		"  0.1 in 10 steps\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -ionic_strength\n"
+		"  -totals Ca Na X\n"
+		"  -activities Ca+2 CO3-2 HCO3- CaX2\n"
+		"END\n";
+	const char* databases[] = { "phreeqc.dat", "llnl.dat" };
+
+	for (size_t d = 0; d < sizeof(databases) / sizeof(databases[0]); ++d)
+	{
+		std::vector<double> serial;
+		for (int threads = 1; threads <= 4; threads += 3)
+		{
+			IPhreeqc obj;
+			ASSERT_EQ(0, obj.LoadDatabase(databases[d]));
+
+			// a threshold of 1 puts every model on the loop threads
+			char knobs[128];
+			::snprintf(knobs, sizeof(knobs), "KNOBS\n  -threads %d\n  -thread_threshold 1\n", threads);
+			ASSERT_EQ(0, obj.RunString((std::string(knobs) + input).c_str())) << obj.GetErrorString();
+			ASSERT_EQ(13, obj.GetSelectedOutputRowCount());
+
+			// results do not depend on the number of threads
+			size_t n = 0;
+			for (int r = 1; r < obj.GetSelectedOutputRowCount(); ++r)
+			{
+				for (int c = 0; c < obj.GetSelectedOutputColumnCount(); ++c, ++n)
+				{
+					CVar v;
+					ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, c, &v));
+					if (threads == 1)
+					{
+						serial.push_back(v.dVal);
+					}
+					else
+					{
+						ASSERT_EQ(serial[n], v.dVal);
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(TestIPhreeqc, TestDiffuseLayerSweeps)
+{
+	const char solution[] =
+		"SOLUTION 1\n"
+		"  pH 8\n"
+		"  Na 10 charge\n"
+		"  Cl 10\n"
+		"  Ca 1\n"
+		"  Zn 0.01\n"
+		"SURFACE 1\n";
+	const char surface[] =
+		"  Hfo_wOH 2e-3 600 1\n"
+		"  Hfo_sOH 5e-5\n"
+		"  -equil 1\n"
+		"REACTION 1\n"
+		"  NaOH 1\n"
+		"  0 2 4 mmol\n"
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"  -molalities Zn+2\n"
+		"  -totals Zn\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	obj.SetSelectedOutputStringOn(true);
+	RUN_STATISTICS stats;
+
+	// full integration of the diffuse layer
+	ASSERT_EQ(0, obj.RunString((std::string(solution) + "  -diffuse_layer 1e-8\n" + surface).c_str()));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_EQ(0, stats.failures);
+	ASSERT_GE(stats.g_sweeps, 4);
+	ASSERT_EQ(0, stats.donnan_sweeps);
+	ASSERT_EQ(6, obj.GetSelectedOutputRowCount());    // headings, i_soln, i_surf, 3 steps
+	for (int r = 1; r < obj.GetSelectedOutputRowCount(); ++r)
+	{
+		CVar v;
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 0, &v));
+		ASSERT_GT(v.dVal, 0.0);
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 1, &v));
+		ASSERT_GT(v.dVal, 0.0);
+	}
+
+	// Donnan approximation
+	ASSERT_EQ(0, obj.RunString((std::string(solution) + "  -donnan 1e-8\n" + surface).c_str()));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_EQ(0, stats.failures);
+	ASSERT_EQ(0, stats.g_sweeps);
+	ASSERT_GE(stats.donnan_sweeps, 4);
+
+	// no diffuse layer
+	ASSERT_EQ(0, obj.RunString((std::string(solution) + "  -no_edl\n" + surface).c_str()));
+	ASSERT_EQ(VR_OK, obj.GetRunStatistics(&stats));
+	ASSERT_EQ(0, stats.g_sweeps);
+	ASSERT_EQ(0, stats.donnan_sweeps);
+}
+
+TEST(TestIPhreeqc, TestMobileSurfaceTransport)
+{
+	const char input[] =
+		"SURFACE_MASTER_SPECIES\n"
+		"  Sfo_w Sfo_wOH\n"
+		"SURFACE_SPECIES\n"
+		"  Sfo_wOH = Sfo_wOH\n"
+		"  log_k 0\n"
+		"  Sfo_wOH + Zn+2 = Sfo_wOZn+ + H+\n"
+		"  log_k -2.32\n"
+		"SOLUTION 0-5\n"
+		"  pH 7\n"
+		"  Na 1\n"
+		"  Cl 1 charge\n"
+		"  Zn 0.01\n"
+		"SURFACE 0\n"
+		"  -donnan 1e-9\n"
+		"  Hfo_wOH 1e-3 600 0.1 Dw 1e-13\n"
+		"  -equil 0\n"
+		"SURFACE 1-5\n"
+		"  -donnan 1e-9\n"
+		"  Hfo_wOH 1e-3 600 0.1 Dw 1e-13\n"
+		"  Sfo_wOH 1e-3 600 1\n"
+		"  -equil 1\n"
+		"USER_PUNCH\n"
+		"  -headings cell Zn_Hfo Zn_Sfo\n"
+		"  10 PUNCH CELL_NO, SURF(\"Zn\", \"Hfo\"), SURF(\"Zn\", \"Sfo\")\n"
+		"SELECTED_OUTPUT\n"
+		"  -reset false\n"
+		"END\n"
+		"TRANSPORT\n"
+		"  -cells 5\n"
+		"  -shifts 5\n"
+		"  -time_step 3600\n"
+		"  -multi_d true 1e-9 0.3 0.0 1.0\n"
+		"  -punch_frequency 5\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	obj.SetSelectedOutputStringOn(true);
+	ASSERT_EQ(0, obj.RunString(input));
+
+	// the last shift punches cells 0 to 6
+	int rows = obj.GetSelectedOutputRowCount();
+	ASSERT_GT(rows, 7);
+	CVar v;
+	for (int r = rows - 6; r < rows - 1; ++r)
+	{
+		// the mobile Hfo moved in, the immobile Sfo stayed
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 1, &v));
+		ASSERT_GT(v.dVal, 0.0);
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 2, &v));
+		ASSERT_GT(v.dVal, 0.0);
+	}
+	// only the mobile Hfo leaves the column
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(rows - 1, 0, &v));
+	ASSERT_EQ(6, (int)v.dVal);
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(rows - 1, 1, &v));
+	ASSERT_GT(v.dVal, 0.0);
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(rows - 1, 2, &v));
+	ASSERT_EQ(0.0, v.dVal);
+}
+
+// reads the input one istream::get at a time
+class GetcPHRQ_io : public PHRQ_io
+{
+public:
+	int getc(void)
+	{
+		std::istream* is = this->get_istream();
+		if (is == NULL)
+		{
+			return EOF;
+		}
+		int n = is->get();
+		if (n == 13 && is->peek() == 10)
+		{
+			n = is->get();
+		}
+		return n;
+	}
+};
+
+static std::vector<std::string> LogicalLines(PHRQ_io& io, std::istream* is)
+{
+	std::vector<std::string> lines;
+	io.push_istream(is);
+	while (io.get_logical_line() != PHRQ_io::LT_EOF)
+	{
+		lines.push_back(io.Get_m_line_save());
+	}
+	io.clear_istream();
+	return lines;
+}
+
+TEST(TestIPhreeqc, TestLogicalLineBuffers)
+{
+	// CR LF, a lone CR, continuation, ; and comments falling on each side
+	// of the end of the file buffer
+	const char body[] =
+		"SOLUTION 1\r\n"
+		"  pH 7 \\\r\n"
+		"  ; Na 1 # c;c\\\r\n"
+		"  Cl 1\rBr 1\r\n"
+		"SELECTED_OUTPUT; -reset false; -pH; -totals Na Cl\r\n"
+		"END\r\n"
+		"# no newline;";
+
+	for (size_t n = 8192 - sizeof(body) - 4; n < 8192 + 2; ++n)
+	{
+		std::string input(n, 'x');
+		input[0] = '#';
+		input.append("\r\n");
+		input.append(body);
+		{
+			std::ofstream ofs("logical_lines.txt", std::ios_base::binary);
+			ofs << input;
+		}
+
+		GetcPHRQ_io getc_io;
+		std::vector<std::string> expected = LogicalLines(getc_io, new std::istringstream(input));
+		ASSERT_EQ(11u, expected.size());
+		ASSERT_EQ("  pH 7   ", expected[2]);
+		ASSERT_EQ(" Na 1 # c;c\\", expected[3]);
+		ASSERT_EQ("  Cl 1\rBr 1", expected[4]);
+		ASSERT_EQ("# no newline;", expected[10]);
+
+		PHRQ_io io;
+		ASSERT_EQ(expected, LogicalLines(io, new std::istringstream(input)));
+		ASSERT_EQ(expected, LogicalLines(io, new std::ifstream("logical_lines.txt", std::ios_base::binary)));
+		ASSERT_EQ(expected, LogicalLines(getc_io, new std::ifstream("logical_lines.txt", std::ios_base::binary)));
+	}
+	::remove("logical_lines.txt");
+}
+
+TEST(TestIPhreeqc, TestSaveRestoreState)
+{
+	const char branch[] =
+		"USE solution 1\n"
+		"USE equilibrium_phases 1\n"
+		"REACTION 1\n"
+		"  CO2 1\n"
+		"  1 mmol\n"
+		"SAVE solution 1\n"
+		"SAVE equilibrium_phases 1\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -totals Ca\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, obj.RunString("SOLUTION 1\nEQUILIBRIUM_PHASES 1\n  Calcite 0 10\nSAVE solution 1\nSAVE equilibrium_phases 1\nEND\n"));
+
+	int state = obj.SaveState();
+	ASSERT_GE(state, 0);
+	size_t components = obj.GetComponentCount();
+
+	CVar v;
+	ASSERT_EQ(0, obj.RunString(branch));
+	ASSERT_EQ(2, obj.GetSelectedOutputRowCount());
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 0, &v));
+	double first = v.dVal;
+	ASSERT_GT(first, 0.0);
+
+	// the branch changed solution 1 and defined solution 2
+	ASSERT_EQ(0, obj.RunString("SOLUTION 2\n  Na 1\nEND\n"));
+	ASSERT_EQ(0, obj.RunString(branch));
+	ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 0, &v));
+	ASSERT_GT(v.dVal, first * 1.1);
+	ASSERT_EQ(components + 1, obj.GetComponentCount());
+
+	// each restore starts the branch from the saved state
+	for (int i = 0; i < 2; ++i)
+	{
+		ASSERT_EQ(VR_OK, obj.RestoreState(state));
+		ASSERT_EQ(components, obj.GetComponentCount());
+		ASSERT_EQ(0, obj.RunString(branch));
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 0, &v));
+		ASSERT_EQ(first, v.dVal);
+	}
+	ASSERT_NE(0, obj.RunString("MIX 1\n  2 1\nEND\n"));
+
+	ASSERT_EQ(VR_OK, obj.DeleteState(state));
+	ASSERT_EQ(VR_INVALIDARG, obj.RestoreState(state));
+	ASSERT_EQ(VR_INVALIDARG, obj.DeleteState(state));
+	ASSERT_EQ(VR_INVALIDARG, obj.RestoreState(-1));
+
+	// loading a database releases saved states
+	int other = obj.SaveState();
+	ASSERT_NE(state, other);
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(VR_INVALIDARG, obj.RestoreState(other));
+}
+
+TEST(TestIPhreeqc, TestModifySolutionTotals)
+{
+	// as in examples/cpp/advect
+	const char ic[] =
+		"SOLUTION 1-3\n"
+		"END\n"
+		"EQUILIBRIUM_PHASES 1\n"
+		"  CO2(g) -1.5 10\n"
+		"EQUILIBRIUM_PHASES 2-3\n"
+		"  Calcite 0 10\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"USER_PUNCH 1\n"
+		"  -headings charge H O C Ca pH\n"
+		"  10 PUNCH CHARGE_BALANCE, TOTMOLE(\"H\"), TOTMOLE(\"O\"), TOTMOLE(\"C\"), TOTMOLE(\"Ca\"), -LA(\"H+\")\n"
+		"END\n"
+		"RUN_CELLS\n"
+		"  -cells 1\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, obj.RunString(ic));
+	ASSERT_EQ(2, obj.GetSelectedOutputRowCount());
+	double r[6];
+	CVar v;
+	for (int j = 0; j < 6; ++j)
+	{
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, j, &v));
+		r[j] = v.dVal;
+	}
+
+	// cell 2 by SOLUTION_MODIFY
+	std::ostringstream oss;
+	oss.precision(17);
+	oss << "SOLUTION_MODIFY 2\n";
+	oss << "  -cb " << r[0] << "\n";
+	oss << "  -total_h " << r[1] << "\n";
+	oss << "  -total_o " << r[2] << "\n";
+	oss << "  -totals\n";
+	oss << "    C " << r[3] << "\n";
+	oss << "    Ca " << r[4] << "\n";
+	oss << "RUN_CELLS\n  -cells 2\nEND\n";
+	ASSERT_EQ(0, obj.RunString(oss.str().c_str()));
+	ASSERT_EQ(2, obj.GetSelectedOutputRowCount());
+	double text[6];
+	for (int j = 0; j < 6; ++j)
+	{
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, j, &v));
+		text[j] = v.dVal;
+	}
+
+	// cell 3 by ModifySolutionTotals
+	const char* elements[] = { "C", "Ca" };
+	const double moles[] = { r[3], r[4] };
+	ASSERT_EQ(VR_OK, obj.ModifySolutionTotals(3, r[1], r[2], r[0], 2, elements, moles));
+	ASSERT_EQ(0, obj.RunString("RUN_CELLS\n  -cells 3\nEND\n"));
+	ASSERT_EQ(2, obj.GetSelectedOutputRowCount());
+	for (int j = 1; j < 6; ++j)
+	{
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, j, &v));
+		EXPECT_NEAR(text[j], v.dVal, 1e-8 * fabs(text[j])) << j;
+	}
+	// dissolving calcite raised the pH
+	EXPECT_GT(text[5], r[5] + 1.0);
+
+	// unlisted elements and redox states
+	ASSERT_EQ(VR_OK, obj.ModifySolutionTotals(3, r[1], r[2], r[0], 0, NULL, NULL));
+	const char* redox[] = { "C(4)" };
+	ASSERT_EQ(VR_OK, obj.ModifySolutionTotals(3, r[1], r[2], r[0], 1, redox, moles));
+	ASSERT_EQ(0, obj.RunString("RUN_CELLS\n  -cells 3\nEND\n"));
+
+	ASSERT_EQ(VR_INVALIDARG, obj.ModifySolutionTotals(99, r[1], r[2], r[0], 2, elements, moles));
+	ASSERT_EQ(VR_INVALIDARG, obj.ModifySolutionTotals(3, r[1], r[2], r[0], -1, elements, moles));
+	ASSERT_EQ(VR_INVALIDARG, obj.ModifySolutionTotals(3, r[1], r[2], r[0], 1, NULL, moles));
+	ASSERT_EQ(VR_INVALIDARG, obj.ModifySolutionTotals(3, r[1], r[2], r[0], 1, elements, NULL));
+	const char* unknown[] = { "Xx" };
+	ASSERT_EQ(VR_INVALIDARG, obj.ModifySolutionTotals(3, r[1], r[2], r[0], 1, unknown, moles));
+
+	// redox states and the mass of water are kept
+	ASSERT_EQ(0, obj.RunString(
+		"SOLUTION 4\n"
+		"  -water 2\n"
+		"  Fe(2) 1\n"
+		"  Fe(3) 0.01\n"
+		"  Cl 2 charge\n"
+		"END\n"));
+	const char* ferric[] = { "Fe(3)" };
+	const double ferric_moles[] = { 4e-5 };
+	ASSERT_EQ(VR_OK, obj.ModifySolutionTotals(4, 2 * r[1], 2 * r[2], 0.0, 1, ferric, ferric_moles));
+	obj.SetDumpStringOn(true);
+	ASSERT_EQ(0, obj.RunString("DUMP\n  -solution 4\nEND\n"));
+	std::map<std::string, double> dump;
+	for (int i = 0; i < obj.GetDumpStringLineCount(); ++i)
+	{
+		std::istringstream iss(obj.GetDumpStringLine(i));
+		std::string name;
+		double d;
+		if (iss >> name >> d)
+		{
+			dump.insert(std::make_pair(name, d));
+		}
+	}
+	EXPECT_EQ(2.0, dump["-mass_water"]);
+	EXPECT_NEAR(2 * r[1], dump["-total_h"], 1e-8 * r[1]);
+	EXPECT_NEAR(2e-3, dump["Fe(2)"], 1e-8);
+	EXPECT_EQ(4e-5, dump["Fe(3)"]);
+	EXPECT_EQ(0, dump.count("Fe"));
+}
+
+#if !defined(_WIN32)
+TEST(TestIPhreeqc, TestPool)
+{
+	const char format[] =
+		"USE solution 1\n"
+		"REACTION 1\n"
+		"  NaCl 1\n"
+		"  %d mmol\n"
+		"SAVE solution 1\n"
+		"SAVE solution %d\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -totals Na\n"
+		"END\n";
+	const int jobs = 8;
+
+	IPhreeqcPool pool;
+	IPhreeqc& master = pool.GetMaster();
+	ASSERT_EQ(0, master.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, master.RunString("SOLUTION 1\n  Na 1\n  Cl 1\nEND\n"));
+	ASSERT_EQ(3, pool.Start(3));
+	ASSERT_EQ(3, pool.GetWorkerCount());
+
+	std::vector<std::string> inputs;
+	for (int i = 0; i < jobs; ++i)
+	{
+		char input[512];
+		::snprintf(input, sizeof(input), format, i + 1, 11 + i);
+		inputs.push_back(input);
+		ASSERT_EQ(i, pool.Submit(input, 11 + i, 11 + i));
+	}
+	int bad = pool.Submit("MIX 1\n  99 1\nEND\n");
+	ASSERT_EQ(1, pool.Wait());
+	ASSERT_EQ(jobs + 1, pool.GetJobCount());
+	ASSERT_GT(pool.GetJobErrorCount(bad), 0);
+	ASSERT_THAT(pool.GetJobErrorString(bad), HasSubstr("99"));
+
+	// each job starts from solution 1 of the master, as a fresh run does
+	CVar v;
+	for (int i = 0; i < jobs; ++i)
+	{
+		IPhreeqc obj;
+		ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+		ASSERT_EQ(0, obj.RunString("SOLUTION 1\n  Na 1\n  Cl 1\nEND\n"));
+		ASSERT_EQ(0, obj.RunString(inputs[i].c_str()));
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(1, 0, &v));
+		double expected = v.dVal;
+
+		ASSERT_EQ(0, pool.GetJobErrorCount(i));
+		ASSERT_EQ(2, pool.GetJobSelectedOutputRowCount(i));
+		ASSERT_EQ(1, pool.GetJobSelectedOutputColumnCount(i));
+		ASSERT_EQ(VR_OK, pool.GetJobSelectedOutputValue(i, 0, 0, &v));
+		ASSERT_EQ(TT_STRING, v.type);
+		ASSERT_STREQ("Na(mol/kgw)", v.sVal);
+		ASSERT_EQ(VR_OK, pool.GetJobSelectedOutputValue(i, 1, 0, &v));
+		ASSERT_EQ(TT_DOUBLE, v.type);
+		ASSERT_EQ(expected, v.dVal);
+	}
+	ASSERT_EQ(VR_INVALIDROW, pool.GetJobSelectedOutputValue(0, 2, 0, &v));
+	ASSERT_EQ(VR_INVALIDCOL, pool.GetJobSelectedOutputValue(0, 0, 1, &v));
+	ASSERT_EQ(VR_INVALIDARG, pool.GetJobSelectedOutputValue(jobs + 1, 0, 0, &v));
+
+	// the saved solutions were copied back into the master
+	ASSERT_EQ(0, master.RunString("MIX 1\n  15 1\nSELECTED_OUTPUT 1\n  -reset false\n  -totals Na\nEND\n"));
+	ASSERT_EQ(VR_OK, master.GetSelectedOutputValue(1, 0, &v));
+	CVar w;
+	ASSERT_EQ(VR_OK, pool.GetJobSelectedOutputValue(4, 1, 0, &w));
+	ASSERT_NEAR(w.dVal, v.dVal, 1e-12);
+
+	// without workers jobs fail
+	pool.Stop();
+	ASSERT_EQ(0, pool.GetWorkerCount());
+	int orphan = pool.Submit(inputs[0].c_str());
+	ASSERT_EQ(1, pool.Wait());
+	ASSERT_EQ(-1, pool.GetJobErrorCount(orphan));
+	ASSERT_THAT(pool.GetJobErrorString(orphan), HasSubstr("No worker"));
+
+	pool.ClearJobs();
+	ASSERT_EQ(0, pool.GetJobCount());
+}
+
+TEST(TestIPhreeqc, TestPoolLoopThreads)
+{
+	// workers are forked after the master started its KNOBS -threads
+	IPhreeqcPool pool;
+	IPhreeqc& master = pool.GetMaster();
+	ASSERT_EQ(0, master.LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(0, master.RunString(
+		"KNOBS\n"
+		"  -threads 3\n"
+		"  -thread_threshold 1\n"
+		"SOLUTION 1\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"END\n"));
+	ASSERT_EQ(2, pool.Start(2));
+
+	const char input[] =
+		"USE solution 1\n"
+		"REACTION 1\n"
+		"  NaCl 1\n"
+		"  1 mmol\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -totals Na\n"
+		"END\n";
+	for (int i = 0; i < 4; ++i)
+	{
+		ASSERT_EQ(i, pool.Submit(input));
+	}
+	ASSERT_EQ(0, pool.Wait());
+
+	CVar v, w;
+	ASSERT_EQ(0, master.RunString(input));
+	ASSERT_EQ(VR_OK, master.GetSelectedOutputValue(1, 0, &v));
+	for (int i = 0; i < 4; ++i)
+	{
+		ASSERT_EQ(0, pool.GetJobErrorCount(i));
+		ASSERT_EQ(VR_OK, pool.GetJobSelectedOutputValue(i, 1, 0, &w));
+		ASSERT_EQ(v.dVal, w.dVal);
+	}
+}
+#endif
+
+struct AsyncRunData
+{
+	IPhreeqc* obj;
+	int calls;
+	int errors;
+	int rows;
+	VRESULT nested;
+};
+
+struct AsyncDeleteData
+{
+	IPhreeqc* obj;
+	int rows;
+	std::atomic<int> result;
+};
+
+static void AsyncRunDelete(int errors, void *cookie)
+{
+	AsyncDeleteData* data = (AsyncDeleteData*)cookie;
+	data->rows = data->obj->GetSelectedOutputRowCount();
+	delete data->obj;
+	data->result = errors + 100;
+}
+
+static void AsyncRunComplete(int errors, void *cookie)
+{
+	AsyncRunData* data = (AsyncRunData*)cookie;
+	++data->calls;
+	data->errors = errors;
+	data->rows   = data->obj->GetSelectedOutputRowCount();
+	data->nested = data->obj->RunStringAsync("END\n");
+}
+
+TEST(TestIPhreeqc, TestRunStringAsync)
+{
+	const char input[] =
+		"SOLUTION 1\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"REACTION 1\n"
+		"  NaCl 1\n"
+		"  10 mmol in 20 steps\n"
+		"SELECTED_OUTPUT 1\n"
+		"  -reset false\n"
+		"  -totals Na\n"
+		"END\n";
+
+	IPhreeqc obj;
+	ASSERT_EQ(0, obj.LoadDatabase("phreeqc.dat"));
+	ASSERT_TRUE(obj.IsRunComplete());
+	ASSERT_EQ(0, obj.WaitRun());
+	ASSERT_EQ(VR_INVALIDARG, obj.RunStringAsync(NULL));
+
+	ASSERT_EQ(0, obj.RunString(input));
+	std::vector<double> expected;
+	CVar v;
+	for (int r = 1; r < obj.GetSelectedOutputRowCount(); ++r)
+	{
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 0, &v));
+		expected.push_back(v.dVal);
+	}
+	ASSERT_EQ(21u, expected.size());
+
+	AsyncRunData data = { &obj, 0, -1, 0, VR_OK };
+	ASSERT_EQ(VR_OK, obj.RunStringAsync(input, AsyncRunComplete, &data));
+	ASSERT_EQ(0, obj.WaitRun());
+	ASSERT_TRUE(obj.IsRunComplete());
+	ASSERT_EQ(1, data.calls);
+	ASSERT_EQ(0, data.errors);
+	ASSERT_EQ(22, data.rows);
+	ASSERT_EQ(VR_INVALIDARG, data.nested);
+	ASSERT_EQ(22, obj.GetSelectedOutputRowCount());
+	for (int r = 1; r < obj.GetSelectedOutputRowCount(); ++r)
+	{
+		ASSERT_EQ(VR_OK, obj.GetSelectedOutputValue(r, 0, &v));
+		ASSERT_EQ(expected[r - 1], v.dVal);
+	}
+
+	// a run started while another is in progress waits for it
+	ASSERT_EQ(VR_OK, obj.RunStringAsync(input));
+	ASSERT_EQ(0, obj.RunString("SOLUTION 2\nSELECTED_OUTPUT 1\n  -reset false\n  -totals Na\nEND\n"));
+	ASSERT_TRUE(obj.IsRunComplete());
+	ASSERT_EQ(2, obj.GetSelectedOutputRowCount());
+
+	// errors
+	ASSERT_EQ(VR_OK, obj.RunStringAsync("MIX 1\n  99 1\nEND\n"));
+	ASSERT_GT(obj.WaitRun(), 0);
+	ASSERT_EQ(VR_OK, obj.RunFileAsync("missing_file.pqi"));
+	ASSERT_EQ(1, obj.WaitRun());
+	ASSERT_THAT(obj.GetErrorString(), HasSubstr("missing_file.pqi"));
+
+	// the destructor waits for the run
+	IPhreeqc* other = new IPhreeqc;
+	ASSERT_EQ(0, other->LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(VR_OK, other->RunStringAsync(input));
+	delete other;
+
+	// the callback may delete the instance
+	AsyncDeleteData del;
+	del.obj = new IPhreeqc;
+	del.rows = 0;
+	del.result = 0;
+	ASSERT_EQ(0, del.obj->LoadDatabase("phreeqc.dat"));
+	ASSERT_EQ(VR_OK, del.obj->RunStringAsync(input, AsyncRunDelete, &del));
+	for (int i = 0; i < 10000 && del.result == 0; ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_EQ(100, del.result);
+	ASSERT_EQ(22, del.rows);
+}
@@ -13,6 +13,8 @@ using ::testing::HasSubstr;
 
 #include <fstream>
 #include <string>
+#include <atomic>
+#include <thread>
 #include <string.h> // strstr
 #include <cmath>
 #include <cfloat>
@@ -4639,3 +4641,246 @@ TEST(TestIPhreeqcLib, TestIsZeroInitialized)
 	ASSERT_EQ((float)0, f);
 	ASSERT_EQ((double)0, d);
 }
+
+TEST(TestIPhreeqcLib, TestGetCellCost)
+{
+	const char input[] =
+		"SOLUTION 0\n"
+		"  Ca 1\n"
+		"  Cl 2\n"
+		"SOLUTION 1-4\n"
+		"  Na 1\n"
+		"  Cl 1\n"
+		"EQUILIBRIUM_PHASES 1-4\n"
+		"  Calcite 0 0.1\n"
+		"ADVECTION\n"
+		"  -cells 4\n"
+		"  -shifts 3\n"
+		"END\n";
+
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	ASSERT_EQ(0, ::GetCellCostCount(n));
+	ASSERT_EQ(0, ::RunString(n, input));
+	ASSERT_EQ(5, ::GetCellCostCount(n));
+
+	for (int cell = 1; cell <= 4; ++cell)
+	{
+		int iterations = -1, retries = -1, solves = -1, kinetic_steps = -1;
+		double seconds = -1;
+		ASSERT_EQ(IPQ_OK, ::GetCellCost(n, cell, &iterations, &retries, &solves, &kinetic_steps, &seconds));
+		ASSERT_GT(iterations, 0);
+		ASSERT_EQ(3, solves);
+		ASSERT_EQ(0, kinetic_steps);
+	}
+	ASSERT_EQ(IPQ_INVALIDARG, ::GetCellCost(n, 5, NULL, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::GetCellCost(-42, 1, NULL, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::GetCellCostCount(-42));
+
+	if (n >= 0)
+	{
+		ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+	}
+}
+
+TEST(TestIPhreeqcLib, TestGetDatabaseHash)
+{
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+	ASSERT_STREQ("", ::GetDatabaseHash(n));
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	std::string hash(::GetDatabaseHash(n));
+	ASSERT_EQ(8u, hash.size());
+
+	// the hash is of the text, however it is loaded
+	std::ifstream ifs("phreeqc.dat", std::ios_base::binary);
+	std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ASSERT_EQ(0, ::LoadDatabaseString(n, text.c_str()));
+	ASSERT_EQ(hash, std::string(::GetDatabaseHash(n)));
+
+	ASSERT_STREQ("", ::GetDatabaseHash(n + 1));
+	ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+}
+
+TEST(TestIPhreeqcLib, TestGetPhaseCounters)
+{
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	ASSERT_EQ(0, ::RunString(n, "KNOBS\n -phase_counters\nSOLUTION 1\n Na 1\n Cl 1\nEND\n"));
+
+	int calls = -1;
+	double seconds = -1;
+	ASSERT_EQ(IPQ_OK, ::GetPhaseCounters(n, 0, &calls, &seconds, NULL, NULL, NULL, NULL));
+	ASSERT_GT(calls, 0);
+	ASSERT_GE(seconds, 0.0);
+	ASSERT_EQ(IPQ_INVALIDARG, ::GetPhaseCounters(n, 5, NULL, NULL, NULL, NULL, NULL, NULL));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::GetPhaseCounters(-42, 0, NULL, NULL, NULL, NULL, NULL, NULL));
+
+	if (n >= 0)
+	{
+		ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+	}
+}
+
+TEST(TestIPhreeqcLib, TestGetRunStatistics)
+{
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	ASSERT_EQ(0, ::RunString(n, "SOLUTION 1\n Na 1\n Cl 1\nREACTION\n NaCl 1\n 0.1 mmol in 3 steps\nEND\n"));
+
+	RUN_STATISTICS stats;
+	ASSERT_EQ(IPQ_OK, ::GetRunStatistics(n, &stats));
+	ASSERT_GT(stats.iterations, 0);
+	ASSERT_EQ(3, stats.attempts[0]);
+	ASSERT_EQ(0, stats.failures);
+	ASSERT_GE(stats.calculations[5], 3);
+	ASSERT_EQ(IPQ_INVALIDARG, ::GetRunStatistics(n, NULL));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::GetRunStatistics(-42, &stats));
+
+	if (n >= 0)
+	{
+		ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+	}
+}
+
+TEST(TestIPhreeqcLib, TestSaveRestoreState)
+{
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	ASSERT_EQ(0, ::RunString(n, "SOLUTION 1\n Na 1\n Cl 1\nEND\n"));
+
+	int state = ::SaveState(n);
+	ASSERT_GE(state, 0);
+	ASSERT_EQ(0, ::RunString(n, "SOLUTION 1\n Na 2\n Cl 2\nEND\n"));
+	ASSERT_EQ(IPQ_OK, ::RestoreState(n, state));
+
+	ASSERT_EQ(0, ::RunString(n, "MIX 1\n 1 1\nSELECTED_OUTPUT\n -reset false\n -totals Na\nEND\n"));
+	ASSERT_EQ(2, ::GetSelectedOutputRowCount(n));
+	VAR v;
+	::VarInit(&v);
+	ASSERT_EQ(IPQ_OK, ::GetSelectedOutputValue(n, 1, 0, &v));
+	ASSERT_EQ(TT_DOUBLE, v.type);
+	ASSERT_NEAR(1e-3, v.dVal, 1e-6);
+
+	ASSERT_EQ(IPQ_OK, ::DeleteState(n, state));
+	ASSERT_EQ(IPQ_INVALIDARG, ::RestoreState(n, state));
+	ASSERT_EQ(IPQ_INVALIDARG, ::DeleteState(n, state));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::SaveState(-42));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::RestoreState(-42, 0));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::DeleteState(-42, 0));
+
+	if (n >= 0)
+	{
+		ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+	}
+}
+
+TEST(TestIPhreeqcLib, TestModifySolutionTotals)
+{
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	ASSERT_EQ(0, ::RunString(n,
+		"SOLUTION 1\n Na 1\n Cl 1\n"
+		"SELECTED_OUTPUT\n -reset false\n -totals Na\n"
+		"USER_PUNCH\n -headings H O charge\n 10 PUNCH TOTMOLE(\"H\"), TOTMOLE(\"O\"), CHARGE_BALANCE\n"
+		"END\n"));
+	ASSERT_EQ(2, ::GetSelectedOutputRowCount(n));
+	double r[3];
+	VAR v;
+	::VarInit(&v);
+	for (int j = 0; j < 3; ++j)
+	{
+		ASSERT_EQ(IPQ_OK, ::GetSelectedOutputValue(n, 1, j + 1, &v));
+		ASSERT_EQ(TT_DOUBLE, v.type);
+		r[j] = v.dVal;
+	}
+
+	const char* elements[] = { "Na", "Cl" };
+	const double moles[] = { 2e-3, 2e-3 };
+	ASSERT_EQ(IPQ_OK, ::ModifySolutionTotals(n, 1, r[0], r[1], r[2], 2, elements, moles));
+	ASSERT_EQ(0, ::RunString(n, "RUN_CELLS\n -cells 1\nEND\n"));
+	ASSERT_EQ(2, ::GetSelectedOutputRowCount(n));
+	ASSERT_EQ(IPQ_OK, ::GetSelectedOutputValue(n, 1, 0, &v));
+	ASSERT_EQ(TT_DOUBLE, v.type);
+	ASSERT_NEAR(2e-3, v.dVal, 1e-6);
+
+	ASSERT_EQ(IPQ_INVALIDARG, ::ModifySolutionTotals(n, 2, r[0], r[1], r[2], 2, elements, moles));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::ModifySolutionTotals(-42, 1, r[0], r[1], r[2], 2, elements, moles));
+
+	if (n >= 0)
+	{
+		ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+	}
+}
+
+static void AsyncRunCount(int errors, void *cookie)
+{
+	*(int*)cookie = errors + 100;
+}
+
+struct AsyncDestroyData
+{
+	int id;
+	std::atomic<int> result;
+};
+
+static void AsyncRunDestroy(int errors, void *cookie)
+{
+	AsyncDestroyData* data = (AsyncDestroyData*)cookie;
+	data->result = (::DestroyIPhreeqc(data->id) == IPQ_OK) ? errors + 100 : -1;
+}
+
+TEST(TestIPhreeqcLib, TestRunStringAsync)
+{
+	int n = ::CreateIPhreeqc();
+	ASSERT_TRUE(n >= 0);
+
+	ASSERT_EQ(0, ::LoadDatabase(n, "phreeqc.dat"));
+	ASSERT_EQ(1, ::IsRunComplete(n));
+	ASSERT_EQ(0, ::WaitRun(n));
+
+	int result = 0;
+	ASSERT_EQ(IPQ_OK, ::RunStringAsync(n, "SOLUTION 1\n Na 1\n Cl 1\nSELECTED_OUTPUT\n -reset false\n -totals Na\nEND\n", AsyncRunCount, &result));
+	ASSERT_EQ(0, ::WaitRun(n));
+	ASSERT_EQ(1, ::IsRunComplete(n));
+	ASSERT_EQ(100, result);
+	ASSERT_EQ(2, ::GetSelectedOutputRowCount(n));
+
+	ASSERT_EQ(IPQ_OK, ::RunFileAsync(n, "missing_file.pqi", NULL, NULL));
+	ASSERT_EQ(1, ::WaitRun(n));
+	ASSERT_EQ(IPQ_INVALIDARG, ::RunStringAsync(n, NULL, NULL, NULL));
+
+	ASSERT_EQ(IPQ_BADINSTANCE, ::RunStringAsync(-42, "END\n", NULL, NULL));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::RunFileAsync(-42, "missing_file.pqi", NULL, NULL));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::WaitRun(-42));
+	ASSERT_EQ(IPQ_BADINSTANCE, ::IsRunComplete(-42));
+
+	if (n >= 0)
+	{
+		ASSERT_EQ(IPQ_OK, ::DestroyIPhreeqc(n));
+	}
+
+	// the callback may destroy the instance
+	AsyncDestroyData data;
+	data.id = ::CreateIPhreeqc();
+	data.result = 0;
+	ASSERT_TRUE(data.id >= 0);
+	ASSERT_EQ(0, ::LoadDatabase(data.id, "phreeqc.dat"));
+	ASSERT_EQ(IPQ_OK, ::RunStringAsync(data.id, "SOLUTION 1\nEND\n", AsyncRunDestroy, &data));
+	for (int i = 0; i < 10000 && data.result == 0; ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_EQ(100, data.result);
+	ASSERT_EQ(IPQ_BADINSTANCE, ::WaitRun(data.id));
+}
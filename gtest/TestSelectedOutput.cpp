@@ -667,3 +667,68 @@ TEST(TestSelectedOutput, TestLongHeadings)
 	CVar v1 = co.Get(1, 0);
 	ASSERT_EQ(TT_EMPTY, v1.type);
 }
+
+TEST(TestSelectedOutput, TestColumnOrderChanges)
+{
+	CSelectedOutput co;
+
+	// A B C
+	ASSERT_EQ(0, co.PushBackDouble("A", 1.0));
+	ASSERT_EQ(0, co.PushBackDouble("B", 2.0));
+	ASSERT_EQ(0, co.PushBackDouble("C", 3.0));
+	ASSERT_EQ(0, co.EndRow());
+
+	// same order
+	ASSERT_EQ(0, co.PushBackDouble("A", 4.0));
+	ASSERT_EQ(0, co.PushBackDouble("B", 5.0));
+	ASSERT_EQ(0, co.PushBackDouble("C", 6.0));
+	ASSERT_EQ(0, co.EndRow());
+
+	// C B, A missing, D new
+	ASSERT_EQ(0, co.PushBackDouble("C", 7.0));
+	ASSERT_EQ(0, co.PushBackDouble("B", 8.0));
+	ASSERT_EQ(0, co.PushBackDouble("D", 9.0));
+	ASSERT_EQ(0, co.EndRow());
+
+	// A again, B pushed twice
+	ASSERT_EQ(0, co.PushBackDouble("A", 10.0));
+	ASSERT_EQ(0, co.PushBackDouble("B", 11.0));
+	ASSERT_EQ(0, co.PushBackDouble("B", 12.0));
+	ASSERT_EQ(0, co.EndRow());
+
+	ASSERT_EQ((size_t)4, co.GetColCount());
+	ASSERT_EQ((size_t)5, co.GetRowCount());
+
+	ASSERT_EQ(std::string("A"), std::string(co.Get(0, 0).sVal));
+	ASSERT_EQ(std::string("B"), std::string(co.Get(0, 1).sVal));
+	ASSERT_EQ(std::string("C"), std::string(co.Get(0, 2).sVal));
+	ASSERT_EQ(std::string("D"), std::string(co.Get(0, 3).sVal));
+
+	ASSERT_EQ(1.0,  co.Get(1, 0).dVal);
+	ASSERT_EQ(2.0,  co.Get(1, 1).dVal);
+	ASSERT_EQ(3.0,  co.Get(1, 2).dVal);
+	ASSERT_EQ(TT_EMPTY, co.Get(1, 3).type);
+
+	ASSERT_EQ(4.0,  co.Get(2, 0).dVal);
+	ASSERT_EQ(5.0,  co.Get(2, 1).dVal);
+	ASSERT_EQ(6.0,  co.Get(2, 2).dVal);
+	ASSERT_EQ(TT_EMPTY, co.Get(2, 3).type);
+
+	ASSERT_EQ(TT_EMPTY, co.Get(3, 0).type);
+	ASSERT_EQ(8.0,  co.Get(3, 1).dVal);
+	ASSERT_EQ(7.0,  co.Get(3, 2).dVal);
+	ASSERT_EQ(9.0,  co.Get(3, 3).dVal);
+
+	ASSERT_EQ(10.0, co.Get(4, 0).dVal);
+	ASSERT_EQ(12.0, co.Get(4, 1).dVal);
+	ASSERT_EQ(TT_EMPTY, co.Get(4, 2).type);
+	ASSERT_EQ(TT_EMPTY, co.Get(4, 3).type);
+
+	// cleared schema
+	co.Clear();
+	ASSERT_EQ(0, co.PushBackDouble("B", 13.0));
+	ASSERT_EQ(0, co.EndRow());
+	ASSERT_EQ((size_t)1, co.GetColCount());
+	ASSERT_EQ(std::string("B"), std::string(co.Get(0, 0).sVal));
+	ASSERT_EQ(13.0, co.Get(1, 0).dVal);
+}
@@ -27,6 +27,7 @@ const size_t RESERVE_COLS = 80;
 
 CSelectedOutput::CSelectedOutput()
 : m_nRowCount(0)
+, m_nPushCount(0)
 {
 	this->m_arrayVar.reserve(RESERVE_COLS);
 }
@@ -41,6 +42,8 @@ void CSelectedOutput::Clear(void)
 	this->m_vecVarHeadings.clear();
 	this->m_arrayVar.clear();
 	this->m_mapHeadingToCol.clear();
+	this->m_vecPushCol.clear();
+	this->m_nPushCount = 0;
 }
 
 size_t CSelectedOutput::GetRowCount(void)const
@@ -99,6 +102,7 @@ VRESULT CSelectedOutput::Get(int nRow, int nCol, VAR* pVAR)const
 
 int CSelectedOutput::EndRow(void)
 {
+	this->m_nPushCount = 0;
 	if (size_t ncols = this->GetColCount())
 	{
 		++this->m_nRowCount;
@@ -127,42 +131,62 @@ int CSelectedOutput::PushBack(const char* key, const CVar& var)
 {
 	try
 	{
-		// check if key is new
-		std::map< std::string, size_t >::iterator find;
-		find = this->m_mapHeadingToCol.find(std::string(key));
-		if (find == this->m_mapHeadingToCol.end())
+		// rows are usually punched in the same column order, so try the
+		// column the previous row had at this position before the map
+		size_t col;
+		if (this->m_nPushCount < this->m_vecPushCol.size() &&
+			::strcmp(this->m_vecVarHeadings[this->m_vecPushCol[this->m_nPushCount]].sVal, key) == 0)
 		{
-			// new key(column)
-			//
-			this->m_mapHeadingToCol.insert(std::map< std::string, size_t >::value_type(std::string(key),
-				this->m_mapHeadingToCol.size()) );
-
-			// add heading
-			//
-			this->m_vecVarHeadings.push_back(CVar(key));
+			col = this->m_vecPushCol[this->m_nPushCount];
+		}
+		else
+		{
+			// check if key is new
+			std::map< std::string, size_t >::iterator find;
+			find = this->m_mapHeadingToCol.find(std::string(key));
+			if (find == this->m_mapHeadingToCol.end())
+			{
+				// new key(column)
+				//
+				col = this->m_mapHeadingToCol.size();
+				this->m_mapHeadingToCol.insert(std::map< std::string, size_t >::value_type(std::string(key), col));
 
+				// add heading
+				//
+				this->m_vecVarHeadings.push_back(CVar(key));
 
-			// add new vector(col)
-			//
-			this->m_arrayVar.resize(this->m_arrayVar.size() + 1);
-			this->m_arrayVar.back().reserve(RESERVE_ROWS);
 
-			// add empty rows if nec
-			if (this->m_nRowCount)
-				this->m_arrayVar.back().resize(this->m_nRowCount);
+				// add new vector(col)
+				//
+				this->m_arrayVar.resize(this->m_arrayVar.size() + 1);
+				this->m_arrayVar.back().reserve(RESERVE_ROWS);
 
-			this->m_arrayVar.back().push_back(var);
-		}
-		else
-		{
-			if (this->m_arrayVar[find->second].size() == this->m_nRowCount) {
-				this->m_arrayVar[find->second].push_back(var);
+				// add empty rows if nec
+				if (this->m_nRowCount)
+					this->m_arrayVar.back().resize(this->m_nRowCount);
 			}
-			else {
-				ASSERT(this->m_arrayVar[find->second].size() == this->m_nRowCount + 1);
-				this->m_arrayVar[find->second].at(this->m_nRowCount) = var;
+			else
+			{
+				col = find->second;
+			}
+			if (this->m_nPushCount < this->m_vecPushCol.size())
+			{
+				this->m_vecPushCol[this->m_nPushCount] = col;
+			}
+			else
+			{
+				this->m_vecPushCol.push_back(col);
 			}
 		}
+		++this->m_nPushCount;
+
+		if (this->m_arrayVar[col].size() == this->m_nRowCount) {
+			this->m_arrayVar[col].push_back(var);
+		}
+		else {
+			ASSERT(this->m_arrayVar[col].size() == this->m_nRowCount + 1);
+			this->m_arrayVar[col].at(this->m_nRowCount) = var;
+		}
 		return 0;
 	}
 	catch(...)
@@ -70,6 +70,10 @@ protected:
 	std::vector<CVar> m_vecVarHeadings;
 	std::map< std::string, size_t > m_mapHeadingToCol;
 
+	// column of the n-th value pushed in the previous row
+	std::vector<size_t> m_vecPushCol;
+	size_t m_nPushCount;
+
 private:
 	static CSelectedOutput* s_instance;
 };
@@ -11,6 +11,14 @@
 #include "CSelectedOutput.hxx"          // CSelectedOutput
 #include "SelectedOutput.h"             // SelectedOutput
 #include "dumper.h"                     // dumper
+#include "Solution.h"                   // cxxSolution
+#include "Exchange.h"                   // cxxExchange
+#include "GasPhase.h"                   // cxxGasPhase
+#include "cxxKinetics.h"                // cxxKinetics
+#include "PPassemblage.h"               // cxxPPassemblage
+#include "SSassemblage.h"               // cxxSSassemblage
+#include "Reaction.h"                   // cxxReaction
+#include "Temperature.h"                // cxxTemperature
 
 // statics
 std::map<size_t, IPhreeqc*> IPhreeqc::Instances;
@@ -20,6 +28,170 @@ std::string IPhreeqc::Version(VERSION_STRING);
 
 static const char empty[] = "";
 
+// reactants of a Phreeqc instance, see IPhreeqc::SaveState
+class IPhreeqcState
+{
+public:
+	std::map<int, cxxSolution>      Rxn_solution_map;
+	std::map<int, cxxExchange>      Rxn_exchange_map;
+	std::map<int, cxxGasPhase>      Rxn_gas_phase_map;
+	std::map<int, cxxKinetics>      Rxn_kinetics_map;
+	std::map<int, cxxPPassemblage>  Rxn_pp_assemblage_map;
+	std::map<int, cxxSSassemblage>  Rxn_ss_assemblage_map;
+	std::map<int, cxxSurface>       Rxn_surface_map;
+	std::map<int, cxxMix>           Rxn_mix_map;
+	std::map<int, cxxReaction>      Rxn_reaction_map;
+	std::map<int, cxxTemperature>   Rxn_temperature_map;
+	std::map<int, cxxPressure>      Rxn_pressure_map;
+	std::map<int, cxxMix>           Rxn_solution_mix_map;
+	std::map<int, cxxMix>           Rxn_exchange_mix_map;
+	std::map<int, cxxMix>           Rxn_gas_phase_mix_map;
+	std::map<int, cxxMix>           Rxn_kinetics_mix_map;
+	std::map<int, cxxMix>           Rxn_pp_assemblage_mix_map;
+	std::map<int, cxxMix>           Rxn_ss_assemblage_mix_map;
+	std::map<int, cxxMix>           Rxn_surface_mix_map;
+	std::map<std::string, double>   save_values;
+};
+
+// a run started by IPhreeqc::RunFileAsync or IPhreeqc::RunStringAsync
+class IPhreeqcAsync
+{
+public:
+	IPhreeqcAsync(IPhreeqc* instance, const char* input, bool is_file, PFN_RUN_COMPLETE_CALLBACK pfn, void* cookie)
+	: Instance(instance)
+	, Input(input)
+	, IsFile(is_file)
+	, Callback(pfn)
+	, Cookie(cookie)
+	, Errors(0)
+	, Done(false)
+	, Joined(false)
+	, Detached(false)
+	{
+		mutex_init(&this->Lock);
+	}
+	~IPhreeqcAsync(void)
+	{
+		mutex_delete(&this->Lock);
+	}
+
+	bool start(void)
+	{
+#if defined(_WIN32)
+		this->Thread = ::CreateThread(NULL, 0, IPhreeqcAsync::thread_proc, this, 0, &this->ThreadId);
+		return this->Thread != NULL;
+#else
+		return ::pthread_create(&this->Thread, NULL, IPhreeqcAsync::thread_proc, this) == 0;
+#endif
+	}
+	void join(void)
+	{
+		if (!this->Joined)
+		{
+#if defined(_WIN32)
+			::WaitForSingleObject(this->Thread, INFINITE);
+			::CloseHandle(this->Thread);
+#else
+			::pthread_join(this->Thread, NULL);
+#endif
+			this->Joined = true;
+		}
+	}
+	// called from the callback when it destroys the instance;
+	// the run then frees itself once the callback returns
+	void detach(void)
+	{
+#if defined(_WIN32)
+		::CloseHandle(this->Thread);
+#else
+		::pthread_detach(this->Thread);
+#endif
+		this->Instance = 0;
+		this->Detached = true;
+	}
+	bool is_done(void)
+	{
+		mutex_lock(&this->Lock);
+		bool done = this->Done;
+		mutex_unlock(&this->Lock);
+		return done;
+	}
+	bool on_thread(void)const
+	{
+		// thread ids are only reused once the thread has been joined
+		if (this->Joined) return false;
+#if defined(_WIN32)
+		return ::GetCurrentThreadId() == this->ThreadId;
+#else
+		return ::pthread_equal(::pthread_self(), this->Thread) != 0;
+#endif
+	}
+
+	IPhreeqc*                  Instance;
+	std::string                Input;               // input string or file name
+	bool                       IsFile;
+	PFN_RUN_COMPLETE_CALLBACK  Callback;
+	void*                      Cookie;
+	int                        Errors;
+	bool                       Done;                // guarded by Lock
+	bool                       Joined;
+	bool                       Detached;            // set and read on the thread only
+	mutex_t                    Lock;
+#if defined(_WIN32)
+	HANDLE                     Thread;
+	DWORD                      ThreadId;
+#else
+	pthread_t                  Thread;
+#endif
+
+protected:
+	void run(void)
+	{
+		this->Errors = this->IsFile ?
+			this->Instance->RunFile(this->Input.c_str()) :
+			this->Instance->RunString(this->Input.c_str());
+		if (this->Callback)
+		{
+			this->Callback(this->Errors, this->Cookie);
+		}
+		if (this->Detached)
+		{
+			delete this;
+			return;
+		}
+		mutex_lock(&this->Lock);
+		this->Done = true;
+		mutex_unlock(&this->Lock);
+	}
+#if defined(_WIN32)
+	static DWORD WINAPI thread_proc(LPVOID p)
+	{
+		((IPhreeqcAsync*)p)->run();
+		return 0;
+	}
+#else
+	static void* thread_proc(void* p)
+	{
+		((IPhreeqcAsync*)p)->run();
+		return NULL;
+	}
+#endif
+};
+
+// FNV-1a hash of the database text, written to slow-cell captures
+static std::string hash_database(const std::string& text)
+{
+	unsigned int h = 2166136261u;
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		h ^= (unsigned char)text[i];
+		h *= 16777619u;
+	}
+	char buffer[16];
+	::snprintf(buffer, sizeof(buffer), "%08x", h);
+	return std::string(buffer);
+}
+
 
 IPhreeqc::IPhreeqc(void)
 : DatabaseLoaded(false)
@@ -37,6 +209,8 @@ IPhreeqc::IPhreeqc(void)
 , WarningStringOn(true)
 , WarningReporter(0)
 , CurrentSelectedOutputUserNumber(1)
+, SavedStatesIndex(0)
+, Async(0)
 , PhreeqcPtr(0)
 , input_file(0)
 , database_file(0)
@@ -69,6 +243,17 @@ IPhreeqc::IPhreeqc(void)
 
 IPhreeqc::~IPhreeqc(void)
 {
+	if (this->Async && this->Async->on_thread())
+	{
+		// destroyed from the completion callback, which cannot wait for itself
+		this->Async->detach();
+	}
+	else
+	{
+		this->WaitRun();
+		delete this->Async;
+	}
+
 #if !defined(NDEBUG)
 	this->OutputFileOn = false;
 #endif
@@ -83,6 +268,8 @@ IPhreeqc::~IPhreeqc(void)
 	}
 	this->SelectedOutputMap.clear();
 
+	this->DeleteSavedStates();
+
 	mutex_lock(&map_lock);
 	std::map<size_t, IPhreeqc*>::iterator it = IPhreeqc::Instances.find(this->Index);
 	if (it != IPhreeqc::Instances.end())
@@ -94,6 +281,7 @@ IPhreeqc::~IPhreeqc(void)
 
 VRESULT IPhreeqc::AccumulateLine(const char *line)
 {
+	this->WaitRun();
 	try
 	{
 		if (this->ClearAccumulated)
@@ -128,14 +316,48 @@ size_t IPhreeqc::AddWarning(const char* str)
 
 void IPhreeqc::ClearAccumulatedLines(void)
 {
+	this->WaitRun();
 	this->StringInput.erase();
 }
 
+VRESULT IPhreeqc::DeleteState(int n)
+{
+	this->WaitRun();
+	std::map< int, IPhreeqcState* >::iterator it = this->SavedStates.find(n);
+	if (it == this->SavedStates.end())
+	{
+		return VR_INVALIDARG;
+	}
+	delete (*it).second;
+	this->SavedStates.erase(it);
+	return VR_OK;
+}
+
 const std::string& IPhreeqc::GetAccumulatedLines(void)
 {
 	return this->StringInput;
 }
 
+VRESULT IPhreeqc::GetCellCost(int cell, int* iterations, int* retries, int* solves, int* kinetic_steps, double* seconds)const
+{
+	if (cell < 0 || cell >= this->GetCellCostCount())
+	{
+		return VR_INVALIDARG;
+	}
+	const cell_cost& cost = this->PhreeqcPtr->cell_costs[cell];
+	if (iterations)    *iterations    = cost.iterations;
+	if (retries)       *retries       = cost.retries;
+	if (solves)        *solves        = cost.solves;
+	if (kinetic_steps) *kinetic_steps = cost.kinetic_steps;
+	if (seconds)       *seconds       = (double)cost.time;
+	return VR_OK;
+}
+
+int IPhreeqc::GetCellCostCount(void)const
+{
+	return (int)this->PhreeqcPtr->cell_costs.size();
+}
+
 const char* IPhreeqc::GetComponent(int n)
 {
 	static const char empty[] = "";
@@ -163,6 +385,11 @@ int IPhreeqc::GetCurrentSelectedOutputUserNumber(void)const
 	return this->CurrentSelectedOutputUserNumber;
 }
 
+const char* IPhreeqc::GetDatabaseHash(void)const
+{
+	return this->PhreeqcPtr->database_hash.c_str();
+}
+
 const char* IPhreeqc::GetDumpFileName(void)const
 {
 	return this->DumpFileName.c_str();
@@ -354,6 +581,49 @@ bool IPhreeqc::GetOutputStringOn(void)const
 	return this->OutputStringOn;
 }
 
+VRESULT IPhreeqc::GetPhaseCounters(int phase, int* calls, double* seconds, double* cycles, double* instructions, double* cache_misses, double* branch_misses)const
+{
+	if (phase < 0 || phase >= PhaseCounters::PHASE_COUNT)
+	{
+		return VR_INVALIDARG;
+	}
+	const PhaseCounters::phase& counters = this->PhreeqcPtr->phase_counters.Get_phase(phase);
+	if (calls)         *calls         = counters.calls;
+	if (seconds)       *seconds       = (double)counters.time;
+	if (cycles)        *cycles        = (double)counters.events[PhaseCounters::CYCLES];
+	if (instructions)  *instructions  = (double)counters.events[PhaseCounters::INSTRUCTIONS];
+	if (cache_misses)  *cache_misses  = (double)counters.events[PhaseCounters::CACHE_MISSES];
+	if (branch_misses) *branch_misses = (double)counters.events[PhaseCounters::BRANCH_MISSES];
+	return VR_OK;
+}
+
+VRESULT IPhreeqc::GetRunStatistics(RUN_STATISTICS* stats)const
+{
+	if (!stats)
+	{
+		return VR_INVALIDARG;
+	}
+	const run_statistics& rs = this->PhreeqcPtr->run_stats;
+	stats->iterations = rs.iterations;
+	stats->jacobians  = rs.jacobians;
+	for (int i = 0; i < RS_ATTEMPT_COUNT; ++i)
+	{
+		stats->attempts[i] = rs.attempts[i];
+	}
+	stats->failures   = rs.failures;
+	for (int i = 0; i < RS_CALCULATION_COUNT; ++i)
+	{
+		stats->calculations[i] = rs.calculations[i];
+	}
+	stats->cvode_steps = rs.cvode_steps;
+	stats->rk_steps    = rs.rk_steps;
+	stats->rk_rejected = rs.rk_rejected;
+	stats->line_searches = rs.line_searches;
+	stats->g_sweeps = rs.g_sweeps;
+	stats->donnan_sweeps = rs.donnan_sweeps;
+	return VR_OK;
+}
+
 int IPhreeqc::GetSelectedOutputColumnCount(void)const
 {
 	std::map< int, CSelectedOutput* >::const_iterator ci = this->SelectedOutputMap.find(this->CurrentSelectedOutputUserNumber);
@@ -558,6 +828,11 @@ int IPhreeqc::GetWarningStringLineCount(void)const
 	return (int)this->WarningLines.size();
 }
 
+bool IPhreeqc::IsRunComplete(void)const
+{
+	return this->Async == 0 || this->Async->is_done();
+}
+
 std::list< std::string > IPhreeqc::ListComponents(void)
 {
 	if (this->UpdateComponents)
@@ -595,6 +870,11 @@ int IPhreeqc::load_db(const char* filename)
 			this->PhreeqcPtr->error_msg(oss.str().c_str(), STOP); // throws
 		}
 
+		std::ifstream hash_ifs(filename, std::ios_base::binary);
+		std::ostringstream hash_oss;
+		hash_oss << hash_ifs.rdbuf();
+		this->PhreeqcPtr->database_hash = hash_database(hash_oss.str());
+
 		// read input
 		//
 		ASSERT(this->PhreeqcPtr->phrq_io->get_istream() == NULL);
@@ -625,6 +905,7 @@ int IPhreeqc::load_db(const char* filename)
 
 int IPhreeqc::LoadDatabase(const char* filename)
 {
+	this->WaitRun();
 	// save I/O state
 	bool bSaveErrorFileOn  = this->ErrorFileOn;
 	bool bSaveOutputOn     = this->OutputFileOn;
@@ -657,6 +938,7 @@ int IPhreeqc::load_db_str(const char* input)
 
 		std::string s(input);
 		std::istringstream iss(s);
+		this->PhreeqcPtr->database_hash = hash_database(s);
 
 		// read input
 		//
@@ -689,6 +971,7 @@ int IPhreeqc::load_db_str(const char* input)
 
 int IPhreeqc::LoadDatabaseString(const char* input)
 {
+	this->WaitRun();
 	// save I/O state
 	bool bSaveErrorFileOn  = this->ErrorFileOn;
 	bool bSaveOutputOn     = this->OutputFileOn;
@@ -711,6 +994,42 @@ int IPhreeqc::LoadDatabaseString(const char* input)
 	return n;
 }
 
+VRESULT IPhreeqc::ModifySolutionTotals(int n, double total_h, double total_o, double cb, int count, const char* const* elements, const double* moles)
+{
+	this->WaitRun();
+	if (count < 0 || (count > 0 && (elements == NULL || moles == NULL)))
+	{
+		return VR_INVALIDARG;
+	}
+	cxxSolution* solution_ptr = Utilities::Rxn_find(this->PhreeqcPtr->Rxn_solution_map, n);
+	if (solution_ptr == NULL)
+	{
+		return VR_INVALIDARG;
+	}
+	cxxNameDouble nd;
+	nd.type = cxxNameDouble::ND_ELT_MOLES;
+	for (int i = 0; i < count; ++i)
+	{
+		if (elements[i] == NULL || this->PhreeqcPtr->master_bsearch(elements[i]) == NULL)
+		{
+			return VR_INVALIDARG;
+		}
+		nd[elements[i]] = moles[i];
+	}
+
+	// unlisted elements keep their totals, as with SOLUTION_MODIFY -totals
+	cxxNameDouble original(solution_ptr->Get_totals());
+	cxxNameDouble totals(original);
+	totals.merge_redox(nd);
+	solution_ptr->Set_total_h(total_h);
+	solution_ptr->Set_total_o(total_o);
+	solution_ptr->Set_cb(cb);
+	solution_ptr->Set_totals(totals);
+	solution_ptr->Update_activities(original);
+	this->UpdateComponents = true;
+	return VR_OK;
+}
+
 void IPhreeqc::OutputAccumulatedLines(void)
 {
 #if !defined(R_SO)
@@ -732,8 +1051,42 @@ void IPhreeqc::OutputWarningString(void)
 #endif
 }
 
+VRESULT IPhreeqc::RestoreState(int n)
+{
+	this->WaitRun();
+	std::map< int, IPhreeqcState* >::const_iterator it = this->SavedStates.find(n);
+	if (it == this->SavedStates.end())
+	{
+		return VR_INVALIDARG;
+	}
+	const IPhreeqcState& state = *(*it).second;
+	Phreeqc& p = *this->PhreeqcPtr;
+	p.Rxn_solution_map          = state.Rxn_solution_map;
+	p.Rxn_exchange_map          = state.Rxn_exchange_map;
+	p.Rxn_gas_phase_map         = state.Rxn_gas_phase_map;
+	p.Rxn_kinetics_map          = state.Rxn_kinetics_map;
+	p.Rxn_pp_assemblage_map     = state.Rxn_pp_assemblage_map;
+	p.Rxn_ss_assemblage_map     = state.Rxn_ss_assemblage_map;
+	p.Rxn_surface_map           = state.Rxn_surface_map;
+	p.Rxn_mix_map               = state.Rxn_mix_map;
+	p.Rxn_reaction_map          = state.Rxn_reaction_map;
+	p.Rxn_temperature_map       = state.Rxn_temperature_map;
+	p.Rxn_pressure_map          = state.Rxn_pressure_map;
+	p.Rxn_solution_mix_map      = state.Rxn_solution_mix_map;
+	p.Rxn_exchange_mix_map      = state.Rxn_exchange_mix_map;
+	p.Rxn_gas_phase_mix_map     = state.Rxn_gas_phase_mix_map;
+	p.Rxn_kinetics_mix_map      = state.Rxn_kinetics_mix_map;
+	p.Rxn_pp_assemblage_mix_map = state.Rxn_pp_assemblage_mix_map;
+	p.Rxn_ss_assemblage_mix_map = state.Rxn_ss_assemblage_mix_map;
+	p.Rxn_surface_mix_map       = state.Rxn_surface_mix_map;
+	p.save_values               = state.save_values;
+	this->UpdateComponents = true;
+	return VR_OK;
+}
+
 int IPhreeqc::RunAccumulated(void)
 {
+	this->WaitRun();
 	static const char *sz_routine = "RunAccumulated";
 	try
 	{
@@ -795,6 +1148,7 @@ int IPhreeqc::RunAccumulated(void)
 
 int IPhreeqc::RunFile(const char* filename)
 {
+	this->WaitRun();
 	static const char *sz_routine = "RunFile";
 	try
 	{
@@ -863,8 +1217,14 @@ int IPhreeqc::RunFile(const char* filename)
 	return this->PhreeqcPtr->get_input_errors();
 }
 
+VRESULT IPhreeqc::RunFileAsync(const char* filename, PFN_RUN_COMPLETE_CALLBACK pfn, void* cookie)
+{
+	return this->run_async(filename, true, pfn, cookie);
+}
+
 int IPhreeqc::RunString(const char* input)
 {
+	this->WaitRun();
 	static const char *sz_routine = "RunString";
 	try
 	{
@@ -926,23 +1286,62 @@ int IPhreeqc::RunString(const char* input)
 	return this->PhreeqcPtr->get_input_errors();
 }
 
+VRESULT IPhreeqc::RunStringAsync(const char* input, PFN_RUN_COMPLETE_CALLBACK pfn, void* cookie)
+{
+	return this->run_async(input, false, pfn, cookie);
+}
+
+int IPhreeqc::SaveState(void)
+{
+	this->WaitRun();
+	const Phreeqc& p = *this->PhreeqcPtr;
+	IPhreeqcState* state = new IPhreeqcState;
+	state->Rxn_solution_map          = p.Rxn_solution_map;
+	state->Rxn_exchange_map          = p.Rxn_exchange_map;
+	state->Rxn_gas_phase_map         = p.Rxn_gas_phase_map;
+	state->Rxn_kinetics_map          = p.Rxn_kinetics_map;
+	state->Rxn_pp_assemblage_map     = p.Rxn_pp_assemblage_map;
+	state->Rxn_ss_assemblage_map     = p.Rxn_ss_assemblage_map;
+	state->Rxn_surface_map           = p.Rxn_surface_map;
+	state->Rxn_mix_map               = p.Rxn_mix_map;
+	state->Rxn_reaction_map          = p.Rxn_reaction_map;
+	state->Rxn_temperature_map       = p.Rxn_temperature_map;
+	state->Rxn_pressure_map          = p.Rxn_pressure_map;
+	state->Rxn_solution_mix_map      = p.Rxn_solution_mix_map;
+	state->Rxn_exchange_mix_map      = p.Rxn_exchange_mix_map;
+	state->Rxn_gas_phase_mix_map     = p.Rxn_gas_phase_mix_map;
+	state->Rxn_kinetics_mix_map      = p.Rxn_kinetics_mix_map;
+	state->Rxn_pp_assemblage_mix_map = p.Rxn_pp_assemblage_mix_map;
+	state->Rxn_ss_assemblage_mix_map = p.Rxn_ss_assemblage_mix_map;
+	state->Rxn_surface_mix_map       = p.Rxn_surface_mix_map;
+	state->save_values               = p.save_values;
+
+	int n = this->SavedStatesIndex++;
+	this->SavedStates[n] = state;
+	return n;
+}
+
 void IPhreeqc::SetBasicCallback(double (*fcn)(double x1, double x2, const char *str, void *cookie), void *cookie1)
 {
+	this->WaitRun();
 	this->PhreeqcPtr->register_basic_callback(fcn, cookie1);
 }
 #ifdef IPHREEQC_NO_FORTRAN_MODULE
 void IPhreeqc::SetBasicFortranCallback(double (*fcn)(double *x1, double *x2, const char *str, size_t l))
 {
+	this->WaitRun();
 	this->PhreeqcPtr->register_fortran_basic_callback(fcn);
 }
 #else
 void IPhreeqc::SetBasicFortranCallback(double (*fcn)(double *x1, double *x2, const char *str, int l))
 {
+	this->WaitRun();
 	this->PhreeqcPtr->register_fortran_basic_callback(fcn);
 }
 #endif
 VRESULT IPhreeqc::SetCurrentSelectedOutputUserNumber(int n)
 {
+	this->WaitRun();
 	if (0 <= n)
 	{
 		this->CurrentSelectedOutputUserNumber = n;
@@ -953,6 +1352,7 @@ VRESULT IPhreeqc::SetCurrentSelectedOutputUserNumber(int n)
 
 void IPhreeqc::SetDumpFileName(const char *filename)
 {
+	this->WaitRun();
 	if (filename && ::strlen(filename))
 	{
 		this->DumpFileName = filename;
@@ -962,16 +1362,19 @@ void IPhreeqc::SetDumpFileName(const char *filename)
 
 void IPhreeqc::SetDumpFileOn(bool bValue)
 {
+	this->WaitRun();
 	this->DumpOn = bValue;
 }
 
 void IPhreeqc::SetDumpStringOn(bool bValue)
 {
+	this->WaitRun();
 	this->DumpStringOn = bValue;
 }
 
 void IPhreeqc::SetErrorFileName(const char *filename)
 {
+	this->WaitRun();
 	if (filename && ::strlen(filename))
 	{
 		this->ErrorFileName = filename;
@@ -980,21 +1383,25 @@ void IPhreeqc::SetErrorFileName(const char *filename)
 
 void IPhreeqc::SetErrorFileOn(bool bValue)
 {
+	this->WaitRun();
 	this->ErrorFileOn = bValue;
 }
 
 void IPhreeqc::SetErrorOn(bool bValue)
 {
+	this->WaitRun();
 	this->Set_error_on(bValue);
 }
 
 void IPhreeqc::SetErrorStringOn(bool bValue)
 {
+	this->WaitRun();
 	this->ErrorStringOn = bValue;
 }
 
 void IPhreeqc::SetLogFileName(const char *filename)
 {
+	this->WaitRun();
 	if (filename && ::strlen(filename))
 	{
 		this->LogFileName = filename;
@@ -1003,16 +1410,19 @@ void IPhreeqc::SetLogFileName(const char *filename)
 
 void IPhreeqc::SetLogFileOn(bool bValue)
 {
+	this->WaitRun();
 	this->LogFileOn = bValue;
 }
 
 void IPhreeqc::SetLogStringOn(bool bValue)
 {
+	this->WaitRun();
 	this->LogStringOn = bValue;
 }
 
 void IPhreeqc::SetOutputFileName(const char *filename)
 {
+	this->WaitRun();
 	if (filename && ::strlen(filename))
 	{
 		this->OutputFileName = filename;
@@ -1021,16 +1431,19 @@ void IPhreeqc::SetOutputFileName(const char *filename)
 
 void IPhreeqc::SetOutputStringOn(bool bValue)
 {
+	this->WaitRun();
 	this->OutputStringOn = bValue;
 }
 
 void IPhreeqc::SetOutputFileOn(bool bValue)
 {
+	this->WaitRun();
 	this->OutputFileOn = bValue;
 }
 
 void IPhreeqc::SetSelectedOutputFileName(const char *filename)
 {
+	this->WaitRun();
 	if (filename && ::strlen(filename))
 	{
 		// Can't use this->PhreeqcPtr->SelectedOutput_map since it's necessary
@@ -1041,6 +1454,7 @@ void IPhreeqc::SetSelectedOutputFileName(const char *filename)
 
 void IPhreeqc::SetSelectedOutputFileOn(bool bValue)
 {
+	this->WaitRun();
 	if (0 <= this->CurrentSelectedOutputUserNumber)
 	{
 		this->SelectedOutputFileOnMap[this->CurrentSelectedOutputUserNumber] = bValue;
@@ -1049,9 +1463,43 @@ void IPhreeqc::SetSelectedOutputFileOn(bool bValue)
 
 void IPhreeqc::SetSelectedOutputStringOn(bool bValue)
 {
+	this->WaitRun();
 	this->SelectedOutputStringOn[this->CurrentSelectedOutputUserNumber] = bValue;
 }
 
+int IPhreeqc::WaitRun(void)
+{
+	if (this->Async == 0)
+	{
+		return 0;
+	}
+	// the run itself and its callback do not wait for themselves
+	if (!this->Async->on_thread())
+	{
+		this->Async->join();
+	}
+	return this->Async->Errors;
+}
+
+VRESULT IPhreeqc::run_async(const char* input, bool is_file, PFN_RUN_COMPLETE_CALLBACK pfn, void* cookie)
+{
+	if (!input || (this->Async && this->Async->on_thread()))
+	{
+		return VR_INVALIDARG;
+	}
+	this->WaitRun();
+	delete this->Async;
+
+	this->Async = new IPhreeqcAsync(this, input, is_file, pfn, cookie);
+	if (!this->Async->start())
+	{
+		delete this->Async;
+		this->Async = 0;
+		return VR_OUTOFMEMORY;
+	}
+	return VR_OK;
+}
+
 int IPhreeqc::test_db(void)
 {
 	std::ostringstream oss;
@@ -1117,6 +1565,10 @@ void IPhreeqc::UnLoadDatabase(void)
 	this->DumpString.clear();
 	this->DumpLines.clear();
 
+	// saved states refer to the previous database
+	//
+	this->DeleteSavedStates();
+
 	// initialize phreeqc
 	//
 	this->PhreeqcPtr->clean_up();
@@ -1126,6 +1578,16 @@ void IPhreeqc::UnLoadDatabase(void)
 	this->io_error_count = 0;
 }
 
+void IPhreeqc::DeleteSavedStates(void)
+{
+	std::map< int, IPhreeqcState* >::iterator it = this->SavedStates.begin();
+	for (; it != this->SavedStates.end(); ++it)
+	{
+		delete (*it).second;
+	}
+	this->SavedStates.clear();
+}
+
 int IPhreeqc::EndRow(void)
 {
 	if (this->PhreeqcPtr->current_selected_output)
@@ -1187,6 +1649,8 @@ void IPhreeqc::do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALL
  *   Maybe should be in read_input
  */
 	this->PhreeqcPtr->first_read_input = TRUE;
+	this->PhreeqcPtr->phase_counters.Reset();
+	this->PhreeqcPtr->run_stats = run_statistics();
 
 /*
  *   call pre-run callback
@@ -5,6 +5,8 @@
 #define INC_IPHREEQC_H
 
 #include "Var.h"
+#include "RunStatistics.h"
+#include "IPhreeqcCallbacks.h"
 
 #ifdef IPHREEQC_NO_FORTRAN_MODULE
 #include <stddef.h>
@@ -188,6 +190,90 @@ extern "C" {
 	IPQ_DLL_EXPORT IPQ_RESULT  DestroyIPhreeqc(int id);
 
 
+/**
+ *  Releases a state saved by @ref SaveState.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param state         The handle returned from @ref SaveState.
+ *  @retval IPQ_OK           Success.
+ *  @retval IPQ_BADINSTANCE  The given id is invalid.
+ *  @retval IPQ_INVALIDARG   The given state is unknown or has already been deleted.
+ *  @see                 RestoreState, SaveState
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION DeleteState(ID,STATE)
+ *    INTEGER(KIND=4),  INTENT(IN)  :: ID
+ *    INTEGER(KIND=4),  INTENT(IN)  :: STATE
+ *    INTEGER(KIND=4)               :: DeleteState
+ *  END FUNCTION DeleteState
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  DeleteState(int id, int state);
+
+
+/**
+ *  Retrieves the solve-cost counters of a cell from the most recent <b>TRANSPORT</b> or <b>ADVECTION</b> calculation.
+ *  Counters accumulate over all shifts of the calculation and are cleared when the next <b>TRANSPORT</b> or <b>ADVECTION</b> starts.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param cell          The cell number (0 to @ref GetCellCostCount - 1); stagnant cells follow the mobile cells as in <b>TRANSPORT</b>.
+ *  @param iterations    Receives the number of Newton iterations, summed over all attempts.
+ *  @param retries       Receives the number of failed attempts that were retried with other convergence parameters.
+ *  @param solves        Receives the number of equilibrium calculations.
+ *  @param kinetic_steps Receives the number of CVODE or Runge-Kutta integration steps.
+ *  @param seconds       Receives the elapsed time, in seconds, spent on the cell's chemistry.
+ *  @retval IPQ_OK          Success.
+ *  @retval IPQ_INVALIDARG  The given cell is out of range.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @see                 GetCellCostCount
+ *  @remarks
+ *  Any of the output pointers may be NULL.
+ *  The same counters can be written to the selected-output file with the <b>SELECTED_OUTPUT</b> identifier <b>-cell_cost</b>.
+ *  @par Fortran90 Interface:
+ *  (Note: CELL is the cell number, not a one-based index)
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION GetCellCost(ID,CELL,ITERATIONS,RETRIES,SOLVES,KINETIC_STEPS,SECONDS)
+ *    INTEGER(KIND=4),   INTENT(IN)   :: ID
+ *    INTEGER(KIND=4),   INTENT(IN)   :: CELL
+ *    INTEGER(KIND=4),   INTENT(OUT)  :: ITERATIONS
+ *    INTEGER(KIND=4),   INTENT(OUT)  :: RETRIES
+ *    INTEGER(KIND=4),   INTENT(OUT)  :: SOLVES
+ *    INTEGER(KIND=4),   INTENT(OUT)  :: KINETIC_STEPS
+ *    REAL(KIND=8),      INTENT(OUT)  :: SECONDS
+ *    INTEGER(KIND=4)                 :: GetCellCost
+ *  END FUNCTION GetCellCost
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetCellCost(int id, int cell, int* iterations, int* retries, int* solves, int* kinetic_steps, double* seconds);
+
+
+/**
+ *  Retrieves the number of cells with solve-cost counters from the most recent <b>TRANSPORT</b> or <b>ADVECTION</b> calculation.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @return              The number of cells; 0 if neither <b>TRANSPORT</b> nor <b>ADVECTION</b> has been run.
+ *                       A negative value indicates an error occured (see @ref IPQ_RESULT).
+ *  @see                 GetCellCost
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION GetCellCostCount(ID)
+ *    INTEGER(KIND=4),  INTENT(IN)  :: ID
+ *    INTEGER(KIND=4)               :: GetCellCostCount
+ *  END FUNCTION GetCellCostCount
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT int         GetCellCostCount(int id);
+
+
 /**
  *  Retrieves the given component.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -268,6 +354,16 @@ extern "C" {
  */
 	IPQ_DLL_EXPORT int         GetCurrentSelectedOutputUserNumber(int id);
 
+/**
+ *  Retrieves the hash of the text of the loaded database.  The same hash is written to the header of
+ *  slow-cell captures (<B>KNOBS</B> -capture_file), so a replay can check that it uses the same database.
+ *  @param id               The instance id returned from @ref CreateIPhreeqc.
+ *  @return                 The hash as eight hexadecimal digits, or an empty string if no database has been loaded
+ *                          or the id is invalid.
+ *  @see                    LoadDatabase, LoadDatabaseString
+ */
+	IPQ_DLL_EXPORT const char* GetDatabaseHash(int id);
+
 /**
  *  Retrieves the name of the dump file.  This file name is used if not specified within <B>DUMP</B> input.
  *  The default value is <B><I>dump.id.out</I></B>.
@@ -818,6 +914,91 @@ extern "C" {
 	IPQ_DLL_EXPORT int         GetOutputStringOn(int id);
 
 
+/**
+ *  Retrieves the counters of a solver phase from the most recent call to @ref RunAccumulated, @ref RunFile or @ref RunString.
+ *  Counters are only collected while the <b>KNOBS</b> identifier <b>-phase_counters</b> is true.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param phase         The solver phase:
+ *                       0 prep, 1 model, 2 k_temp, 3 activity coefficients (gammas), 4 BASIC programs.
+ *  @param calls         Receives the number of times the phase was entered.
+ *  @param seconds       Receives the elapsed time, in seconds, spent in the phase.
+ *  @param cycles        Receives the number of cpu cycles.
+ *  @param instructions  Receives the number of instructions retired.
+ *  @param cache_misses  Receives the number of last-level cache misses.
+ *  @param branch_misses Receives the number of mispredicted branches.
+ *  @retval IPQ_OK          Success.
+ *  @retval IPQ_INVALIDARG  The given phase is out of range.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @remarks
+ *  Any of the output pointers may be NULL.
+ *  Counts are inclusive; for example, model includes the time spent in gammas and k_temp.
+ *  Hardware counts are read with perf_event_open and are only available on Linux when permitted
+ *  by /proc/sys/kernel/perf_event_paranoid; otherwise they are returned as -1.
+ *  @par Fortran90 Interface:
+ *  (Note: PHASE is zero-based)
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION GetPhaseCounters(ID,PHASE,CALLS,SECONDS,CYCLES,INSTRUCTIONS,CACHE_MISSES,BRANCH_MISSES)
+ *    INTEGER(KIND=4),   INTENT(IN)   :: ID
+ *    INTEGER(KIND=4),   INTENT(IN)   :: PHASE
+ *    INTEGER(KIND=4),   INTENT(OUT)  :: CALLS
+ *    REAL(KIND=8),      INTENT(OUT)  :: SECONDS
+ *    REAL(KIND=8),      INTENT(OUT)  :: CYCLES
+ *    REAL(KIND=8),      INTENT(OUT)  :: INSTRUCTIONS
+ *    REAL(KIND=8),      INTENT(OUT)  :: CACHE_MISSES
+ *    REAL(KIND=8),      INTENT(OUT)  :: BRANCH_MISSES
+ *    INTEGER(KIND=4)                 :: GetPhaseCounters
+ *  END FUNCTION GetPhaseCounters
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetPhaseCounters(int id, int phase, int* calls, double* seconds, double* cycles, double* instructions, double* cache_misses, double* branch_misses);
+
+
+/**
+ *  Retrieves the solver statistics of the most recent call to @ref RunAccumulated, @ref RunFile or @ref RunString.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param stats         Receives the statistics; see @ref RUN_STATISTICS for the fields.
+ *  @retval IPQ_OK          Success.
+ *  @retval IPQ_INVALIDARG  stats is NULL.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @remarks
+ *  The statistics are always collected; they are plain counters incremented by the solver.
+ *  Counts include the calculations made while reading the input, such as initial solutions.
+ *  @par Fortran90 Interface:
+ *  (Note: the ATTEMPTS and CALCULATIONS arrays are zero-based; RS_ATTEMPT_COUNT and RS_CALCULATION_COUNT are
+ *  defined in RunStatistics.h)
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  TYPE, BIND(C) :: RUN_STATISTICS
+ *    INTEGER(KIND=C_INT) :: ITERATIONS
+ *    INTEGER(KIND=C_INT) :: JACOBIANS
+ *    INTEGER(KIND=C_INT) :: ATTEMPTS(0:RS_ATTEMPT_COUNT-1)
+ *    INTEGER(KIND=C_INT) :: FAILURES
+ *    INTEGER(KIND=C_INT) :: CALCULATIONS(0:RS_CALCULATION_COUNT-1)
+ *    INTEGER(KIND=C_INT) :: CVODE_STEPS
+ *    INTEGER(KIND=C_INT) :: RK_STEPS
+ *    INTEGER(KIND=C_INT) :: RK_REJECTED
+ *    INTEGER(KIND=C_INT) :: LINE_SEARCHES
+ *    INTEGER(KIND=C_INT) :: G_SWEEPS
+ *    INTEGER(KIND=C_INT) :: DONNAN_SWEEPS
+ *  END TYPE RUN_STATISTICS
+ *
+ *  FUNCTION GetRunStatistics(ID,STATS)
+ *    INTEGER(KIND=4),       INTENT(IN)   :: ID
+ *    TYPE(RUN_STATISTICS),  INTENT(OUT)  :: STATS
+ *    INTEGER(KIND=4)                     :: GetRunStatistics
+ *  END FUNCTION GetRunStatistics
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetRunStatistics(int id, RUN_STATISTICS* stats);
+
+
 /**
  *  Retrieves the number of columns in the selected-output buffer.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1439,6 +1620,28 @@ Headings
 	IPQ_DLL_EXPORT int         GetWarningStringLineCount(int id);
 
 
+/**
+ *  Checks whether the run started by @ref RunFileAsync or @ref RunStringAsync has completed.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @retval 1            The run, including its completion callback, has finished, or no run was started.
+ *  @retval 0            The run is in progress.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @see                 RunFileAsync, RunStringAsync, WaitRun
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION IsRunComplete(ID)
+ *    INTEGER(KIND=4),  INTENT(IN)  :: ID
+ *    LOGICAL(KIND=4)               :: IsRunComplete
+ *  END FUNCTION IsRunComplete
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT int         IsRunComplete(int id);
+
+
 /**
  *  Load the specified database file into phreeqc.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1495,6 +1698,48 @@ Headings
 	IPQ_DLL_EXPORT int         LoadDatabaseString(int id, const char* input);
 
 
+/**
+ *  Sets new totals for an existing solution without going through <B>SOLUTION_MODIFY</B> input,
+ *  for example to return the results of a transport step to a cell before <B>RUN_CELLS</B>.
+ *  The stored master-species activities are kept and shifted by the change in each element
+ *  total, so the next calculation of the solution starts from the previous result.
+ *  Elements and redox states that are not listed keep their totals, and the mass of water
+ *  of the solution is not changed.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param n             The user number of the solution.
+ *  @param total_h       Total moles of hydrogen.
+ *  @param total_o       Total moles of oxygen.
+ *  @param cb            Charge balance, in equivalents.
+ *  @param count         The number of entries in elements and moles.
+ *  @param elements      Names of the elements or redox states, for example "Ca" or "C(4)".
+ *  @param moles         Total moles of each entry of elements.
+ *  @retval IPQ_OK           Success.
+ *  @retval IPQ_BADINSTANCE  The given id is invalid.
+ *  @retval IPQ_INVALIDARG   The solution is not defined, count is negative, elements or moles is NULL
+ *                           while count is positive, or a name is not an element of the database.
+ *  @see                 RunString
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION ModifySolutionTotals(ID,N,TOTAL_H,TOTAL_O,CB,COUNT,ELEMENTS,MOLES)
+ *    INTEGER(KIND=4),   INTENT(IN)  :: ID
+ *    INTEGER(KIND=4),   INTENT(IN)  :: N
+ *    REAL(KIND=8),      INTENT(IN)  :: TOTAL_H
+ *    REAL(KIND=8),      INTENT(IN)  :: TOTAL_O
+ *    REAL(KIND=8),      INTENT(IN)  :: CB
+ *    INTEGER(KIND=4),   INTENT(IN)  :: COUNT
+ *    CHARACTER(LEN=*),  INTENT(IN)  :: ELEMENTS(COUNT)
+ *    REAL(KIND=8),      INTENT(IN)  :: MOLES(COUNT)
+ *    INTEGER(KIND=4)                :: ModifySolutionTotals
+ *  END FUNCTION ModifySolutionTotals
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  ModifySolutionTotals(int id, int n, double total_h, double total_o, double cb, int count, const char** elements, const double* moles);
+
+
 /**
  *  Output the accumulated input buffer to stdout.  This input buffer can be run with a call to @ref RunAccumulated.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1584,6 +1829,36 @@ Headings
 	IPQ_DLL_EXPORT int         RunAccumulated(int id);
 
 
+/**
+ *  Replaces the reactants of the instance with those captured by @ref SaveState.
+ *  Every solution, exchange, gas phase, kinetics, equilibrium-phase, solid-solution
+ *  and surface definition, every <B>MIX</B>, <B>REACTION</B>, <B>REACTION_TEMPERATURE</B>
+ *  and <B>REACTION_PRESSURE</B> definition, and the values stored with the Basic PUT
+ *  statement are returned to their saved contents; entities defined after the save are removed.
+ *  The saved state is unchanged and can be restored again.
+ *  <B>SELECTED_OUTPUT</B> and <B>USER_PUNCH</B> definitions are not part of the saved state.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param state         The handle returned from @ref SaveState.
+ *  @retval IPQ_OK           Success.
+ *  @retval IPQ_BADINSTANCE  The given id is invalid.
+ *  @retval IPQ_INVALIDARG   The given state is unknown or has already been deleted.
+ *  @see                 DeleteState, SaveState
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION RestoreState(ID,STATE)
+ *    INTEGER(KIND=4),  INTENT(IN)  :: ID
+ *    INTEGER(KIND=4),  INTENT(IN)  :: STATE
+ *    INTEGER(KIND=4)               :: RestoreState
+ *  END FUNCTION RestoreState
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  RestoreState(int id, int state);
+
+
 /**
  *  Runs the specified phreeqc input file.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1613,6 +1888,42 @@ Headings
 	IPQ_DLL_EXPORT int         RunFile(int id, const char* filename);
 
 
+/**
+ *  Starts running the specified phreeqc input file on an internal thread and returns at once.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param filename      The name of the phreeqc input file to run.
+ *  @param pfn           Optional function called on the internal thread with the number of errors
+ *                       and cookie when the run has finished; may be NULL.
+ *  @param cookie        A user defined value to be passed to pfn.
+ *  @retval IPQ_OK           The run was started.
+ *  @retval IPQ_BADINSTANCE  The given id is invalid.
+ *  @retval IPQ_INVALIDARG   filename is NULL, or the call was made from pfn.
+ *  @retval IPQ_OUTOFMEMORY  The thread could not be started.
+ *  @see                 IsRunComplete, RunFile, WaitRun
+ *  @remarks
+ *      A previous asynchronous run is waited for first.  Until the run has completed, functions that
+ *      modify the instance (loading a database, running input, accumulating lines, changing settings
+ *      and saved states) wait for it, while the functions that retrieve output and results must not be
+ *      called before @ref IsRunComplete returns 1 or @ref WaitRun returns.  pfn may retrieve the
+ *      results of the run, and may call @ref DestroyIPhreeqc as its last use of the instance.
+ *  @pre                 (@ref LoadDatabase, @ref LoadDatabaseString) must have been called and returned 0 (zero) errors.
+ *  @par Fortran90 Interface:
+ *  The Fortran interface does not take a completion callback.
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION RunFileAsync(ID,FILENAME)
+ *    INTEGER(KIND=4),   INTENT(IN)  :: ID
+ *    CHARACTER(LEN=*),  INTENT(IN)  :: FILENAME
+ *    INTEGER(KIND=4)                :: RunFileAsync
+ *  END FUNCTION RunFileAsync
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  RunFileAsync(int id, const char* filename, PFN_RUN_COMPLETE_CALLBACK pfn, void *cookie);
+
+
 /**
  *  Runs the specified string as input to phreeqc.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1639,6 +1950,66 @@ Headings
  */
 	IPQ_DLL_EXPORT int         RunString(int id, const char* input);
 
+
+/**
+ *  Starts running the specified string as input to phreeqc on an internal thread and returns at once.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param input         String containing phreeqc input.
+ *  @param pfn           Optional function called on the internal thread with the number of errors
+ *                       and cookie when the run has finished; may be NULL.
+ *  @param cookie        A user defined value to be passed to pfn.
+ *  @retval IPQ_OK           The run was started.
+ *  @retval IPQ_BADINSTANCE  The given id is invalid.
+ *  @retval IPQ_INVALIDARG   input is NULL, or the call was made from pfn.
+ *  @retval IPQ_OUTOFMEMORY  The thread could not be started.
+ *  @see                 IsRunComplete, RunString, WaitRun
+ *  @remarks
+ *      A previous asynchronous run is waited for first.  Until the run has completed, functions that
+ *      modify the instance (loading a database, running input, accumulating lines, changing settings
+ *      and saved states) wait for it, while the functions that retrieve output and results must not be
+ *      called before @ref IsRunComplete returns 1 or @ref WaitRun returns.  pfn may retrieve the
+ *      results of the run, and may call @ref DestroyIPhreeqc as its last use of the instance.
+ *  @pre                 (@ref LoadDatabase, @ref LoadDatabaseString) must have been called and returned 0 (zero) errors.
+ *  @par Fortran90 Interface:
+ *  The Fortran interface does not take a completion callback.
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION RunStringAsync(ID,INPUT)
+ *    INTEGER(KIND=4),   INTENT(IN)  :: ID
+ *    CHARACTER(LEN=*),  INTENT(IN)  :: INPUT
+ *    INTEGER(KIND=4)                :: RunStringAsync
+ *  END FUNCTION RunStringAsync
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  RunStringAsync(int id, const char* input, PFN_RUN_COMPLETE_CALLBACK pfn, void *cookie);
+
+
+/**
+ *  Saves a copy of the reactants of the instance so that a later calculation
+ *  can be undone with @ref RestoreState, for example to run several what-if
+ *  calculations from the same starting point.  Saved states are released by
+ *  @ref DeleteState and when a database is loaded.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @return              A handle (0 or greater) identifying the saved state, or IPQ_BADINSTANCE if the given id is invalid.
+ *  @see                 DeleteState, RestoreState
+ *  @pre                 (@ref LoadDatabase, @ref LoadDatabaseString) must have been called and returned 0 (zero) errors.
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION SaveState(ID)
+ *    INTEGER(KIND=4),  INTENT(IN)  :: ID
+ *    INTEGER(KIND=4)               :: SaveState
+ *  END FUNCTION SaveState
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT int         SaveState(int id);
+
 /**
  *  Sets a C callback function for Basic programs. The syntax for the Basic command is
  *  10 result = CALLBACK(x1, x2, string$)
@@ -2169,6 +2540,27 @@ Headings
  */
 	IPQ_DLL_EXPORT IPQ_RESULT  SetSelectedOutputStringOn(int id, int sel_string_on);
 
+
+/**
+ *  Waits until the run started by @ref RunFileAsync or @ref RunStringAsync, including its completion callback, has finished.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @return              The number of errors encountered during the run; 0 (zero) if no run was started.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @see                 IsRunComplete, RunFileAsync, RunStringAsync
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION WaitRun(ID)
+ *    INTEGER(KIND=4),  INTENT(IN)  :: ID
+ *    INTEGER(KIND=4)               :: WaitRun
+ *  END FUNCTION WaitRun
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT int         WaitRun(int id);
+
 // TODO int RunWithCallback(PFN_PRERUN_CALLBACK pfn_pre, PFN_POSTRUN_CALLBACK pfn_post, void *cookie, int output_on, int error_on, int log_on, int selected_output_on);
 
 
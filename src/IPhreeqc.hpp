@@ -10,7 +10,8 @@
 #include <vector>
 #include <map>
 #include <cstdarg>
-#include "IPhreeqcCallbacks.h"      /* PFN_PRERUN_CALLBACK, PFN_POSTRUN_CALLBACK, PFN_CATCH_CALLBACK */
+#include "IPhreeqcCallbacks.h"      /* PFN_PRERUN_CALLBACK, PFN_POSTRUN_CALLBACK, PFN_CATCH_CALLBACK, PFN_RUN_COMPLETE_CALLBACK */
+#include "RunStatistics.h"          /* RUN_STATISTICS */
 #include "Var.h"                    /* VRESULT */
 #include "PHRQ_io.h"
 
@@ -20,6 +21,8 @@ class Phreeqc;
 class IErrorReporter;
 class CSelectedOutput;
 class SelectedOutput;
+class IPhreeqcState;
+class IPhreeqcAsync;
 
 /**
  * @class IPhreeqcStop
@@ -92,6 +95,15 @@ public:
 	 */
 	void                     ClearAccumulatedLines(void);
 
+	/**
+	 *  Releases a state saved by @ref SaveState.
+	 *  @param n                The handle returned from @ref SaveState.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   The given handle is unknown or has already been deleted.
+	 *  @see                    RestoreState, SaveState
+	 */
+	VRESULT                  DeleteState(int n);
+
 	/**
 	 *  Retrieve the accumulated input string.  The accumulated input string can be run
 	 *  with @ref RunAccumulated.
@@ -100,6 +112,31 @@ public:
 	 */
 	const std::string&       GetAccumulatedLines(void);
 
+	/**
+	 *  Retrieves the solve-cost counters of a cell from the most recent <B>TRANSPORT</B> or <B>ADVECTION</B> calculation.
+	 *  Counters accumulate over all shifts of the calculation and are cleared when the next <B>TRANSPORT</B> or <B>ADVECTION</B> starts.
+	 *  @param cell             The cell number (0 to @ref GetCellCostCount - 1); stagnant cells follow the mobile cells as in <B>TRANSPORT</B>.
+	 *  @param iterations       Receives the number of Newton iterations, summed over all attempts.
+	 *  @param retries          Receives the number of failed attempts that were retried with other convergence parameters.
+	 *  @param solves           Receives the number of equilibrium calculations.
+	 *  @param kinetic_steps    Receives the number of CVODE or Runge-Kutta integration steps.
+	 *  @param seconds          Receives the elapsed time, in seconds, spent on the cell's chemistry.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   The given cell is out of range.
+	 *  @see                    GetCellCostCount
+	 *  @remarks
+	 *  Any of the output pointers may be NULL.
+	 *  The same counters can be written to the selected-output file with the <B>SELECTED_OUTPUT</B> identifier <B>-cell_cost</B>.
+	 */
+	VRESULT                  GetCellCost(int cell, int* iterations, int* retries, int* solves, int* kinetic_steps, double* seconds)const;
+
+	/**
+	 *  Retrieves the number of cells with solve-cost counters from the most recent <B>TRANSPORT</B> or <B>ADVECTION</B> calculation.
+	 *  @return                 The number of cells; 0 if neither <B>TRANSPORT</B> nor <B>ADVECTION</B> has been run.
+	 *  @see                    GetCellCost
+	 */
+	int                      GetCellCostCount(void)const;
+
 	/**
 	 *  Retrieves the given component.
 	 *  @param n                The zero-based index of the component to retrieve.
@@ -123,6 +160,14 @@ public:
 	 */
 	int                      GetCurrentSelectedOutputUserNumber(void)const;
 
+	/**
+	 *  Retrieves the hash of the text of the loaded database.  The same hash is written to the header of
+	 *  slow-cell captures (<B>KNOBS</B> -capture_file), so a replay can check that it uses the same database.
+	 *  @return                 The hash as eight hexadecimal digits, or an empty string if no database has been loaded.
+	 *  @see                    LoadDatabase, LoadDatabaseString
+	 */
+	const char*              GetDatabaseHash(void)const;
+
 	/**
 	 *  Retrieves the name of the dump file.  This file name is used if not specified within <B>DUMP</B> input.
 	 *  The default value is <B><I>dump.id.out</I></B>, where id is obtained from @ref GetId.
@@ -344,6 +389,38 @@ public:
 	 */
 	bool                     GetOutputStringOn(void)const;
 
+	/**
+	 *  Retrieves the counters of a solver phase from the most recent call to @ref RunAccumulated, @ref RunFile or @ref RunString.
+	 *  Counters are only collected while the <B>KNOBS</B> identifier <B>-phase_counters</B> is true.
+	 *  @param phase            The solver phase:
+	 *                          0 prep, 1 model, 2 k_temp, 3 activity coefficients (gammas), 4 BASIC programs.
+	 *  @param calls            Receives the number of times the phase was entered.
+	 *  @param seconds          Receives the elapsed time, in seconds, spent in the phase.
+	 *  @param cycles           Receives the number of cpu cycles.
+	 *  @param instructions     Receives the number of instructions retired.
+	 *  @param cache_misses     Receives the number of last-level cache misses.
+	 *  @param branch_misses    Receives the number of mispredicted branches.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   The given phase is out of range.
+	 *  @remarks
+	 *  Any of the output pointers may be NULL.
+	 *  Counts are inclusive; for example, model includes the time spent in gammas and k_temp.
+	 *  Hardware counts are read with perf_event_open and are only available on Linux when permitted
+	 *  by /proc/sys/kernel/perf_event_paranoid; otherwise they are returned as -1.
+	 */
+	VRESULT                  GetPhaseCounters(int phase, int* calls, double* seconds, double* cycles, double* instructions, double* cache_misses, double* branch_misses)const;
+
+	/**
+	 *  Retrieves the solver statistics of the most recent call to @ref RunAccumulated, @ref RunFile or @ref RunString.
+	 *  @param stats            Receives the statistics; see @ref RUN_STATISTICS for the fields.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   stats is NULL.
+	 *  @remarks
+	 *  The statistics are always collected; they are plain counters incremented by the solver.
+	 *  Counts include the calculations made while reading the input, such as initial solutions.
+	 */
+	VRESULT                  GetRunStatistics(RUN_STATISTICS* stats)const;
+
 	/**
 	 *  Retrieves the number of columns in the current selected-output buffer (see @ref SetCurrentSelectedOutputUserNumber).
 	 *  @return                 The number of columns.
@@ -626,6 +703,14 @@ public:
 	 */
 	std::list< std::string > ListComponents(void);
 
+	/**
+	 *  Checks whether the run started by @ref RunFileAsync or @ref RunStringAsync has completed.
+	 *  @retval true            The run, including its completion callback, has finished, or no run was started.
+	 *  @retval false           The run is in progress.
+	 *  @see                    RunFileAsync, RunStringAsync, WaitRun
+	 */
+	bool                     IsRunComplete(void)const;
+
 	/**
 	 *  Load the specified database file into phreeqc.
 	 *  @param filename         The name of the phreeqc database to load.
@@ -648,6 +733,30 @@ public:
 	 */
 	int                      LoadDatabaseString(const char* input);
 
+	/**
+	 *  Sets new totals for an existing solution without going through <B>SOLUTION_MODIFY</B> input,
+	 *  for example to return the results of a transport step to a cell before <B>RUN_CELLS</B>.
+	 *  The stored master-species activities are kept and shifted by the change in each element
+	 *  total, so the next calculation of the solution starts from the previous result.
+	 *  @param n                The user number of the solution.
+	 *  @param total_h          Total moles of hydrogen.
+	 *  @param total_o          Total moles of oxygen.
+	 *  @param cb               Charge balance, in equivalents.
+	 *  @param count            The number of entries in elements and moles.
+	 *  @param elements         Names of the elements or redox states, for example "Ca" or "C(4)".
+	 *  @param moles            Total moles of each entry of elements.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   The solution is not defined, count is negative, elements or moles is NULL
+	 *                          while count is positive, or a name is not an element of the database.
+	 *  @see                    RunString
+	 *  @remarks
+	 *      Elements and redox states that are not listed keep their totals, as with the -totals
+	 *      identifier of <B>SOLUTION_MODIFY</B>.  The mass of water of the solution is not changed.
+	 *  @pre
+	 *      @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+	 */
+	VRESULT                  ModifySolutionTotals(int n, double total_h, double total_o, double cb, int count, const char* const* elements, const double* moles);
+
 	/**
 	 *  Output the accumulated input buffer to stdout.  The input buffer can be run with a call to @ref RunAccumulated.
 	 *  @see                    AccumulateLine, ClearAccumulatedLines, RunAccumulated
@@ -678,6 +787,23 @@ public:
 	 */
 	int                      RunAccumulated(void);
 
+	/**
+	 *  Replaces the reactants of this instance with those captured by @ref SaveState.
+	 *  Every solution, exchange, gas phase, kinetics, equilibrium-phase, solid-solution
+	 *  and surface definition, every <B>MIX</B>, <B>REACTION</B>, <B>REACTION_TEMPERATURE</B>
+	 *  and <B>REACTION_PRESSURE</B> definition, and the values stored with the Basic PUT
+	 *  statement are returned to their saved contents; entities defined after the save are removed.
+	 *  The saved state is unchanged and can be restored again.
+	 *  @param n                The handle returned from @ref SaveState.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   The given handle is unknown or has already been deleted.
+	 *  @see                    DeleteState, SaveState
+	 *  @remarks
+	 *      <B>SELECTED_OUTPUT</B> and <B>USER_PUNCH</B> definitions and the selected-output buffers
+	 *      are not part of the saved state.
+	 */
+	VRESULT                  RestoreState(int n);
+
 	/**
 	 *  Runs the specified phreeqc input file.
 	 *  @param filename         The name of the phreeqc input file to run.
@@ -688,6 +814,27 @@ public:
 	 */
 	int                      RunFile(const char* filename);
 
+	/**
+	 *  Starts running the specified phreeqc input file on an internal thread and returns at once.
+	 *  @param filename         The name of the phreeqc input file to run.
+	 *  @param pfn              Optional function called on the internal thread with the number of errors
+	 *                          and cookie when the run has finished; may be NULL.
+	 *  @param cookie           A user defined value to be passed to pfn.
+	 *  @retval VR_OK           The run was started.
+	 *  @retval VR_INVALIDARG   filename is NULL, or the call was made from pfn.
+	 *  @retval VR_OUTOFMEMORY  The thread could not be started.
+	 *  @see                    IsRunComplete, RunFile, WaitRun
+	 *  @remarks
+	 *      A previous asynchronous run is waited for first.  Until the run has completed, methods that
+	 *      modify the instance (loading a database, running input, accumulating lines, changing settings
+	 *      and saved states) wait for it, while the methods that retrieve output and results must not be
+	 *      called before @ref IsRunComplete returns true or @ref WaitRun returns.  pfn may retrieve the
+	 *      results of the run, and may delete the instance as its last use of it.
+	 *  @pre
+	 *      @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+	 */
+	VRESULT                  RunFileAsync(const char* filename, PFN_RUN_COMPLETE_CALLBACK pfn = 0, void* cookie = 0);
+
 	/**
 	 *  Runs the specified string as input to phreeqc.
 	 *  @param input            String containing phreeqc input.
@@ -698,6 +845,40 @@ public:
 	 */
 	int                      RunString(const char* input);
 
+	/**
+	 *  Starts running the specified string as input to phreeqc on an internal thread and returns at once.
+	 *  @param input            String containing phreeqc input.
+	 *  @param pfn              Optional function called on the internal thread with the number of errors
+	 *                          and cookie when the run has finished; may be NULL.
+	 *  @param cookie           A user defined value to be passed to pfn.
+	 *  @retval VR_OK           The run was started.
+	 *  @retval VR_INVALIDARG   input is NULL, or the call was made from pfn.
+	 *  @retval VR_OUTOFMEMORY  The thread could not be started.
+	 *  @see                    IsRunComplete, RunString, WaitRun
+	 *  @remarks
+	 *      A previous asynchronous run is waited for first.  Until the run has completed, methods that
+	 *      modify the instance (loading a database, running input, accumulating lines, changing settings
+	 *      and saved states) wait for it, while the methods that retrieve output and results must not be
+	 *      called before @ref IsRunComplete returns true or @ref WaitRun returns.  pfn may retrieve the
+	 *      results of the run, and may delete the instance as its last use of it.
+	 *  @pre
+	 *      @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+	 */
+	VRESULT                  RunStringAsync(const char* input, PFN_RUN_COMPLETE_CALLBACK pfn = 0, void* cookie = 0);
+
+	/**
+	 *  Saves a copy of the reactants of this instance so that a later calculation
+	 *  can be undone with @ref RestoreState, for example to run several what-if
+	 *  calculations from the same starting point.
+	 *  @return                 A handle (0 or greater) identifying the saved state.
+	 *  @see                    DeleteState, RestoreState
+	 *  @remarks
+	 *      Saved states are released by @ref DeleteState and when a database is loaded.
+	 *  @pre
+	 *      @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+	 */
+	int                      SaveState(void);
+
 	/**
 	 *  Sets a C callback function for Basic programs. The syntax for the Basic command is
 	 *  10 result = CALLBACK(x1, x2, string$)
@@ -871,6 +1052,13 @@ public:
 	 */
 	void                     SetSelectedOutputStringOn(bool bValue);
 
+	/**
+	 *  Waits until the run started by @ref RunFileAsync or @ref RunStringAsync, including its completion callback, has finished.
+	 *  @return                 The number of errors encountered during the run; 0 (zero) if no run was started.
+	 *  @see                    IsRunComplete, RunFileAsync, RunStringAsync
+	 */
+	int                      WaitRun(void);
+
 public:
 	// overrides
 	virtual void error_msg(const char *str, bool stop=false);
@@ -892,12 +1080,15 @@ protected:
 	int EndRow(void);
 	void AddSelectedOutput(const char* name, const char* format, va_list argptr);
 	void UnLoadDatabase(void);
+	void DeleteSavedStates(void);
 
 	void check_database(const char* sz_routine);
 	int close_input_files(void);
 	int close_output_files(void);
 	void open_output_files(const char* sz_routine);
 
+	VRESULT run_async(const char* input, bool is_file, PFN_RUN_COMPLETE_CALLBACK pfn, void* cookie);
+
 	void do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALLBACK pfn_pre, PFN_POSTRUN_CALLBACK pfn_post, void *cookie);
 
 	void update_errors(void);
@@ -990,12 +1181,19 @@ protected:
 	std::map< int, std::string >                  SelectedOutputStringMap;
 	std::map< int, std::vector< std::string > >   SelectedOutputLinesMap;
 
+	std::map< int, IPhreeqcState* >               SavedStates;
+	int                                           SavedStatesIndex;
+
+	IPhreeqcAsync                                *Async;
+
 protected:
 	Phreeqc* PhreeqcPtr;
 	FILE *input_file;
 	FILE *database_file;
 
 	friend class IPhreeqcLib;
+	friend class IPhreeqcPool;
+	friend class IPhreeqcAsync;
 	static std::map<size_t, IPhreeqc*> Instances;
 	static size_t InstancesIndex;
 	size_t Index;
@@ -10,6 +10,8 @@ extern "C" {
 typedef int (*PFN_PRERUN_CALLBACK)(void *cookie);
 typedef int (*PFN_POSTRUN_CALLBACK)(void *cookie);
 typedef int (*PFN_CATCH_CALLBACK)(void *cookie);
+/* called on the thread of an asynchronous run; may destroy the instance as its last use of it */
+typedef void (*PFN_RUN_COMPLETE_CALLBACK)(int errors, void *cookie);
 
 
 #if defined(__cplusplus)
@@ -80,8 +80,53 @@ DestroyIPhreeqc(int id)
 	return IPhreeqcLib::DestroyIPhreeqc(id);
 }
 
+IPQ_RESULT
+DeleteState(int id, int state)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->DeleteState(state))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 // TODO Maybe GetAccumulatedLines
 
+IPQ_RESULT
+GetCellCost(int id, int cell, int* iterations, int* retries, int* solves, int* kinetic_steps, double* seconds)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->GetCellCost(cell, iterations, retries, solves, kinetic_steps, seconds))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
+int
+GetCellCostCount(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->GetCellCostCount();
+	}
+	return IPQ_BADINSTANCE;
+}
+
 const char*
 GetComponent(int id, int n)
 {
@@ -123,6 +168,18 @@ GetCurrentSelectedOutputUserNumber(int id)
 	return IPQ_BADINSTANCE;
 }
 
+const char*
+GetDatabaseHash(int id)
+{
+	static const char empty[] = "";
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->GetDatabaseHash();
+	}
+	return empty;
+}
+
 const char*
 GetDumpFileName(int id)
 {
@@ -489,6 +546,40 @@ GetOutputStringOn(int id)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+GetPhaseCounters(int id, int phase, int* calls, double* seconds, double* cycles, double* instructions, double* cache_misses, double* branch_misses)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->GetPhaseCounters(phase, calls, seconds, cycles, instructions, cache_misses, branch_misses))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
+IPQ_RESULT
+GetRunStatistics(int id, RUN_STATISTICS* stats)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->GetRunStatistics(stats))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 GetSelectedOutputColumnCount(int id)
 {
@@ -688,6 +779,17 @@ GetWarningStringLineCount(int id)
 	return IPQ_BADINSTANCE;
 }
 
+int
+IsRunComplete(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->IsRunComplete() ? 1 : 0;
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 LoadDatabase(int id, const char* filename)
 {
@@ -710,6 +812,23 @@ LoadDatabaseString(int id, const char* input)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+ModifySolutionTotals(int id, int n, double total_h, double total_o, double cb, int count, const char** elements, const double* moles)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->ModifySolutionTotals(n, total_h, total_o, cb, count, elements, moles))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 void
 OutputAccumulatedLines(int id)
 {
@@ -755,6 +874,23 @@ OutputWarningString(int id)
 #endif
 }
 
+IPQ_RESULT
+RestoreState(int id, int state)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->RestoreState(state))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 RunAccumulated(int id)
 {
@@ -777,6 +913,24 @@ RunFile(int id, const char* filename)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+RunFileAsync(int id, const char* filename, PFN_RUN_COMPLETE_CALLBACK pfn, void *cookie)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->RunFileAsync(filename, pfn, cookie))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		case VR_OUTOFMEMORY: return IPQ_OUTOFMEMORY;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 RunString(int id, const char* input)
 {
@@ -788,6 +942,35 @@ RunString(int id, const char* input)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+RunStringAsync(int id, const char* input, PFN_RUN_COMPLETE_CALLBACK pfn, void *cookie)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->RunStringAsync(input, pfn, cookie))
+		{
+		case VR_OK:          return IPQ_OK;
+		case VR_INVALIDARG:  return IPQ_INVALIDARG;
+		case VR_OUTOFMEMORY: return IPQ_OUTOFMEMORY;
+		default:
+			assert(false);
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
+int
+SaveState(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->SaveState();
+	}
+	return IPQ_BADINSTANCE;
+}
+
 IPQ_RESULT
 SetBasicCallback(int id, double (*fcn)(double x1, double x2, const char *str, void *cookie), void *cookie1)
 {
@@ -1034,6 +1217,17 @@ SetSelectedOutputStringOn(int id, int value)
 	return IPQ_BADINSTANCE;
 }
 
+int
+WaitRun(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->WaitRun();
+	}
+	return IPQ_BADINSTANCE;
+}
+
 // helper functions
 //
 
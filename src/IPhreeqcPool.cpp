@@ -0,0 +1,567 @@
+#include <string.h>
+#include "IPhreeqcPool.hpp"             // IPhreeqcPool
+#include "Phreeqc.h"                    // Phreeqc
+#include "CVar.hxx"                     // CVar
+#include "Dictionary.h"                 // Dictionary
+#include "Serializer.h"                 // Serializer
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+// a job and, once a worker has run it, its results
+class IPhreeqcPoolJob
+{
+public:
+	IPhreeqcPoolJob(void)
+	: NUserStart(-1)
+	, NUserEnd(-1)
+	, Errors(-1)
+	, Rows(0)
+	, Cols(0)
+	{
+	}
+
+	std::string           Input;
+	int                   NUserStart;
+	int                   NUserEnd;
+
+	int                   Errors;
+	std::string           ErrorString;
+	int                   Rows;
+	int                   Cols;
+	std::vector<CVar>     Values;              // row major, row 0 holds the headings
+	std::string           Words;               // Serializer dictionary
+	std::vector<int>      Ints;
+	std::vector<double>   Doubles;
+};
+
+#if !defined(_WIN32)
+
+// Messages between master and workers are a length followed by the
+// payload; both sides run the same binary, so values are sent in the
+// native representation.
+
+#if defined(MSG_NOSIGNAL)
+#define POOL_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define POOL_SEND_FLAGS 0
+#endif
+
+template <typename T>
+static void put(std::string& buffer, T value)
+{
+	buffer.append((const char*)&value, sizeof(T));
+}
+
+static void put_string(std::string& buffer, const std::string& s)
+{
+	put(buffer, (unsigned long long)s.size());
+	buffer.append(s);
+}
+
+class message_reader
+{
+public:
+	message_reader(const std::string& buffer) : buffer(buffer), pos(0), ok(true) {}
+
+	template <typename T>
+	T get(void)
+	{
+		T value = T();
+		if (this->pos + sizeof(T) > this->buffer.size())
+		{
+			this->ok = false;
+			return value;
+		}
+		memcpy(&value, this->buffer.data() + this->pos, sizeof(T));
+		this->pos += sizeof(T);
+		return value;
+	}
+
+	std::string get_string(void)
+	{
+		unsigned long long n = this->get<unsigned long long>();
+		if (n > this->buffer.size() - this->pos)
+		{
+			this->ok = false;
+			return std::string();
+		}
+		std::string s(this->buffer, this->pos, (size_t)n);
+		this->pos += (size_t)n;
+		return s;
+	}
+
+	const std::string& buffer;
+	size_t pos;
+	bool ok;
+};
+
+static bool send_message(int fd, const std::string& payload)
+{
+	std::string buffer;
+	put(buffer, (unsigned long long)payload.size());
+	buffer.append(payload);
+
+	const char* p = buffer.data();
+	size_t n = buffer.size();
+	while (n > 0)
+	{
+		ssize_t sent = ::send(fd, p, n, POOL_SEND_FLAGS);
+		if (sent < 0)
+		{
+			if (errno == EINTR) continue;
+			return false;
+		}
+		p += sent;
+		n -= (size_t)sent;
+	}
+	return true;
+}
+
+static bool recv_all(int fd, char* p, size_t n)
+{
+	while (n > 0)
+	{
+		ssize_t got = ::recv(fd, p, n, 0);
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0)
+		{
+			return false;
+		}
+		p += got;
+		n -= (size_t)got;
+	}
+	return true;
+}
+
+static bool recv_message(int fd, std::string& payload)
+{
+	unsigned long long n;
+	if (!recv_all(fd, (char*)&n, sizeof(n)))
+	{
+		return false;
+	}
+	payload.resize((size_t)n);
+	return n == 0 || recv_all(fd, &payload[0], (size_t)n);
+}
+
+#endif /* !defined(_WIN32) */
+
+IPhreeqcPool::IPhreeqcPool(void)
+: NextJob(0)
+{
+}
+
+IPhreeqcPool::~IPhreeqcPool(void)
+{
+	this->Stop();
+	this->ClearJobs();
+}
+
+void IPhreeqcPool::ClearJobs(void)
+{
+	for (size_t i = 0; i < this->Jobs.size(); ++i)
+	{
+		delete this->Jobs[i];
+	}
+	this->Jobs.clear();
+	this->NextJob = 0;
+}
+
+int IPhreeqcPool::GetJobCount(void)const
+{
+	return (int)this->Jobs.size();
+}
+
+int IPhreeqcPool::GetJobErrorCount(int job)const
+{
+	if (job < 0 || job >= (int)this->Jobs.size())
+	{
+		return -1;
+	}
+	return this->Jobs[job]->Errors;
+}
+
+const char* IPhreeqcPool::GetJobErrorString(int job)const
+{
+	static const char empty[] = "";
+	if (job < 0 || job >= (int)this->Jobs.size())
+	{
+		return empty;
+	}
+	return this->Jobs[job]->ErrorString.c_str();
+}
+
+int IPhreeqcPool::GetJobSelectedOutputColumnCount(int job)const
+{
+	if (job < 0 || job >= (int)this->Jobs.size())
+	{
+		return 0;
+	}
+	return this->Jobs[job]->Cols;
+}
+
+int IPhreeqcPool::GetJobSelectedOutputRowCount(int job)const
+{
+	if (job < 0 || job >= (int)this->Jobs.size())
+	{
+		return 0;
+	}
+	return this->Jobs[job]->Rows;
+}
+
+VRESULT IPhreeqcPool::GetJobSelectedOutputValue(int job, int row, int col, VAR* pVAR)const
+{
+	if (job < 0 || job >= (int)this->Jobs.size() || !pVAR)
+	{
+		return VR_INVALIDARG;
+	}
+	const IPhreeqcPoolJob& j = *this->Jobs[job];
+	if (row < 0 || row >= j.Rows)
+	{
+		return VR_INVALIDROW;
+	}
+	if (col < 0 || col >= j.Cols)
+	{
+		return VR_INVALIDCOL;
+	}
+	return ::VarCopy(pVAR, &j.Values[(size_t)row * j.Cols + col]);
+}
+
+IPhreeqc& IPhreeqcPool::GetMaster(void)
+{
+	return this->Master;
+}
+
+int IPhreeqcPool::GetWorkerCount(void)const
+{
+	return (int)this->WorkerFds.size();
+}
+
+int IPhreeqcPool::Start(int workers)
+{
+	this->Stop();
+#if !defined(_WIN32)
+	for (int i = 0; i < workers; ++i)
+	{
+		int sv[2];
+		if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+		{
+			break;
+		}
+		pid_t pid = ::fork();
+		if (pid < 0)
+		{
+			::close(sv[0]);
+			::close(sv[1]);
+			break;
+		}
+		if (pid == 0)
+		{
+			// the worker only talks to the master
+			::close(sv[0]);
+			for (size_t w = 0; w < this->WorkerFds.size(); ++w)
+			{
+				::close(this->WorkerFds[w]);
+			}
+			this->run_worker(sv[1]);
+		}
+		::close(sv[1]);
+		this->WorkerPids.push_back((int)pid);
+		this->WorkerFds.push_back(sv[0]);
+		this->WorkerJobs.push_back(-1);
+	}
+#endif
+	return this->WorkerFds.empty() ? -1 : (int)this->WorkerFds.size();
+}
+
+void IPhreeqcPool::Stop(void)
+{
+#if !defined(_WIN32)
+	// workers exit when their socket is closed
+	for (size_t w = 0; w < this->WorkerFds.size(); ++w)
+	{
+		::close(this->WorkerFds[w]);
+	}
+	for (size_t w = 0; w < this->WorkerPids.size(); ++w)
+	{
+		while (::waitpid((pid_t)this->WorkerPids[w], NULL, 0) < 0 && errno == EINTR)
+		{
+		}
+	}
+#endif
+	this->WorkerPids.clear();
+	this->WorkerFds.clear();
+	this->WorkerJobs.clear();
+}
+
+int IPhreeqcPool::Submit(const char* input, int n_user_start, int n_user_end)
+{
+	IPhreeqcPoolJob* job = new IPhreeqcPoolJob;
+	job->Input      = input ? input : "";
+	job->NUserStart = n_user_start;
+	job->NUserEnd   = n_user_end;
+	this->Jobs.push_back(job);
+	return (int)this->Jobs.size() - 1;
+}
+
+int IPhreeqcPool::Wait(void)
+{
+	size_t first = this->NextJob;
+#if !defined(_WIN32)
+	for (;;)
+	{
+		// give every idle worker a job
+		for (size_t w = this->WorkerFds.size(); w-- > 0; )
+		{
+			if (this->WorkerJobs[w] < 0 && this->NextJob < this->Jobs.size())
+			{
+				const IPhreeqcPoolJob& job = *this->Jobs[this->NextJob];
+				std::string msg;
+				put_string(msg, job.Input);
+				put(msg, job.NUserStart);
+				put(msg, job.NUserEnd);
+				this->WorkerJobs[w] = (int)this->NextJob++;
+				if (!send_message(this->WorkerFds[w], msg))
+				{
+					this->drop_worker(w);
+				}
+			}
+		}
+
+		std::vector<struct pollfd> fds;
+		std::vector<size_t> busy;
+		for (size_t w = 0; w < this->WorkerFds.size(); ++w)
+		{
+			if (this->WorkerJobs[w] >= 0)
+			{
+				struct pollfd pfd;
+				pfd.fd      = this->WorkerFds[w];
+				pfd.events  = POLLIN;
+				pfd.revents = 0;
+				fds.push_back(pfd);
+				busy.push_back(w);
+			}
+		}
+		if (fds.empty())
+		{
+			break;
+		}
+		if (::poll(&fds[0], (nfds_t)fds.size(), -1) < 0)
+		{
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		// collect results; drop from the back so indices stay valid
+		for (size_t i = fds.size(); i-- > 0; )
+		{
+			if (fds[i].revents == 0) continue;
+			size_t w = busy[i];
+			std::string msg;
+			if (!recv_message(this->WorkerFds[w], msg))
+			{
+				this->drop_worker(w);
+				continue;
+			}
+			IPhreeqcPoolJob& job = *this->Jobs[this->WorkerJobs[w]];
+			message_reader r(msg);
+			int errors       = r.get<int>();
+			job.ErrorString  = r.get_string();
+			job.Rows         = r.get<int>();
+			job.Cols         = r.get<int>();
+			job.Values.clear();
+			for (int n = 0; r.ok && n < job.Rows * job.Cols; ++n)
+			{
+				CVar v;
+				switch (r.get<int>())
+				{
+				case TT_DOUBLE:
+					v = r.get<double>();
+					break;
+				case TT_LONG:
+					v = CVar(r.get<long>());
+					break;
+				case TT_STRING:
+					v = r.get_string().c_str();
+					break;
+				case TT_ERROR:
+					v.type    = TT_ERROR;
+					v.vresult = (VRESULT)r.get<int>();
+					break;
+				default:
+					break;
+				}
+				job.Values.push_back(v);
+			}
+			job.Words = r.get_string();
+			job.Ints.resize((size_t)r.get<unsigned long long>());
+			for (size_t n = 0; r.ok && n < job.Ints.size(); ++n)
+			{
+				job.Ints[n] = r.get<int>();
+			}
+			job.Doubles.resize((size_t)r.get<unsigned long long>());
+			for (size_t n = 0; r.ok && n < job.Doubles.size(); ++n)
+			{
+				job.Doubles[n] = r.get<double>();
+			}
+			if (r.ok)
+			{
+				job.Errors = errors;
+				this->WorkerJobs[w] = -1;
+			}
+			else
+			{
+				job.Values.clear();
+				job.Rows = job.Cols = 0;
+				job.Ints.clear();
+				job.Doubles.clear();
+				this->drop_worker(w);
+			}
+		}
+	}
+#endif
+
+	// jobs left over had no worker
+	for (; this->NextJob < this->Jobs.size(); ++this->NextJob)
+	{
+		this->Jobs[this->NextJob]->ErrorString = "IPhreeqcPool: No worker is running.\n";
+	}
+
+	int failed = 0;
+	for (size_t i = first; i < this->Jobs.size(); ++i)
+	{
+		IPhreeqcPoolJob& job = *this->Jobs[i];
+		if (job.Errors != 0)
+		{
+			++failed;
+		}
+		if (!job.Ints.empty())
+		{
+			Dictionary dictionary(job.Words);
+			Serializer serializer;
+			serializer.Deserialize(*this->Master.PhreeqcPtr, dictionary, job.Ints, job.Doubles);
+		}
+	}
+	return failed;
+}
+
+void IPhreeqcPool::drop_worker(size_t w)
+{
+#if !defined(_WIN32)
+	if (this->WorkerJobs[w] >= 0)
+	{
+		this->Jobs[this->WorkerJobs[w]]->ErrorString = "IPhreeqcPool: The worker running the job exited.\n";
+	}
+	::close(this->WorkerFds[w]);
+	::kill((pid_t)this->WorkerPids[w], SIGKILL);
+	while (::waitpid((pid_t)this->WorkerPids[w], NULL, 0) < 0 && errno == EINTR)
+	{
+	}
+	this->WorkerPids.erase(this->WorkerPids.begin() + w);
+	this->WorkerFds.erase(this->WorkerFds.begin() + w);
+	this->WorkerJobs.erase(this->WorkerJobs.begin() + w);
+#endif
+}
+
+void IPhreeqcPool::run_worker(int fd)
+{
+#if !defined(_WIN32)
+	IPhreeqc& ipq = this->Master;
+	// KNOBS -threads workers of the master do not exist here
+	ipq.PhreeqcPtr->loop_threads.Forget_threads();
+	ipq.SetOutputFileOn(false);
+	ipq.SetLogFileOn(false);
+	ipq.SetErrorFileOn(false);
+	ipq.SetDumpFileOn(false);
+	ipq.SetSelectedOutputFileOn(false);
+
+	// every job starts from the state inherited from the master
+	int state = ipq.SaveState();
+
+	std::string msg;
+	while (recv_message(fd, msg))
+	{
+		message_reader r(msg);
+		std::string input = r.get_string();
+		int n_user_start  = r.get<int>();
+		int n_user_end    = r.get<int>();
+		if (!r.ok)
+		{
+			break;
+		}
+
+		ipq.RestoreState(state);
+		int errors = ipq.RunString(input.c_str());
+
+		std::string out;
+		put(out, errors);
+		put_string(out, ipq.GetErrorString());
+		int rows = ipq.GetSelectedOutputRowCount();
+		int cols = ipq.GetSelectedOutputColumnCount();
+		put(out, rows);
+		put(out, cols);
+		for (int i = 0; i < rows; ++i)
+		{
+			for (int j = 0; j < cols; ++j)
+			{
+				CVar v;
+				ipq.GetSelectedOutputValue(i, j, &v);
+				put(out, (int)v.type);
+				switch (v.type)
+				{
+				case TT_DOUBLE:
+					put(out, v.dVal);
+					break;
+				case TT_LONG:
+					put(out, v.lVal);
+					break;
+				case TT_STRING:
+					put_string(out, v.sVal);
+					break;
+				case TT_ERROR:
+					put(out, (int)v.vresult);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		Serializer serializer;
+		if (n_user_end >= n_user_start)
+		{
+			serializer.Serialize(*ipq.PhreeqcPtr, n_user_start, n_user_end, true, true);
+		}
+		put_string(out, serializer.GetDictionary().GetDictionaryOss().str());
+		put(out, (unsigned long long)serializer.GetInts().size());
+		for (size_t i = 0; i < serializer.GetInts().size(); ++i)
+		{
+			put(out, serializer.GetInts()[i]);
+		}
+		put(out, (unsigned long long)serializer.GetDoubles().size());
+		for (size_t i = 0; i < serializer.GetDoubles().size(); ++i)
+		{
+			put(out, serializer.GetDoubles()[i]);
+		}
+
+		if (!send_message(fd, out))
+		{
+			break;
+		}
+	}
+	::close(fd);
+
+	// leave without running the destructors and atexit handlers of the master
+	::_exit(0);
+#else
+	(void)fd;
+#endif
+}
@@ -0,0 +1,187 @@
+/*! @file IPhreeqcPool.hpp
+	@brief C++ Documentation
+*/
+
+#ifndef INC_IPHREEQCPOOL_HPP
+#define INC_IPHREEQCPOOL_HPP
+
+#include <string>
+#include <vector>
+#include "IPhreeqc.hpp"
+
+class IPhreeqcPoolJob;
+
+/**
+ * @class IPhreeqcPool
+ *
+ * @brief Runs phreeqc input in worker processes forked from a master
+ * %IPhreeqc instance (POSIX only).
+ *
+ * The master instance is set up once (database, definitions shared by all
+ * jobs, Basic callbacks); @ref Start then forks the workers, which inherit
+ * the loaded database without reloading it. Each job is run by one worker
+ * starting from the master's state at the time of @ref Start, so jobs do not
+ * see each other's definitions. Because the workers are separate processes,
+ * Basic callbacks and other user code need not be thread-safe.
+ */
+
+class IPQ_DLL_EXPORT IPhreeqcPool
+{
+public:
+	/**
+	 * Constructor.
+	 */
+	IPhreeqcPool(void);
+
+	/**
+	 * Destructor.  Stops the workers.
+	 */
+	~IPhreeqcPool(void);
+
+public:
+
+	/**
+	 *  Releases the results of all jobs.
+	 *  @see                    Submit, Wait
+	 */
+	void                     ClearJobs(void);
+
+	/**
+	 *  Retrieves the number of jobs submitted since the last @ref ClearJobs.
+	 *  @return                 The number of jobs.
+	 */
+	int                      GetJobCount(void)const;
+
+	/**
+	 *  Retrieves the number of errors of a job.
+	 *  @param job              The job number returned from @ref Submit.
+	 *  @return                 The number of errors of the run, or -1 if the job is unknown,
+	 *                          has not been run, or its worker exited.
+	 *  @see                    GetJobErrorString
+	 */
+	int                      GetJobErrorCount(int job)const;
+
+	/**
+	 *  Retrieves the error messages of a job.
+	 *  @param job              The job number returned from @ref Submit.
+	 *  @return                 A null terminated string containing error messages.
+	 *  @see                    GetJobErrorCount
+	 */
+	const char*              GetJobErrorString(int job)const;
+
+	/**
+	 *  Retrieves the number of columns in the selected-output buffer of a job.
+	 *  @param job              The job number returned from @ref Submit.
+	 *  @return                 The number of columns, or 0 if the job is unknown.
+	 */
+	int                      GetJobSelectedOutputColumnCount(int job)const;
+
+	/**
+	 *  Retrieves the number of rows in the selected-output buffer of a job.
+	 *  @param job              The job number returned from @ref Submit.
+	 *  @return                 The number of rows, or 0 if the job is unknown.
+	 */
+	int                      GetJobSelectedOutputRowCount(int job)const;
+
+	/**
+	 *  Returns the <code>VAR</code> associated with the specified row and column of the
+	 *  selected-output buffer of a job; row 0 contains the headings.
+	 *  The selected output is that of the master's current selected-output user number.
+	 *  @param job              The job number returned from @ref Submit.
+	 *  @param row              The row index.
+	 *  @param col              The column index.
+	 *  @param pVAR             Pointer to the <code>VAR</code> to receive the requested data.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   The given job is unknown or pVAR is NULL.
+	 *  @retval VR_INVALIDROW   The given row is out of range.
+	 *  @retval VR_INVALIDCOL   The given column is out of range.
+	 *  @retval VR_OUTOFMEMORY  Memory could not be allocated for the string.
+	 *  @see                    IPhreeqc::GetSelectedOutputValue
+	 */
+	VRESULT                  GetJobSelectedOutputValue(int job, int row, int col, VAR* pVAR)const;
+
+	/**
+	 *  Retrieves the master instance.  Load the database, run the definitions
+	 *  shared by all jobs and set callbacks on it before calling @ref Start.
+	 *  @return                 The master %IPhreeqc instance.
+	 */
+	IPhreeqc&                GetMaster(void);
+
+	/**
+	 *  Retrieves the number of running workers.
+	 *  @return                 The number of workers.
+	 */
+	int                      GetWorkerCount(void)const;
+
+	/**
+	 *  Forks the worker processes.  Workers already running are stopped first.
+	 *  @param workers          The number of workers to start.
+	 *  @return                 The number of workers started, or -1 if no worker could be started.
+	 *  @remarks
+	 *      Output, log, error, dump and selected-output files are switched off in the workers.
+	 *  @pre
+	 *      The database of the master instance must have been loaded with 0 (zero) errors.
+	 */
+	int                      Start(int workers);
+
+	/**
+	 *  Stops the worker processes and waits for them to exit.
+	 */
+	void                     Stop(void);
+
+	/**
+	 *  Queues phreeqc input to be run by a worker.
+	 *  @param input            String containing phreeqc input.
+	 *  @param n_user_start     First user number of the reactants to copy back into the master instance.
+	 *  @param n_user_end       Last user number of the reactants to copy back into the master instance.
+	 *  @return                 The job number (0 or greater).
+	 *  @remarks
+	 *      When n_user_end is not less than n_user_start, the solutions, exchangers, gas phases,
+	 *      kinetics, equilibrium phases, solid solutions, surfaces, temperatures and pressures
+	 *      in the range are copied into the master instance by @ref Wait, in job order.
+	 *  @see                    Wait
+	 */
+	int                      Submit(const char* input, int n_user_start = -1, int n_user_end = -1);
+
+	/**
+	 *  Runs the queued jobs on the workers and waits until all are done.
+	 *  @return                 The number of jobs that had errors or could not be run.
+	 *  @see                    GetJobErrorCount, Submit
+	 */
+	int                      Wait(void);
+
+protected:
+	void run_worker(int fd);
+	void drop_worker(size_t w);
+
+protected:
+#if defined(_MSC_VER)
+/* disable warning C4251: 'identifier' : class 'type' needs to have dll-interface to be used by clients of class 'type2' */
+#pragma warning(disable:4251)
+#endif
+
+	IPhreeqc                       Master;
+	std::vector< IPhreeqcPoolJob* > Jobs;
+	size_t                         NextJob;
+	std::vector< int >             WorkerPids;
+	std::vector< int >             WorkerFds;
+	std::vector< int >             WorkerJobs;
+
+#if defined(_MSC_VER)
+/* reset warning C4251 */
+#pragma warning(default:4251)
+#endif
+
+private:
+	/**
+	 *  Copy constructor not supported
+	 */
+	IPhreeqcPool(const IPhreeqcPool&);
+
+	/**
+	 *  operator= not supported
+	 */
+	IPhreeqcPool& operator=(const IPhreeqcPool&);
+};
+
+#endif // INC_IPHREEQCPOOL_HPP
@@ -5,6 +5,7 @@
 #include <assert.h>  /* assert */
 #include <stdio.h>   /* sprintf */
 #include <cstring>
+#include <vector>
 #include "phrqtype.h"
 #include "IPhreeqc.h"
 #include "Phreeqc.h" /* snprintf */
@@ -76,12 +77,30 @@ CreateIPhreeqcF(void)
 	return ::CreateIPhreeqc();
 }
 
+int
+DeleteStateF(int *id, int *state)
+{
+	return ::DeleteState(*id, *state);
+}
+
 int
 DestroyIPhreeqcF(int *id)
 {
 	return ::DestroyIPhreeqc(*id);
 }
 
+int
+GetCellCostF(int *id, int *cell, int *iterations, int *retries, int *solves, int *kinetic_steps, double *seconds)
+{
+	return ::GetCellCost(*id, *cell, iterations, retries, solves, kinetic_steps, seconds);
+}
+
+int
+GetCellCostCountF(int *id)
+{
+	return ::GetCellCostCount(*id);
+}
+
 int
 GetComponentCountF(int *id)
 {
@@ -234,6 +253,18 @@ GetOutputStringOnF(int *id)
 	return ::GetOutputStringOn(*id);
 }
 
+int
+GetPhaseCountersF(int *id, int *phase, int *calls, double *seconds, double *cycles, double *instructions, double *cache_misses, double *branch_misses)
+{
+	return ::GetPhaseCounters(*id, *phase, calls, seconds, cycles, instructions, cache_misses, branch_misses);
+}
+
+int
+GetRunStatisticsF(int *id, RUN_STATISTICS *stats)
+{
+	return ::GetRunStatistics(*id, stats);
+}
+
 int
 GetOutputFileOnF(int *id)
 {
@@ -361,6 +392,12 @@ GetWarningStringLineF(int *id, int* n, char* line, int* line_length)
 	padfstring(line, ::GetWarningStringLine(*id, (*n) - 1), line_length);
 }
 
+int
+IsRunCompleteF(int *id)
+{
+	return ::IsRunComplete(*id);
+}
+
 int
 LoadDatabaseF(int *id, char* filename)
 {
@@ -375,6 +412,20 @@ LoadDatabaseStringF(int *id, char* input)
 	return n;
 }
 
+IPQ_RESULT
+ModifySolutionTotalsF(int *id, int *n, double *total_h, double *total_o, double *cb, int *count, char* elements, double* moles)
+{
+	// elements holds count null-terminated names one after the other
+	std::vector<const char*> names;
+	const char* name = elements;
+	for (int i = 0; i < *count; ++i)
+	{
+		names.push_back(name);
+		name += strlen(name) + 1;
+	}
+	return ::ModifySolutionTotals(*id, *n, *total_h, *total_o, *cb, *count, names.empty() ? NULL : &names[0], moles);
+}
+
 void
 OutputAccumulatedLinesF(int *id)
 {
@@ -393,6 +444,12 @@ OutputWarningStringF(int *id)
 	::OutputWarningString(*id);
 }
 
+int
+RestoreStateF(int *id, int *state)
+{
+	return ::RestoreState(*id, *state);
+}
+
 int
 RunAccumulatedF(int *id)
 {
@@ -406,12 +463,30 @@ RunFileF(int *id, char* filename)
 	return n;
 }
 
+int
+RunFileAsyncF(int *id, char* filename)
+{
+	return ::RunFileAsync(*id, filename, NULL, NULL);
+}
+
 int
 RunStringF(int *id, char* input)
 {
 	int n = ::RunString(*id, input);
 	return n;
 }
+
+int
+RunStringAsyncF(int *id, char* input)
+{
+	return ::RunStringAsync(*id, input, NULL, NULL);
+}
+
+int
+SaveStateF(int *id)
+{
+	return ::SaveState(*id);
+}
 #ifdef IPHREEQC_NO_FORTRAN_MODULE
 IPQ_RESULT
 SetBasicFortranCallbackF(int *id, double (*fcn)(double *x1, double *x2, const char *str, size_t l))
@@ -532,4 +607,10 @@ SetSelectedOutputStringOnF(int *id, int* selected_output_string_on)
 {
 	return ::SetSelectedOutputStringOn(*id, *selected_output_string_on);
 }
+
+int
+WaitRunF(int *id)
+{
+	return ::WaitRun(*id);
+}
 #endif
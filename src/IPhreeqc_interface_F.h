@@ -2,6 +2,7 @@
 #define __IPHREEQC_INTERFACE__H
 
 #include "PHRQ_exports.h"
+#include "RunStatistics.h"
 
 #ifdef SKIP
 #if defined(FC_FUNC)
@@ -86,7 +87,10 @@ extern "C" {
   IPQ_DLL_EXPORT int        AddWarningF(int *id, char *warn_msg);
   IPQ_DLL_EXPORT IPQ_RESULT ClearAccumulatedLinesF(int *id);
   IPQ_DLL_EXPORT int        CreateIPhreeqcF(void);
+  IPQ_DLL_EXPORT int        DeleteStateF(int *id, int *state);
   IPQ_DLL_EXPORT int        DestroyIPhreeqcF(int *id);
+  IPQ_DLL_EXPORT int        GetCellCostF(int *id, int *cell, int *iterations, int *retries, int *solves, int *kinetic_steps, double *seconds);
+  IPQ_DLL_EXPORT int        GetCellCostCountF(int *id);
   IPQ_DLL_EXPORT void       GetComponentF(int *id, int* n, char* line, int* line_length);
   IPQ_DLL_EXPORT int        GetComponentCountF(int *id);
   IPQ_DLL_EXPORT int        GetCurrentSelectedOutputUserNumberF(int *id);
@@ -112,6 +116,8 @@ extern "C" {
   IPQ_DLL_EXPORT void       GetOutputStringLineF(int *id, int* n, char* line, int* line_length);
   IPQ_DLL_EXPORT int        GetOutputStringLineCountF(int *id);
   IPQ_DLL_EXPORT int        GetOutputStringOnF(int *id);
+  IPQ_DLL_EXPORT int        GetPhaseCountersF(int *id, int *phase, int *calls, double *seconds, double *cycles, double *instructions, double *cache_misses, double *branch_misses);
+  IPQ_DLL_EXPORT int        GetRunStatisticsF(int *id, RUN_STATISTICS *stats);
   IPQ_DLL_EXPORT int        GetSelectedOutputColumnCountF(int *id);
   IPQ_DLL_EXPORT int        GetSelectedOutputCountF(int *id);
   IPQ_DLL_EXPORT void       GetSelectedOutputFileNameF(int *id, char* filename, int* filename_length);
@@ -124,14 +130,20 @@ extern "C" {
   IPQ_DLL_EXPORT void       GetVersionStringF(char* version, int* version_length);
   IPQ_DLL_EXPORT void       GetWarningStringLineF(int *id, int* n, char* line, int* line_length);
   IPQ_DLL_EXPORT int        GetWarningStringLineCountF(int *id);
+  IPQ_DLL_EXPORT int        IsRunCompleteF(int *id);
   IPQ_DLL_EXPORT int        LoadDatabaseF(int *id, char* filename);
   IPQ_DLL_EXPORT int        LoadDatabaseStringF(int *id, char* input);
+  IPQ_DLL_EXPORT IPQ_RESULT ModifySolutionTotalsF(int *id, int *n, double *total_h, double *total_o, double *cb, int *count, char* elements, double* moles);
   IPQ_DLL_EXPORT void       OutputAccumulatedLinesF(int *id);
   IPQ_DLL_EXPORT void       OutputErrorStringF(int *id);
   IPQ_DLL_EXPORT void       OutputWarningStringF(int *id);
+  IPQ_DLL_EXPORT int        RestoreStateF(int *id, int *state);
   IPQ_DLL_EXPORT int        RunAccumulatedF(int *id);
   IPQ_DLL_EXPORT int        RunFileF(int *id, char* filename);
+  IPQ_DLL_EXPORT int        RunFileAsyncF(int *id, char* filename);
   IPQ_DLL_EXPORT int        RunStringF(int *id, char* input);
+  IPQ_DLL_EXPORT int        RunStringAsyncF(int *id, char* input);
+  IPQ_DLL_EXPORT int        SaveStateF(int *id);
 #ifdef IPHREEQC_NO_FORTRAN_MODULE
   IPQ_DLL_EXPORT IPQ_RESULT SetBasicFortranCallbackF(int *id, double (*fcn)(double *x1, double *x2, const char *str, size_t l));
 #else
@@ -154,6 +166,7 @@ extern "C" {
   IPQ_DLL_EXPORT IPQ_RESULT SetSelectedOutputFileNameF(int *id, char* fname);
   IPQ_DLL_EXPORT IPQ_RESULT SetSelectedOutputFileOnF(int *id, int* selected_output_file_on);
   IPQ_DLL_EXPORT IPQ_RESULT SetSelectedOutputStringOnF(int *id, int* selected_output_string_on);
+  IPQ_DLL_EXPORT int        WaitRunF(int *id);
 
 #if defined(__cplusplus)
 }
@@ -0,0 +1,53 @@
+/*! @file RunStatistics.h
+	@brief %IPhreeqc RUN_STATISTICS Documentation
+*/
+/* RunStatistics.h */
+
+#ifndef __RUN_STATISTICS_H_INC
+#define __RUN_STATISTICS_H_INC
+
+/*! \brief Number of entries in RUN_STATISTICS::attempts.
+*/
+#define RS_ATTEMPT_COUNT      15
+
+/*! \brief Number of entries in RUN_STATISTICS::calculations.
+*/
+#define RS_CALCULATION_COUNT  10
+
+/* IPhreeqc_interface.F90 includes only the counts */
+#if !defined(RUN_STATISTICS_COUNTS_ONLY)
+
+/*! \brief Solver statistics of a run, see GetRunStatistics.
+ *
+ *  attempts[0] counts the reaction, advection and transport calculations;
+ *  attempts[j], j > 0, counts the retries made with the j-th set of
+ *  modified convergence parameters (1 smaller step size, 2 reduced
+ *  tolerance, 3 increased tolerance, 4 diagonal scaling, 5 diagonal
+ *  scaling and reduced tolerance, 6 scaled pure-phase columns, 7 scaled
+ *  pure-phase columns and diagonal scaling, 8 delayed removal of
+ *  equilibrium phases, 9 increased scaling, 10 no optimization for the
+ *  first iterations, 11 positive-concentration inequality, 12 and 13
+ *  further reduced tolerance, 14 restart).
+ *
+ *  calculations[n] counts the equilibrium calculations by type:
+ *  1 initial solution, 2 initial exchange, 3 initial surface, 4 initial
+ *  gas phase, 5 reaction, 6 inverse, 7 advection, 8 transport, 9 PHAST.
+ *  Retries are included.
+*/
+typedef struct {
+	int iterations;                           /*!< Newton iterations, summed over all calculations             */
+	int jacobians;                            /*!< Jacobians evaluated by numerical differentiation            */
+	int attempts[RS_ATTEMPT_COUNT];           /*!< calculations and retries by set of convergence parameters   */
+	int failures;                             /*!< calculations that failed with every set of parameters       */
+	int calculations[RS_CALCULATION_COUNT];   /*!< equilibrium calculations by type                            */
+	int cvode_steps;                          /*!< CVODE integration steps                                     */
+	int rk_steps;                             /*!< accepted Runge-Kutta integration steps                      */
+	int rk_rejected;                          /*!< rejected Runge-Kutta integration steps                      */
+	int line_searches;                        /*!< Newton steps shortened by KNOBS -line_search                */
+	int g_sweeps;                             /*!< diffuse-layer sweeps, full integration of g                 */
+	int donnan_sweeps;                        /*!< diffuse-layer sweeps, Donnan approximation                  */
+} RUN_STATISTICS;
+
+#endif /* !defined(RUN_STATISTICS_COUNTS_ONLY) */
+
+#endif /* __RUN_STATISTICS_H_INC */
@@ -0,0 +1,281 @@
+#include "LoopThreads.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#if defined(PHREEQCI_GUI)
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+#endif
+
+// threads, lock and condition variables of the platform
+class loop_sync
+{
+public:
+	loop_sync(void)
+	{
+#if defined(_WIN32)
+		InitializeCriticalSection(&this->mutex);
+		InitializeConditionVariable(&this->start_cv);
+		InitializeConditionVariable(&this->done_cv);
+#else
+		pthread_mutex_init(&this->mutex, NULL);
+		pthread_cond_init(&this->start_cv, NULL);
+		pthread_cond_init(&this->done_cv, NULL);
+#endif
+	}
+	~loop_sync(void)
+	{
+#if defined(_WIN32)
+		DeleteCriticalSection(&this->mutex);
+#else
+		pthread_cond_destroy(&this->done_cv);
+		pthread_cond_destroy(&this->start_cv);
+		pthread_mutex_destroy(&this->mutex);
+#endif
+	}
+
+	void lock(void)
+	{
+#if defined(_WIN32)
+		EnterCriticalSection(&this->mutex);
+#else
+		pthread_mutex_lock(&this->mutex);
+#endif
+	}
+	void unlock(void)
+	{
+#if defined(_WIN32)
+		LeaveCriticalSection(&this->mutex);
+#else
+		pthread_mutex_unlock(&this->mutex);
+#endif
+	}
+	void wait_start(void)
+	{
+#if defined(_WIN32)
+		SleepConditionVariableCS(&this->start_cv, &this->mutex, INFINITE);
+#else
+		pthread_cond_wait(&this->start_cv, &this->mutex);
+#endif
+	}
+	void wait_done(void)
+	{
+#if defined(_WIN32)
+		SleepConditionVariableCS(&this->done_cv, &this->mutex, INFINITE);
+#else
+		pthread_cond_wait(&this->done_cv, &this->mutex);
+#endif
+	}
+	void signal_start(void)
+	{
+#if defined(_WIN32)
+		WakeAllConditionVariable(&this->start_cv);
+#else
+		pthread_cond_broadcast(&this->start_cv);
+#endif
+	}
+	void signal_done(void)
+	{
+#if defined(_WIN32)
+		WakeConditionVariable(&this->done_cv);
+#else
+		pthread_cond_signal(&this->done_cv);
+#endif
+	}
+
+	bool create(LoopThreads::worker_arg *arg)
+	{
+#if defined(_WIN32)
+		HANDLE h = CreateThread(NULL, 0, loop_sync::thread_proc, arg, 0, NULL);
+		if (h == NULL)
+			return false;
+#else
+		pthread_t h;
+		if (pthread_create(&h, NULL, loop_sync::thread_proc, arg) != 0)
+			return false;
+#endif
+		this->handles.push_back(h);
+		return true;
+	}
+	void join(void)
+	{
+		for (size_t i = 0; i < this->handles.size(); i++)
+		{
+#if defined(_WIN32)
+			WaitForSingleObject(this->handles[i], INFINITE);
+			CloseHandle(this->handles[i]);
+#else
+			pthread_join(this->handles[i], NULL);
+#endif
+		}
+		this->handles.clear();
+	}
+
+protected:
+#if defined(_WIN32)
+	static DWORD WINAPI thread_proc(LPVOID arg)
+	{
+		LoopThreads::worker_arg *a = (LoopThreads::worker_arg *) arg;
+		a->pool->Worker(a->t, a->generation);
+		return 0;
+	}
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE start_cv, done_cv;
+	std::vector<HANDLE> handles;
+#else
+	static void *thread_proc(void *arg)
+	{
+		LoopThreads::worker_arg *a = (LoopThreads::worker_arg *) arg;
+		a->pool->Worker(a->t, a->generation);
+		return NULL;
+	}
+	pthread_mutex_t mutex;
+	pthread_cond_t start_cv, done_cv;
+	std::vector<pthread_t> handles;
+#endif
+};
+
+LoopThreads::LoopThreads(void)
+{
+	this->threads = 1;
+	this->threshold = DEFAULT_THRESHOLD;
+	this->count = 0;
+	this->fn = NULL;
+	this->cookie = NULL;
+	this->generation = 0;
+	this->busy = 0;
+	this->quit = false;
+	this->sync = NULL;
+}
+
+LoopThreads::~LoopThreads(void)
+{
+	this->Stop();
+	delete this->sync;
+}
+
+void
+LoopThreads::Set_threads(int n)
+{
+	if (n < 1)
+		n = 1;
+	if (n == this->threads)
+		return;
+	this->Stop();
+	this->Start(n);
+}
+
+void
+LoopThreads::Start(int n)
+{
+	// the calling thread is thread 0
+	this->threads = 1;
+	if (n < 2)
+		return;
+	if (this->sync == NULL)
+		this->sync = new loop_sync;
+	this->quit = false;
+	this->args.resize((size_t)n);
+	for (int t = 1; t < n; t++)
+	{
+		this->args[t].pool = this;
+		this->args[t].t = t;
+		this->args[t].generation = this->generation;
+		if (!this->sync->create(&this->args[t]))
+			break;
+		this->threads++;
+	}
+}
+
+void
+LoopThreads::Stop(void)
+{
+	if (this->sync == NULL)
+		return;
+	this->sync->lock();
+	this->quit = true;
+	this->sync->signal_start();
+	this->sync->unlock();
+	this->sync->join();
+	this->threads = 1;
+}
+
+void
+LoopThreads::Forget_threads(void)
+{
+	// the workers were not copied by fork() and cannot be joined; the lock
+	// may have been copied in any state, so it is left unused
+	this->sync = NULL;
+	this->args.clear();
+	this->quit = false;
+	this->busy = 0;
+	this->threads = 1;
+}
+
+void
+LoopThreads::Run(int n, LOOP_FN f, void *c)
+{
+	if (n <= 0)
+		return;
+	if (this->threads == 1 || n < this->threshold)
+	{
+		f(c, 0, n);
+		return;
+	}
+	this->sync->lock();
+	this->count = n;
+	this->fn = f;
+	this->cookie = c;
+	this->busy = this->threads - 1;
+	this->generation++;
+	this->sync->signal_start();
+	this->sync->unlock();
+
+	this->Blocks(0);
+
+	this->sync->lock();
+	while (this->busy > 0)
+		this->sync->wait_done();
+	this->sync->unlock();
+}
+
+void
+LoopThreads::Blocks(int t)
+{
+	for (int first = t * BLOCK; first < this->count; first += this->threads * BLOCK)
+	{
+		int last = first + BLOCK;
+		if (last > this->count)
+			last = this->count;
+		this->fn(this->cookie, first, last);
+	}
+}
+
+void
+LoopThreads::Worker(int t, int seen)
+{
+	this->sync->lock();
+	for (;;)
+	{
+		while (!this->quit && this->generation == seen)
+			this->sync->wait_start();
+		if (this->quit)
+			break;
+		seen = this->generation;
+		this->sync->unlock();
+
+		this->Blocks(t);
+
+		this->sync->lock();
+		if (--this->busy == 0)
+			this->sync->signal_done();
+	}
+	this->sync->unlock();
+}
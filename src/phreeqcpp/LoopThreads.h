@@ -0,0 +1,71 @@
+#if !defined(LOOPTHREADS_H_INCLUDED)
+#define LOOPTHREADS_H_INCLUDED
+#include <vector>
+
+class loop_sync;
+
+/*
+ *   Runs the per-species loops of one Phreeqc instance on a few threads.
+ *   The index range is cut into blocks of BLOCK indices and thread t
+ *   runs blocks t, t + threads, ...; loops given to Run must only write
+ *   data of their own indices, so results do not depend on the number
+ *   of threads.  Ranges shorter than the threshold run on the calling
+ *   thread.
+ */
+class LoopThreads
+{
+public:
+	typedef void (*LOOP_FN)(void *cookie, int first, int last);
+	enum
+	{
+		BLOCK = 64,
+		DEFAULT_THRESHOLD = 512
+	};
+
+	LoopThreads(void);
+	~LoopThreads(void);
+
+	int Get_threads(void)const { return this->threads; }
+	void Set_threads(int n);
+	int Get_threshold(void)const { return this->threshold; }
+	void Set_threshold(int n) { this->threshold = (n > 0) ? n : 1; }
+	// calls fn(cookie, first, last) for blocks covering [0, count)
+	void Run(int count, LOOP_FN fn, void *cookie);
+	// in the child of fork(), where only the calling thread exists
+	void Forget_threads(void);
+
+protected:
+	void Start(int n);
+	void Stop(void);
+	void Blocks(int t);
+	void Worker(int t, int seen);
+	friend class loop_sync;
+
+protected:
+	class worker_arg
+	{
+	public:
+		LoopThreads *pool;
+		int t;
+		// generation when the thread was started
+		int generation;
+	};
+	int threads;
+	int threshold;
+	// the loop being run
+	int count;
+	LOOP_FN fn;
+	void *cookie;
+	// workers wait for a new generation, the caller for busy to reach 0
+	int generation;
+	int busy;
+	bool quit;
+	std::vector<worker_arg> args;
+	// threads, lock and condition variables of the platform
+	loop_sync *sync;
+
+private:
+	LoopThreads(const LoopThreads&);
+	LoopThreads& operator=(const LoopThreads&);
+};
+#endif // !defined(LOOPTHREADS_H_INCLUDED)
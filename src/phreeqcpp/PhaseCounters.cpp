@@ -0,0 +1,245 @@
+#include <string.h>
+#include "PhaseCounters.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__NR_perf_event_open)
+#define USE_PERF_EVENTS
+#endif
+#endif
+
+#if defined(PHREEQCI_GUI)
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+#endif
+
+PhaseCounters::phase::phase(void)
+{
+	this->calls = 0;
+	this->time = 0;
+	for (int j = 0; j < EVENT_COUNT; j++)
+	{
+		this->events[j] = 0;
+	}
+}
+
+PhaseCounters::PhaseCounters(void)
+{
+	this->on = false;
+	this->slot_count = 0;
+	for (int j = 0; j < EVENT_COUNT; j++)
+	{
+		this->fd[j] = -1;
+		this->slot[j] = -1;
+	}
+	this->Reset();
+}
+
+PhaseCounters::~PhaseCounters(void)
+{
+	this->Close();
+}
+
+void
+PhaseCounters::Set_on(bool tf)
+{
+	bool was_on = this->on;
+	this->on = tf;
+	if (this->on && !was_on)
+	{
+		this->Reset();
+	}
+	else if (!this->on)
+	{
+		this->Close();
+	}
+}
+
+bool
+PhaseCounters::Get_hardware(void)const
+{
+	return (this->slot_count > 0);
+}
+
+void
+PhaseCounters::Reset(void)
+{
+	if (this->on)
+	{
+		// perf events count the thread that opened them
+		this->Close();
+		this->Open();
+	}
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		this->phases[i] = phase();
+		this->depth[i] = 0;
+		this->start_time[i] = 0;
+		for (int j = 0; j < EVENT_COUNT; j++)
+		{
+			this->start_events[i][j] = 0;
+			if (this->slot[j] < 0)
+			{
+				this->phases[i].events[j] = -1;
+			}
+		}
+	}
+}
+
+void
+PhaseCounters::Start(PHASE p)
+{
+	// recursive calls are counted once, by the outermost call
+	if (this->depth[p]++ > 0)
+		return;
+	this->phases[p].calls++;
+	this->Sample(this->start_events[p]);
+	this->start_time[p] = Wall_time();
+}
+
+void
+PhaseCounters::Stop(PHASE p)
+{
+	if (this->depth[p] == 0 || --this->depth[p] > 0)
+		return;
+	LDBLE end_time = Wall_time();
+	LDBLE end_events[EVENT_COUNT];
+	if (this->Sample(end_events))
+	{
+		for (int j = 0; j < EVENT_COUNT; j++)
+		{
+			if (this->slot[j] >= 0)
+			{
+				this->phases[p].events[j] += end_events[j] - this->start_events[p][j];
+			}
+		}
+	}
+	this->phases[p].time += end_time - this->start_time[p];
+}
+
+LDBLE
+PhaseCounters::Wall_time(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER count, frequency;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&frequency);
+	return (LDBLE) count.QuadPart / (LDBLE) frequency.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (LDBLE) ts.tv_sec + (LDBLE) ts.tv_nsec * 1e-9;
+#endif
+}
+
+#if defined(USE_PERF_EVENTS)
+static int
+perf_event_open(struct perf_event_attr *attr, int group_fd)
+{
+	// calling thread only, any cpu
+	return (int) syscall(__NR_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+#endif
+
+bool
+PhaseCounters::Open(void)
+{
+#if defined(USE_PERF_EVENTS)
+	static const unsigned long long config[EVENT_COUNT] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+	int leader = -1;
+	for (int j = 0; j < EVENT_COUNT; j++)
+	{
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = config[j];
+		attr.disabled = (leader < 0) ? 1 : 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+		this->fd[j] = perf_event_open(&attr, leader);
+		if (this->fd[j] < 0)
+		{
+			// not supported by this cpu or not permitted (perf_event_paranoid)
+			this->fd[j] = -1;
+			continue;
+		}
+		if (leader < 0)
+		{
+			leader = this->fd[j];
+		}
+		this->slot[j] = this->slot_count++;
+	}
+	if (leader >= 0)
+	{
+		ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		return true;
+	}
+#endif
+	return false;
+}
+
+void
+PhaseCounters::Close(void)
+{
+#if defined(USE_PERF_EVENTS)
+	for (int j = 0; j < EVENT_COUNT; j++)
+	{
+		if (this->fd[j] >= 0)
+		{
+			close(this->fd[j]);
+		}
+	}
+#endif
+	for (int j = 0; j < EVENT_COUNT; j++)
+	{
+		this->fd[j] = -1;
+		this->slot[j] = -1;
+	}
+	this->slot_count = 0;
+}
+
+bool
+PhaseCounters::Sample(LDBLE *values)
+{
+#if defined(USE_PERF_EVENTS)
+	if (this->slot_count > 0)
+	{
+		int leader = -1;
+		for (int j = 0; j < EVENT_COUNT && leader < 0; j++)
+		{
+			leader = this->fd[j];
+		}
+		// PERF_FORMAT_GROUP: number of events followed by one value per event
+		unsigned long long buffer[1 + EVENT_COUNT];
+		ssize_t n = read(leader, buffer, sizeof(buffer));
+		if (n < (ssize_t) ((1 + this->slot_count) * sizeof(buffer[0])))
+			return false;
+		for (int j = 0; j < EVENT_COUNT; j++)
+		{
+			values[j] = (this->slot[j] >= 0) ? (LDBLE) buffer[1 + this->slot[j]] : 0;
+		}
+		return true;
+	}
+#endif
+	(void) values;
+	return false;
+}
@@ -0,0 +1,94 @@
+#if !defined(PHASECOUNTERS_H_INCLUDED)
+#define PHASECOUNTERS_H_INCLUDED
+#include "phrqtype.h"
+
+/*
+ *   Inclusive counters for the solver phases.  Elapsed time is always
+ *   recorded; on Linux, cycles, instructions, cache misses and branch
+ *   misses are read from perf_event_open when the kernel allows it.
+ *   The hardware counters follow the thread that last called Reset, so
+ *   Reset is called at the start of each run.  Hardware counts that could
+ *   not be opened are reported as -1.
+ */
+class PhaseCounters
+{
+public:
+	enum PHASE
+	{
+		PREP,					// prep
+		MODEL,					// model, model_pz, model_sit
+		K_TEMP,					// k_temp
+		GAMMAS,					// gammas, gammas_pz, gammas_sit
+		BASIC,					// basic_run
+		PHASE_COUNT
+	};
+	enum EVENT
+	{
+		CYCLES,
+		INSTRUCTIONS,
+		CACHE_MISSES,
+		BRANCH_MISSES,
+		EVENT_COUNT
+	};
+	class phase
+	{
+	public:
+		phase(void);
+		int calls;
+		LDBLE time;
+		LDBLE events[EVENT_COUNT];
+	};
+	// counts one phase for the lifetime of the object
+	class Scope
+	{
+	public:
+		Scope(PhaseCounters & c, PHASE p) : counters(c), which(p)
+		{
+			if (counters.on) counters.Start(which);
+		}
+		~Scope(void)
+		{
+			if (counters.on) counters.Stop(which);
+		}
+	protected:
+		PhaseCounters & counters;
+		PHASE which;
+	};
+
+	PhaseCounters(void);
+	~PhaseCounters(void);
+
+	bool Get_on(void)const { return this->on; }
+	void Set_on(bool tf);
+	bool Get_hardware(void)const;
+	const phase & Get_phase(int i)const { return this->phases[i]; }
+	void Reset(void);
+	void Start(PHASE p);
+	void Stop(PHASE p);
+	// seconds from a monotonic clock
+	static LDBLE Wall_time(void);
+
+protected:
+	bool Open(void);
+	void Close(void);
+	bool Sample(LDBLE *values);
+
+protected:
+	bool on;
+	phase phases[PHASE_COUNT];
+	int depth[PHASE_COUNT];
+	LDBLE start_time[PHASE_COUNT];
+	LDBLE start_events[PHASE_COUNT][EVENT_COUNT];
+	// perf_event_open file descriptors; -1 if the event is not available
+	int fd[EVENT_COUNT];
+	// position of each event in a group read; -1 if not in the group
+	int slot[EVENT_COUNT];
+	int slot_count;
+
+private:
+	// file descriptors are not shared between instances
+	PhaseCounters(const PhaseCounters &);
+	PhaseCounters & operator=(const PhaseCounters &);
+};
+
+#endif // !defined(PHASECOUNTERS_H_INCLUDED)
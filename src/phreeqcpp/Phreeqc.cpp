@@ -684,6 +684,7 @@ void Phreeqc::init(void)
 	s_co3					= NULL;
 	s_h2					= NULL;
 	s_o2					= NULL;
+	scope_valid				= false;
 	/*----------------------------------------------------------------------
 	*   Phases
 	*---------------------------------------------------------------------- */
@@ -861,6 +862,7 @@ void Phreeqc::init(void)
 	pp_scale				= 1.0;
 	pp_column_scale			= 1.0;
 	diagonal_scale			= FALSE;
+	line_search				= FALSE;
 	mass_water_switch		= FALSE;
 	delay_mass_water		= FALSE;
 	equi_delay      		= 0;
@@ -941,6 +943,11 @@ void Phreeqc::init(void)
 	B1TT                    = 0;
 	B2TT                    = 0;
 #endif
+	/* tidy.cpp ------------------------------- */
+	tidy_count_s            = 0;
+	tidy_count_phases       = 0;
+	tidy_count_master       = 0;
+	tidy_count_elements     = 0;
 	/* gases.cpp ------------------------------- */
 	a_aa_sum                = 0;
 	b2                      = 0;
@@ -1026,6 +1033,13 @@ void Phreeqc::init(void)
 	cvode_pp_assemblage_save= NULL;
 	cvode_ss_assemblage_save= NULL;
 	set_and_run_attempt     = 0;
+	cell_cost_depth         = 0;
+	capture_iterations      = 0;
+	capture_time            = 0;
+	capture_max             = 100;
+	capture_count           = 0;
+	capture_prefix          = "slow_cell";
+	database_hash           = "";
 	/* model.cpp ------------------------------- */
 	gas_in                  = FALSE;
 	min_value               = 1e-10;
@@ -1139,6 +1153,22 @@ void Phreeqc::init(void)
 	heat_mix_f_m            = 0;
 	warn_MCD_X              = 0;
 	warn_fixed_Surf         = 0;
+	tk_x2                   = 0;
+	dV_dcell                = 0;
+	find_current            = 0;
+	Ct2                     = NULL;
+	l_tk_x2                 = NULL;
+	A                       = NULL;
+	LU                      = NULL;
+	mixf                    = NULL;
+	mixf_stag               = NULL;
+	mixf_comp_size          = 0;
+	current_cells           = NULL;
+	sum_R                   = 0;
+	sum_Rd                  = 0;
+	ct                      = NULL;
+	moles_added             = NULL;
+	count_moles_added       = 0;
 	/* utilities.cpp ------------------------------- */
 	spinner                 = 0;
 	// keycount;
@@ -1600,6 +1630,7 @@ Phreeqc::InternalCopy(const Phreeqc* pSrc)
 	pp_scale = pSrc->pp_scale;
 	pp_column_scale = pSrc->pp_column_scale;
 	diagonal_scale = pSrc->diagonal_scale;
+	line_search = pSrc->line_search;
 	mass_water_switch = pSrc->mass_water_switch;
 	delay_mass_water = pSrc->delay_mass_water;
 	equi_delay = pSrc->equi_delay;
@@ -1845,6 +1876,17 @@ Phreeqc::InternalCopy(const Phreeqc* pSrc)
 	cvode_ss_assemblage_save = NULL;
 	//std::vector<double> m_temp, m_original, rk_moles, x0_moles;
 	set_and_run_attempt = 0;
+	cell_costs = pSrc->cell_costs;
+	cell_cost_depth = 0;
+	capture_iterations = pSrc->capture_iterations;
+	capture_time = pSrc->capture_time;
+	capture_max = pSrc->capture_max;
+	capture_count = 0;
+	capture_prefix = pSrc->capture_prefix;
+	database_hash = pSrc->database_hash;
+	phase_counters.Set_on(pSrc->phase_counters.Get_on());
+	loop_threads.Set_threads(pSrc->loop_threads.Get_threads());
+	loop_threads.Set_threshold(pSrc->loop_threads.Get_threshold());
 	/* model.cpp ------------------------------- */
 	gas_in = FALSE;
 	min_value = 1e-10;
@@ -1994,6 +2036,23 @@ Phreeqc::InternalCopy(const Phreeqc* pSrc)
 	current_x = pSrc->current_x;
 	current_A = pSrc->current_A;
 	fix_current = pSrc->fix_current;
+	// work space of a transport calculation is not copied
+	tk_x2 = 0;
+	dV_dcell = 0;
+	find_current = 0;
+	Ct2 = NULL;
+	l_tk_x2 = NULL;
+	A = NULL;
+	LU = NULL;
+	mixf = NULL;
+	mixf_stag = NULL;
+	mixf_comp_size = 0;
+	current_cells = NULL;
+	sum_R = 0;
+	sum_Rd = 0;
+	ct = NULL;
+	moles_added = NULL;
+	count_moles_added = 0;
 
 	/* utilities.cpp ------------------------------- */
 	//spinner                 = 0;
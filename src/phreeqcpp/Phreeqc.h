@@ -47,6 +47,8 @@ typedef unsigned char boolean;
 #include "cxxMix.h"
 #include "Use.h"
 #include "Surface.h"
+#include "PhaseCounters.h"
+#include "LoopThreads.h"
 #ifdef SWIG_SHARED_OBJ
 #include "thread.h"
 #endif
@@ -351,6 +353,9 @@ public:
 	// isotopes.cpp -------------------------------
 	int add_isotopes(cxxSolution& solution_ptr);
 	int calculate_values(void);
+	LDBLE calculate_value_get(class calculate_value* calculate_value_ptr);
+	int isotope_ratio_calculate(class isotope_ratio* isotope_ratio_ptr);
+	int isotope_alpha_calculate(class isotope_alpha* isotope_alpha_ptr);
 	int calculate_isotope_moles(class element* elt_ptr,
 		cxxSolution* solution_ptr, LDBLE total_moles);
 	LDBLE convert_isotope(class master_isotope* master_isotope_ptr, LDBLE ratio);
@@ -397,6 +402,11 @@ public:
 		LDBLE step_fraction);
 	int set_and_run_wrapper(int i, int use_mix, int use_kinetics, int nsaver,
 		LDBLE step_fraction);
+	void cell_costs_reset(int count);
+	class cell_cost* cell_cost_ptr(int i);
+	std::string slow_cell_input(int use_kinetics, LDBLE step_fraction);
+	void slow_cell_capture(int i, const std::string& input, int l_iterations,
+		int retries, LDBLE seconds);
 	int set_advection(int i, int use_mix, int use_kinetics, int nsaver);
 	int free_cvode(void);
 public:
@@ -408,6 +418,7 @@ public:
 		N_Vector vtemp1, N_Vector vtemp2, N_Vector vtemp3);
 
 	int calc_final_kinetic_reaction(cxxKinetics* kinetics_ptr);
+	const class kinetics_stoichiometry& kinetics_stoichiometry_get(cxxKinetics* kinetics_ptr);
 	int calc_kinetic_reaction(cxxKinetics* kinetics_ptr,
 		LDBLE time_step);
 	bool limit_rates(cxxKinetics* kinetics_ptr);
@@ -447,14 +458,19 @@ public:
 	int check_residuals(void);
 	int free_model_allocs(void);
 	int ineq(int kode);
+	bool line_search_ok(void);
+	void line_search_save(int count_basis_change);
+	bool line_search_step(int count_basis_change);
 	int model(void);
 	int jacobian_sums(void);
 	int mb_gases(void);
 	int mb_ss(void);
 	int mb_sums(void);
 	int molalities(int allow_overflow);
+	void molalities_species(int first, int last);
 	int reset(void);
 	int residuals(void);
+	LDBLE residual_merit(void);
 	int set(int initial);
 	int sum_species(void);
 	int surface_model(void);
@@ -476,6 +492,7 @@ public:
 	int calc_ss_fractions(void);
 	int gammas(LDBLE mu);
 	int gammas_a_f(int i);
+	void gammas_species(const class gammas_constants &c, int first, int last);
 	int initial_guesses(void);
 	int revise_guesses(void);
 	int ss_binary(cxxSS* ss_ptr);
@@ -556,6 +573,12 @@ public:
 	LDBLE calc_lk_phase(phase* p_ptr, LDBLE TK, LDBLE pa);
 	LDBLE calc_PR(std::vector<class phase*> phase_ptrs, LDBLE P, LDBLE TK, LDBLE V_m);
 	LDBLE calc_PR();
+	bool calc_PR_parameters(class phase* phase_ptr, LDBLE TK);
+	void calc_PR_mix(const std::vector<class phase*>& phase_ptrs);
+	LDBLE calc_PR_P(LDBLE V_m);
+	LDBLE calc_PR_V_m(LDBLE P);
+	void calc_PR_phi(class phase* phase_ptr, LDBLE P, LDBLE V_m);
+	static LDBLE pr_binary_factor(const char* name, const char* name1);
 	int calc_vm(LDBLE tc, LDBLE pa);
 	LDBLE calc_vm0(const char *species_name, LDBLE tc, LDBLE pa, LDBLE mu);
 	int clear(void);
@@ -567,9 +590,12 @@ public:
 	int mb_for_species_aq(int n);
 	int mb_for_species_ex(int n);
 	int mb_for_species_surf(int n);
+	int model_scope(void);
+	bool rxn_in_scope(CReaction& rxn_ref);
 	int quick_setup(void);
 	int resetup_master(void);
 	int save_model(void);
+	void set_master_rewrite(void);
 	int setup_exchange(void);
 	int setup_gas_phase(void);
 	int setup_fixed_volume_gas(void);
@@ -804,6 +830,7 @@ public:
 	int add_mix(cxxMix* mix_ptr);
 	int add_pp_assemblage(cxxPPassemblage* pp_assemblage_ptr);
 	int add_reaction(cxxReaction* reaction_ptr, int step_number, LDBLE step_fraction);
+	LDBLE reaction_step_moles(cxxReaction* reaction_ptr, int step_number);
 	int add_ss_assemblage(cxxSSassemblage* ss_assemblage_ptr);
 	int add_solution(cxxSolution* solution_ptr, LDBLE extensive,
 		LDBLE intensive);
@@ -955,12 +982,15 @@ public:
 	LDBLE halve(LDBLE f(LDBLE x, void*), LDBLE x0, LDBLE x1, LDBLE tol);
 	int replace_solids_gases(void);
 	int ss_prep(LDBLE t, cxxSS* ss_ptr, int print);
+	class ss_gap* ss_gap_find(LDBLE t, cxxSS* ss_ptr);
+	void ss_gap_store(LDBLE t, cxxSS* ss_ptr, LDBLE xsm1, LDBLE xsm2, LDBLE xc1, LDBLE xc2);
 	int select_log_k_expression(LDBLE* source_k, LDBLE* target_k);
 	int slnq(int n, LDBLE* a, LDBLE* delta, int ncols, int print);
 public:
 	int tidy_punch(void);
 	int tidy_model(void);
 	int check_species_input(void);
+	bool model_keywords_read(bool species_and_phases);
 	LDBLE coef_in_master(class master* master_ptr);
 	int reset_last_model(void);
 	int rewrite_eqn_to_primary(void);
@@ -982,11 +1012,12 @@ public:
 	int tidy_master_isotope(void);
 	int tidy_min_surface(void);
 	int update_min_surface(void);
-	int tidy_phases(void);
+	bool tidy_affected(std::vector<bool>& s_affected, std::vector<bool>& phases_affected);
+	int tidy_phases(const std::vector<bool>* affected);
 	int tidy_pp_assemblage(void);
 	int tidy_solutions(void);
 	int tidy_ss_assemblage(void);
-	int tidy_species(void);
+	int tidy_species(const std::vector<bool>* affected);
 	int tidy_surface(void);
 	int scan(LDBLE f(LDBLE x, void*), LDBLE* xx0, LDBLE* xx1);
 	static LDBLE f_spinodal(LDBLE x, void*);
@@ -1396,6 +1427,10 @@ protected:
 	std::vector<class species*> s;
 	std::vector< std::map < std::string, cxxSpeciesDL > > s_diff_layer;
 	std::vector<class species*> s_x;
+	// element scope of the model, see model_scope
+	bool scope_valid;
+	std::vector<bool> scope_elements;	// indexed by number of primary master
+	std::vector<int> scope_s, scope_phases;	// candidate indices into s and phases
 
 	class species* s_h2o;
 	class species* s_hplus;
@@ -1409,11 +1444,13 @@ protected:
 	*   Phases
 	*---------------------------------------------------------------------- */
 	std::vector<class phase*> phases;
+	std::vector<class phase*> phases_x;	// phases in the model, in order of phases
 
 	/*----------------------------------------------------------------------
 	*   Master species
 	*---------------------------------------------------------------------- */
 	std::vector<class master*> master;
+	std::vector<class master*> master_rewrite;	// masters with in == REWRITE
 
 	/*----------------------------------------------------------------------
 	*   Unknowns
@@ -1555,6 +1592,7 @@ protected:
 	LDBLE pp_scale;
 	LDBLE pp_column_scale;
 	int diagonal_scale;	/* 0 not used, 1 used */
+	int line_search;	/* 0 not used, 1 used */
 	int mass_water_switch;
 	int delay_mass_water;
 	int equi_delay;
@@ -1672,8 +1710,17 @@ protected:
 
 	/* cl1.cpp ------------------------------- */
 	std::vector<double> x_arg, res_arg, scratch;
+	/* tidy.cpp ------------------------------- */
+	// species and phases replaced since the last tidy_model, see tidy_affected
+	std::set<class species*> tidy_changed_species;
+	std::set<class phase*> tidy_changed_phases;
+	// sizes of s, phases, master and elements after the last tidy_species
+	size_t tidy_count_s, tidy_count_phases, tidy_count_master, tidy_count_elements;
 	/* gases.cpp ------------------------------- */
 	LDBLE a_aa_sum, b2, b_sum, R_TK;
+	std::vector<class pr_mixing> pr_mixings;
+	std::vector<class phase *> pr_phase_ptrs;
+	std::vector<LDBLE> pr_fractions;
 
 	/* input.cpp ------------------------------- */
 	int check_line_return;
@@ -1682,6 +1729,7 @@ protected:
 	/* integrate.cpp ------------------------------- */
 	LDBLE midpoint_sv;
 	LDBLE z_global, xd_global, alpha_global;
+	std::vector<std::pair<LDBLE, LDBLE> > g_function_moles;	/* charge, moles of aqueous species */
 
 	/* inverse.cpp ------------------------------- */
 	size_t max_row_count, max_column_count;
@@ -1733,9 +1781,23 @@ public:
 protected:
 	std::vector<double> m_temp, m_original, rk_moles, x0_moles;
 	int set_and_run_attempt;
+	std::vector<class cell_cost> cell_costs;
+	int cell_cost_depth;
+	int capture_iterations;
+	LDBLE capture_time;
+	int capture_max, capture_count;
+	std::string capture_prefix;
+	std::string database_hash;
+	PhaseCounters phase_counters;
+	LoopThreads loop_threads;
+	class run_statistics run_stats;
+	class kinetics_stoichiometry kinetics_stoich;
+	std::vector<LDBLE> kinetics_stoich_column, kinetics_stoich_totals;
+	std::vector<bool> kinetics_stoich_present, kinetics_stoich_totals_present;
 
 	/* model.cpp ------------------------------- */
 	int gas_in;
+	class newton_step newton_step_save;
 	LDBLE min_value;
 	std::vector<double> normal, ineq_array, res, cu, zero, delta1;
 	std::vector<int> iu, is, back_eq;
@@ -1799,6 +1861,8 @@ protected:
 
 	/* tidy.cpp ------------------------------- */
 	LDBLE a0, a1, kc, kb;
+	// gaps by solid-solution name and temperature, kelvin
+	std::map<std::string, std::map<LDBLE, class ss_gap> > ss_gap_cache;
 
 	/* tally.cpp ------------------------------- */
 	class tally_buffer* t_buffer;
@@ -1825,6 +1889,22 @@ protected:
 	LDBLE heat_mix_f_imm, heat_mix_f_m;
 	int warn_MCD_X, warn_fixed_Surf;
 	LDBLE current_x, current_A, fix_current; // current: coulomb / s, Ampere, fixed current (Ampere)
+	LDBLE tk_x2; // average tk_x of icell and jcell
+	LDBLE dV_dcell; // difference in Volt among icell and jcell
+	int find_current;
+	// implicit...
+	std::set <std::string> dif_spec_names;
+	std::set <std::string> dif_els_names;
+	std::map<int, std::map<std::string, double> > neg_moles;
+	std::map<std::string, double> els;
+	double *Ct2, *l_tk_x2, **A, **LU, **mixf, **mixf_stag;
+	int mixf_comp_size;
+	struct CURRENT_CELLS *current_cells;
+	LDBLE sum_R, sum_Rd; // sum of R, sum of (current_cells[0].dif - current_cells[i].dif) * R
+	struct CT *ct;
+	std::map<int, std::map<std::string, J_ij_save> > cell_J_ij;
+	struct MOLES_ADDED *moles_added;
+	int count_moles_added;
 
 	/* utilities.cpp ------------------------------- */
 	int spinner;
@@ -1841,6 +1921,7 @@ protected:
 	friend class TestIPhreeqc;
 	friend class TestSelectedOutput;
 	friend class IPhreeqcMMS;
+	friend class IPhreeqcPool;
 	friend class IPhreeqcPhast;
 	friend class PhreeqcRM;
 
@@ -47,6 +47,7 @@ SelectedOutput::SelectedOutput(int n, PHRQ_io *io)
 	this->charge_balance   = false;
 	this->percent_error    = false;
 	this->new_line         = true;
+	this->cell_cost        = false;
 
 	// as-is set flags
 	//
@@ -72,6 +73,7 @@ SelectedOutput::SelectedOutput(int n, PHRQ_io *io)
 	this->set_charge_balance = false;
 	this->set_percent_error  = false;
 	this->set_new_line       = false;
+	this->set_cell_cost      = false;
 }
 
 SelectedOutput::~SelectedOutput(void)
@@ -113,3 +115,23 @@ SelectedOutput::Set_file_name(int n)
 	os << "selected_output_" << n << ".sel";
 	file_name = os.str();
 }
+
+const std::vector< std::string > &
+SelectedOutput::Get_headings(const std::vector< std::pair< std::string, void * > > & list,
+	const char *prefix, const char *suffix)
+{
+	// the names are made once per definition, not for every punched row
+	std::string key(prefix);
+	key.append("%s");
+	key.append(suffix);
+	std::vector< std::string > & names = this->headings[key];
+	if (names.size() != list.size())
+	{
+		names.clear();
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			names.push_back(std::string(prefix) + list[i].first + suffix);
+		}
+	}
+	return names;
+}
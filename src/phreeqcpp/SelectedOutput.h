@@ -37,6 +37,10 @@ public:
 	inline const std::vector< std::pair< std::string, void * > > & Get_isotopes(void)const         {return this->isotopes;}
 	inline const std::vector< std::pair< std::string, void * > > & Get_calculate_values(void)const {return this->calculate_values;}
 
+	// column names punched for a list, prefix + name + suffix
+	const std::vector< std::string > & Get_headings(const std::vector< std::pair< std::string, void * > > & list,
+		const char *prefix, const char *suffix = "");
+
 	// file_name getters/setters
 	void Set_file_name(int i);
 	inline void Set_file_name(std::string s)                          {this->file_name = s;}
@@ -83,6 +87,7 @@ public:
 	inline bool Get_charge_balance(void)const                         {return this->charge_balance;}
 	inline bool Get_percent_error(void)const                          {return this->percent_error;}
 	inline bool Get_new_line(void)const                               {return this->new_line; }
+	inline bool Get_cell_cost(void)const                              {return this->cell_cost;}
 
 	// as-is setters
 	inline void Set_user_punch(bool tf)                               {this->user_punch = tf;              this->set_user_punch = true;}
@@ -107,6 +112,7 @@ public:
 	inline void Set_charge_balance(bool tf)                           {this->charge_balance = tf;          this->set_charge_balance = true;}
 	inline void Set_percent_error(bool tf)                            {this->percent_error = tf;           this->set_percent_error = true;}
 	inline void Set_new_line(bool tf)                                 {this->new_line = tf;                this->set_new_line = true;}
+	inline void Set_cell_cost(bool tf)                                {this->cell_cost = tf;               this->set_cell_cost = true;}
 
 	// set flag getters
 	inline bool was_set_user_punch()const                             {return this->set_user_punch;}
@@ -131,6 +137,7 @@ public:
 	inline bool was_set_charge_balance()const                         {return this->set_charge_balance;}
 	inline bool was_set_percent_error()const                          {return this->set_percent_error;}
 	inline bool was_set_new_line()const                               {return this->set_new_line;}
+	inline bool was_set_cell_cost()const                              {return this->set_cell_cost;}
 
 protected:
 
@@ -146,6 +153,9 @@ protected:
 	std::vector< std::pair< std::string, void * > > isotopes;
 	std::vector< std::pair< std::string, void * > > calculate_values;
 
+	// column names by prefix%ssuffix, see Get_headings
+	std::map< std::string, std::vector< std::string > > headings;
+
 	// file_name
 	std::string file_name;
 
@@ -181,6 +191,7 @@ protected:
 	bool charge_balance;
 	bool percent_error;
 	bool new_line;
+	bool cell_cost;
 
 	// as-is set flags
 	bool set_user_punch;
@@ -205,5 +216,6 @@ protected:
 	bool set_charge_balance;
 	bool set_percent_error;
 	bool set_new_line;
+	bool set_cell_cost;
 };
 #endif // !defined(SELECTEDOUTPUT_H_INCLUDED)
@@ -573,14 +573,39 @@ cxxSurface::totalize()
 	return;
 }
 void
-cxxSurface::add(const cxxSurface & addee_in, LDBLE extensive)
+cxxSurface::add(const cxxSurface & addee, LDBLE extensive)
 		//
 		// Add surface to "this" surface
 		//
 {
-	cxxSurface addee = addee_in;
+	this->add(addee, extensive, (const std::string *) NULL);
+}
+
+void
+cxxSurface::add(const cxxSurface & addee, LDBLE extensive, const std::string & charge_name)
+		//
+		// Add the comps and the charge of charge_name to "this" surface
+		//
+{
+	this->add(addee, extensive, &charge_name);
+}
+
+void
+cxxSurface::add(const cxxSurface & addee_in, LDBLE extensive, const std::string * charge_name)
+		//
+		// charge_name == NULL adds all comps and charges
+		//
+{
 	if (extensive == 0.0)
 		return;
+	if (&addee_in == this)
+	{
+		// comps may be appended to this->surface_comps while reading addee
+		cxxSurface addee_copy(addee_in);
+		this->add(addee_copy, extensive, charge_name);
+		return;
+	}
+	const cxxSurface & addee = addee_in;
 	if (this->surface_comps.size() == 0)
 	{
 		this->only_counter_ions = addee.only_counter_ions;
@@ -600,6 +625,8 @@ cxxSurface::add(const cxxSurface & addee_in, LDBLE extensive)
 	for (size_t i_add = 0; i_add < addee.Get_surface_comps().size(); i_add++)
 	{
 		const cxxSurfaceComp & comp_add_ptr = addee.Get_surface_comps()[i_add];
+		if (charge_name != NULL && comp_add_ptr.Get_charge_name() != *charge_name)
+			continue;
 		size_t i_this;
 		for (i_this = 0; i_this < this->surface_comps.size(); i_this++)
 		{
@@ -618,9 +645,11 @@ cxxSurface::add(const cxxSurface & addee_in, LDBLE extensive)
 			this->surface_comps.push_back(entity);
 		}
 	}
-	for (size_t i_add = 0; i_add < addee.Get_surface_charges().size(); i_add++)
+	for (size_t i_add = 0; i_add < addee.surface_charges.size(); i_add++)
 	{
-		const cxxSurfaceCharge & charge_add_ptr = addee.Get_surface_charges()[i_add];
+		const cxxSurfaceCharge & charge_add_ptr = addee.surface_charges[i_add];
+		if (charge_name != NULL && charge_add_ptr.Get_name() != *charge_name)
+			continue;
 
 		size_t i_this;
 		for (i_this = 0; i_this < this->surface_charges.size(); i_this++)
@@ -694,34 +723,39 @@ Find_charge(std::string str)const
 void cxxSurface::
 Sort_comps(void)
 {
-	// sort comps
+	// sort comps, the last of equal formulas is kept;
+	// each comp and charge is copied once
 	{
-		std::map<std::string, cxxSurfaceComp> comp_map;
+		std::map<std::string, size_t> comp_map;
 		for (size_t i = 0; i < this->surface_comps.size(); i++)
 		{
-			comp_map[this->surface_comps[i].Get_formula()] = this->surface_comps[i];
+			comp_map[this->surface_comps[i].Get_formula()] = i;
 		}
-		this->surface_comps.clear();
-		std::map<std::string, cxxSurfaceComp>::iterator it;
+		std::vector<cxxSurfaceComp> sorted;
+		sorted.reserve(comp_map.size());
+		std::map<std::string, size_t>::iterator it;
 		for (it = comp_map.begin(); it != comp_map.end(); it++)
 		{
-			this->surface_comps.push_back(it->second);
+			sorted.push_back(this->surface_comps[it->second]);
 		}
+		this->surface_comps.swap(sorted);
 	}
 
 	// sort charge too
 	{
-		std::map<std::string, cxxSurfaceCharge> charge_map;
+		std::map<std::string, size_t> charge_map;
 		for (size_t i = 0; i < this->surface_charges.size(); i++)
 		{
-			charge_map[this->surface_charges[i].Get_name()] = this->surface_charges[i];
+			charge_map[this->surface_charges[i].Get_name()] = i;
 		}
-		this->surface_charges.clear();
-		std::map<std::string, cxxSurfaceCharge>::iterator it;
+		std::vector<cxxSurfaceCharge> sorted;
+		sorted.reserve(charge_map.size());
+		std::map<std::string, size_t>::iterator it;
 		for (it = charge_map.begin(); it != charge_map.end(); it++)
 		{
-			this->surface_charges.push_back(it->second);
+			sorted.push_back(this->surface_charges[it->second]);
 		}
+		this->surface_charges.swap(sorted);
 	}
 }
 /* ---------------------------------------------------------------------- */
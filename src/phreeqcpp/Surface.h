@@ -40,6 +40,7 @@ public:
 	void Sort_comps();
 
 	void add(const cxxSurface & addee, LDBLE extensive);
+	void add(const cxxSurface & addee, LDBLE extensive, const std::string & charge_name);
 	void multiply(LDBLE extensive);
 
 	std::vector < cxxSurfaceComp > & Get_surface_comps() {return this->surface_comps;}
@@ -83,6 +84,9 @@ public:
 	void Serialize(Dictionary & dictionary, std::vector < int >&ints, std::vector < double >&doubles);
 	void Deserialize(Dictionary & dictionary, std::vector < int >&ints, std::vector < double >&doubles, int &ii, int &dd);
 	
+protected:
+	void add(const cxxSurface & addee, LDBLE extensive, const std::string * charge_name);
+
 protected:
 	std::vector < cxxSurfaceComp > surface_comps;
 	std::vector < cxxSurfaceCharge > surface_charges;
@@ -135,8 +135,7 @@ cxxSurfaceCharge::dump_raw(std::ostream & s_oss, unsigned int indent) const
 	{
 		s_oss << indent0 << "-g_map                   " << git->first << "\t";
 		s_oss << git->second.Get_g() << "\t";
-		s_oss << git->second.Get_dg() << "\t";
-		s_oss << git->second.Get_psi_to_z() << "\n";
+		s_oss << git->second.Get_dg() << "\n";
 	}
 }
 
@@ -342,10 +341,6 @@ cxxSurfaceCharge::read_raw(CParser & parser, bool check)
 					break;
 				else
 					git->second.Set_dg(dummy);
-				if (!(parser.get_iss() >> dummy))
-					break;
-				else
-					git->second.Set_psi_to_z(dummy);
 			}
 			break;
 		case 16:				// dl_species_map
@@ -581,7 +576,6 @@ cxxSurfDL::Serialize(Dictionary & dictionary, std::vector < int >&ints,
 {
 	doubles.push_back(this->g);
 	doubles.push_back(this->dg);
-	doubles.push_back(this->psi_to_z);
 }
 
 void
@@ -590,7 +584,6 @@ cxxSurfDL::Deserialize(Dictionary & dictionary, std::vector < int >&ints,
 {
 	this->g = doubles[dd++];
 	this->dg = doubles[dd++];
-	this->psi_to_z = doubles[dd++];
 }
 const std::vector< std::string >::value_type temp_vopts[] = {
 	std::vector< std::string >::value_type("name"),	                // 0 
@@ -45,21 +45,18 @@ class cxxSurfDL
 public:
 	cxxSurfDL()
 	{
-		g = dg = psi_to_z = 0;
+		g = dg = 0;
 	}
 	LDBLE Get_g(void) const {return g;}
 	void Set_g(LDBLE t) {g = t;}
 	LDBLE Get_dg(void) const {return dg;}
 	void Set_dg(LDBLE t) {dg = t;}
-	LDBLE Get_psi_to_z(void) const {return psi_to_z;}
-	void Set_psi_to_z(LDBLE t) {psi_to_z = t;}
 	void Serialize(Dictionary & dictionary, std::vector < int >&ints, std::vector < double >&doubles);
 	void Deserialize(Dictionary & dictionary, std::vector < int >&ints, std::vector < double >&doubles, int &ii, int &dd);
 	
 protected:
 	LDBLE g;
 	LDBLE dg;
-	LDBLE psi_to_z;
 };
 class cxxSurfaceCharge: public PHRQ_base
 {
@@ -24,6 +24,7 @@ advection(void)
  *   Calculate advection
  */
 	state = ADVECTION;
+	cell_costs_reset(count_ad_cells + 1);
 /*	mass_water_switch = TRUE; */
 /*
  *   Check existence of all solutions
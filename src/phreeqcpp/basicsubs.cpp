@@ -1571,45 +1571,7 @@ get_calculate_value(const char* name)
 		return (MISSING);
 	}
 
-	char l_command[] = "run";
-	PBasic interp(this, this->phrq_io);
-	if (calculate_value_ptr->new_def == TRUE)
-	{
-		if (interp.basic_compile
-		(calculate_value_ptr->commands.c_str(),
-			&calculate_value_ptr->linebase,
-			&calculate_value_ptr->varbase,
-			&calculate_value_ptr->loopbase) != 0)
-		{
-			error_string = sformatf(
-				"Fatal Basic error in CALCULATE_VALUES %s.",
-				calculate_value_ptr->name);
-			error_msg(error_string, STOP);
-		}
-		calculate_value_ptr->new_def = FALSE;
-	}
-
-	if (interp.basic_run(l_command,
-		calculate_value_ptr->linebase,
-		calculate_value_ptr->varbase,
-		calculate_value_ptr->loopbase) != 0)
-	{
-		error_string = sformatf("Fatal Basic error in calculate_value %s.",
-			calculate_value_ptr->name);
-		error_msg(error_string, STOP);
-	}
-	if (std::isnan(rate_moles))
-	{
-		error_string = sformatf("Calculated value not SAVEed for %s.",
-			calculate_value_ptr->name);
-		error_msg(error_string, STOP);
-	}
-	else
-	{
-		calculate_value_ptr->calculated = TRUE;
-		calculate_value_ptr->value = rate_moles;
-	}
-	return (calculate_value_ptr->value);
+	return (calculate_value_get(calculate_value_ptr));
 }
 /* ---------------------------------------------------------------------- */
 LDBLE Phreeqc::
@@ -3239,21 +3201,21 @@ system_total_si(void)
 	char name[MAX_LENGTH];
 
 	sys_tot = -999.9;
-	for (i = 0; i < (int)phases.size(); i++)
+	for (i = 0; i < (int)phases_x.size(); i++)
 	{
-		if (phases[i]->in == FALSE || phases[i]->type != SOLID)
+		if (phases_x[i]->in == FALSE || phases_x[i]->type != SOLID)
 			continue;
 		/*
 		 *   Print saturation index
 		 */
 		iap = 0.0;
-		for (rxn_ptr = &phases[i]->rxn_x.token[0] + 1; rxn_ptr->s != NULL;
+		for (rxn_ptr = &phases_x[i]->rxn_x.token[0] + 1; rxn_ptr->s != NULL;
 			rxn_ptr++)
 		{
 			iap += rxn_ptr->s->la * rxn_ptr->coef;
 		}
-		si = -phases[i]->lk + iap;
-		Utilities::strcpy_safe(name, MAX_LENGTH, phases[i]->name);
+		si = -phases_x[i]->lk + iap;
+		Utilities::strcpy_safe(name, MAX_LENGTH, phases_x[i]->name);
 		size_t count_sys = sys.size();
 		sys.resize(count_sys + 1);
 		sys[count_sys].name = string_duplicate(name);
@@ -4136,10 +4098,11 @@ iso_value(const char *total_name)
 	while (replace(" ","_",my_total_name));
 	for (j = 0; j < (int)isotope_ratio.size(); j++)
 	{
-		if (isotope_ratio[j]->ratio == MISSING)
-			continue;
 		if (strcmp(my_total_name, isotope_ratio[j]->name) != 0)
 			continue;
+		isotope_ratio_calculate(isotope_ratio[j]);
+		if (isotope_ratio[j]->ratio == MISSING)
+			continue;
 		return (isotope_ratio[j]->converted_ratio);
 	}
 	Utilities::strcpy_safe(my_total_name, MAX_LENGTH, total_name);
@@ -4150,10 +4113,11 @@ iso_value(const char *total_name)
 	Utilities::strcat_safe(token, MAX_LENGTH, ")");
 	for (j = 0; j < (int)isotope_ratio.size(); j++)
 	{
-		if (isotope_ratio[j]->ratio == MISSING)
-			continue;
 		if (strcmp(token, isotope_ratio[j]->name) != 0)
 			continue;
+		isotope_ratio_calculate(isotope_ratio[j]);
+		if (isotope_ratio[j]->ratio == MISSING)
+			continue;
 		return (isotope_ratio[j]->converted_ratio);
 	}
 	return -1000.;
@@ -4172,10 +4136,11 @@ iso_unit(const char *total_name)
 	Utilities::strcpy_safe(unit, MAX_LENGTH, "unknown");
 	for (j = 0; j < (int)isotope_ratio.size(); j++)
 	{
-		if (isotope_ratio[j]->ratio == MISSING)
-			continue;
 		if (strcmp(my_total_name, isotope_ratio[j]->name) != 0)
 			continue;
+		isotope_ratio_calculate(isotope_ratio[j]);
+		if (isotope_ratio[j]->ratio == MISSING)
+			continue;
 		master_isotope_ptr = master_isotope_search(isotope_ratio[j]->isotope_name);
 		if (master_isotope_ptr != NULL)
 		{
@@ -4191,10 +4156,11 @@ iso_unit(const char *total_name)
 	Utilities::strcat_safe(token, MAX_LENGTH, ")");
 	for (j = 0; j < (int)isotope_ratio.size(); j++)
 	{
-		if (isotope_ratio[j]->ratio == MISSING)
-			continue;
 		if (strcmp(token, isotope_ratio[j]->name) != 0)
 			continue;
+		isotope_ratio_calculate(isotope_ratio[j]);
+		if (isotope_ratio[j]->ratio == MISSING)
+			continue;
 		master_isotope_ptr = master_isotope_search(isotope_ratio[j]->isotope_name);
 		if (master_isotope_ptr != NULL)
 		{
@@ -4214,6 +4180,7 @@ basic_compile(const char *commands, void **lnbase, void **vbase, void **lpbase)
 int Phreeqc::
 basic_run(char *commands, void *lnbase, void *vbase, void *lpbase)
 {
+	PhaseCounters::Scope basic_scope(phase_counters, PhaseCounters::BASIC);
 	return this->basic_interpreter->basic_run(commands, lnbase, vbase, lpbase);
 }
 
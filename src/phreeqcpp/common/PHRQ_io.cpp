@@ -47,6 +47,7 @@ PHRQ_io(void)
 	m_next_keyword = Keywords::KEY_NONE;
 	accumulate = false;
 	m_line_type = PHRQ_io::LT_EMPTY;
+	base_getc = false;
 }
 
 PHRQ_io::
@@ -413,6 +414,7 @@ dump_msg(const char * str)
 int PHRQ_io::
 getc(void)
 {
+	base_getc = true;
 	if (std::istream* is = get_istream())
 	{
 		int n = is->get();
@@ -424,6 +426,43 @@ getc(void)
 	}
 	return EOF;
 }
+/* ---------------------------------------------------------------------- */
+void PHRQ_io::
+append_plain(bool in_comment)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Appends the characters up to the next one get_logical_line has to
+	 *   look at to m_line_save, reading the buffer of a file or string
+	 *   stream directly instead of one istream::get at a time.  Nothing is
+	 *   read past that character, and nothing at all when getc is
+	 *   overridden.
+	 */
+	if (!base_getc || istream_list.size() == 0 || !plain_istream_list.front())
+	{
+		return;
+	}
+	std::streambuf *sb = istream_list.front()->rdbuf();
+	char buffer[256];
+	size_t n = 0;
+	for (;;)
+	{
+		int j = sb->sgetc();
+		if (j == EOF || j == '\n' || j == '\r' ||
+			(!in_comment && (j == '#' || j == ';' || j == '\\')))
+		{
+			break;
+		}
+		buffer[n++] = (char) j;
+		sb->sbumpc();
+		if (n == sizeof(buffer))
+		{
+			m_line_save.append(buffer, n);
+			n = 0;
+		}
+	}
+	m_line_save.append(buffer, n);
+}
 
 /* ---------------------------------------------------------------------- */
 void PHRQ_io::
@@ -656,6 +695,8 @@ push_istream(std::istream * cookie, bool auto_delete)
 {
 	istream_list.push_front(cookie);
 	delete_istream_list.push_front(auto_delete);
+	plain_istream_list.push_front(dynamic_cast<std::ifstream *>(cookie) != NULL ||
+		dynamic_cast<std::istringstream *>(cookie) != NULL);
 }
 void PHRQ_io::
 clear_istream(void)
@@ -676,6 +717,7 @@ pop_istream()
 		}
 		istream_list.pop_front();
 		delete_istream_list.pop_front();
+		plain_istream_list.pop_front();
 	}
 }
 /* ---------------------------------------------------------------------- */
@@ -837,6 +879,7 @@ get_logical_line(void)
 	char c;
 
 	m_line_save.erase(m_line_save.begin(), m_line_save.end());	// m_line_save.clear();
+	base_getc = false;
 	while ((j = getc()) != EOF)
 	{
 		c = (char) j;
@@ -851,8 +894,14 @@ get_logical_line(void)
 					break;
 				}
 				m_line_save += c;
+				append_plain(true);
 			}
 			while ((j = getc()) != EOF);
+			if (j == EOF)
+			{
+				// last character of the comment
+				c = m_line_save[m_line_save.size() - 1];
+			}
 		}
 		if (c == ';')
 			break;
@@ -887,6 +936,7 @@ get_logical_line(void)
 		else
 		{
 			m_line_save += c;
+			append_plain(false);
 		}
 	}
 	if (j == std::char_traits < char >::eof() && m_line_save.size() == 0)
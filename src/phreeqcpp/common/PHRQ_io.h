@@ -188,6 +188,8 @@ protected:
 
 	std::list <std::istream *> istream_list;
 	std::list <bool> delete_istream_list;
+	// file and string streams, whose buffers get_logical_line may read directly
+	std::list <bool> plain_istream_list;
 
 	std::string m_line;
 	std::string m_line_save;
@@ -202,6 +204,9 @@ protected:
 	Keywords::KEYWORDS m_next_keyword;
 	bool accumulate;
 	LINE_TYPE m_line_type;
+	// set by PHRQ_io::getc; false while an override reads the input instead
+	bool base_getc;
+	void append_plain(bool in_comment);
 };
 
 #endif /* _PHRQIO_H */
@@ -330,7 +330,7 @@ LDBLE Phreeqc::
 calc_PR(void)
 /* ---------------------------------------------------------------------- */
 /*  Calculate fugacity and fugacity coefficient for gas pressures if critical T and P
-    are defined.
+    are defined, for the gases of gas_unknowns.
   1) Solve molar volume V_m or total pressure P from Peng-Robinson's EOS:
   P = R * T / (V_m - b) - a * aa / (V_m^2 + 2 * b * V_m - b^2)
      a = 0.457235 * (R * T_c)^2 / P_c
@@ -350,22 +350,18 @@ calc_PR(void)
      a_aa_sum2 = Sum_j(x_j * (a_aa_i * a_aa_j)^0.5
   3) correct the solubility of gas i with:
   pr_si_f = log10(phi_i) -  Delta_V_i * (P - 1) / (2.303 * R * TK);
+
+  The equation of state itself is in calc_PR_parameters, calc_PR_mix,
+  calc_PR_P, calc_PR_V_m and calc_PR_phi, shared with
+  calc_PR(phase_ptrs, P, TK, V_m).
 */
 {
-	LDBLE T_c, P_c;
-	LDBLE A, B, B_r, /*b2,*/ kk, oo, a_aa, T_r;
-	LDBLE m_sum, /*b_sum, a_aa_sum,*/ a_aa_sum2;
-	LDBLE phi;
-	LDBLE /*R_TK,*/ R = R_LITER_ATM; /* L atm / (K mol) */
-	LDBLE r3[4], r3_12, rp, rp3, rq, rz, ri, ri1, one_3 = 0.33333333333333333;
-	LDBLE disct, vinit, v1, ddp, dp_dv, dp_dv2;
-	int it;
+	LDBLE m_sum;
 	class phase *phase_ptr;
 	LDBLE V_m = 0, P = 0;
 
 	LDBLE TK = tk_x;
-	bool halved;
-	R_TK = R * TK;
+	R_TK = R_LITER_ATM * TK;
 	m_sum = b_sum = a_aa_sum = 0.0;
 	size_t i;
 
@@ -375,35 +371,17 @@ calc_PR(void)
 	}
 	cxxGasPhase * gas_phase_ptr = use.Get_gas_phase_ptr();
 	
+	pr_phase_ptrs.clear();
 	for (i = 0; i < gas_unknowns.size(); i++)
 	{
 		m_sum += gas_unknowns[i]->moles;
 		phase_ptr = gas_unknowns[i]->phase;
+		pr_phase_ptrs.push_back(phase_ptr);
 		if (phase_ptr->t_c == 0.0 || phase_ptr->p_c == 0.0)
 			error_msg("Cannot calculate a mixture of ideal and Peng_Robinson gases,\n       please define Tc and Pc for the active gases in PHASES.", STOP);
 			//continue;
-		if (!phase_ptr->pr_a)
-		{
-			T_c = phase_ptr->t_c;
-			P_c = phase_ptr->p_c;
-			phase_ptr->pr_a = 0.457235 * R * R * T_c * T_c / P_c;
-			phase_ptr->pr_b = 0.077796 * R * T_c / P_c;
-			T_r = TK / T_c;
-			oo = phase_ptr->omega;
-			kk = 0.37464 + oo * (1.54226 - 0.26992 * oo);
-			phase_ptr->pr_alpha = pow(1 + kk * (1 - sqrt(T_r)), 2);
-			phase_ptr->pr_tk = TK;
+		if (calc_PR_parameters(phase_ptr, TK))
 			phase_ptr->pr_in = true;
-		}
-		if (phase_ptr->pr_tk != TK)
-		{
-			T_r = TK / phase_ptr->t_c;
-			oo = phase_ptr->omega;
-			kk = 0.37464 + oo * (1.54226 - 0.26992 * oo);
-			phase_ptr->pr_alpha = pow(1 + kk * (1 - sqrt(T_r)), 2);
-			phase_ptr->pr_tk = TK;
-			phase_ptr->pr_in = true;
-		}
 	}
 	if (m_sum == 0)
 			return (OK);
@@ -413,211 +391,343 @@ calc_PR(void)
 		phase_ptr = gas_unknowns[i]->phase;
 		phase_ptr->fraction_x = gas_unknowns[i]->moles / m_sum;							// phase_ptr->fraction_x updated
 	}
+	calc_PR_mix(pr_phase_ptrs);
 
+	if (gas_phase_ptr->Get_type() == cxxGasPhase::GP_VOLUME)
+	{
+		V_m = gas_phase_ptr->Get_volume() / m_sum;
+		while (R_TK / (V_m - b_sum) - a_aa_sum / (V_m * (V_m + 2 * b_sum) - b2) <= 0.0)
+		{
+			V_m *= 2.0;
+		}
+		P = calc_PR_P(V_m);
+		if (P <= 0) // iterations = -1
+			P = 1.;
+		gas_phase_ptr->Set_total_p(P);												// phase_ptr->total_p updated
+		gas_phase_ptr->Set_v_m(V_m);
+	}
+	else
+	{
+		assert(false);
+		P = gas_phase_ptr->Get_total_p();
+		V_m = calc_PR_V_m(P);
+		gas_phase_ptr->Set_v_m(V_m);												 // phase_ptr->fraction_x updated
+	}
+ // calculate the fugacity coefficients...
 	for (i = 0; i < gas_unknowns.size(); i++)
 	{
-		a_aa_sum2 = 0.0;
 		phase_ptr = gas_unknowns[i]->phase;
-		//if (phase_ptr->t_c == 0.0 || phase_ptr->p_c == 0.0)
-		//	continue;
-		b_sum += phase_ptr->fraction_x * phase_ptr->pr_b;
-		size_t i1;
-		class phase *phase_ptr1;
-		for (i1 = 0; i1 <  gas_unknowns.size(); i1++)
+		calc_PR_phi(phase_ptr, P, V_m);											// pr_si_f updated
+		if (phase_ptr->fraction_x != 0.0)
+			phase_ptr->pr_in = true;
+	}
+	return (V_m);
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+calc_PR_parameters(class phase *phase_ptr, LDBLE TK)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Peng-Robinson a and b of a gas, and alpha at TK. a and b are
+ *   calculated once, alpha when TK changes.
+ *   Returns true if any of them was calculated.
+ */
+	LDBLE T_c, P_c, T_r, oo, kk;
+	LDBLE R = R_LITER_ATM; /* L atm / (K mol) */
+	bool calculated = false;
+
+	if (!phase_ptr->pr_a)
+	{
+		T_c = phase_ptr->t_c;
+		P_c = phase_ptr->p_c;
+		phase_ptr->pr_a = 0.457235 * R * R * T_c * T_c / P_c;
+		phase_ptr->pr_b = 0.077796 * R * T_c / P_c;
+		calculated = true;
+	}
+	if (calculated || phase_ptr->pr_tk != TK)
+	{
+		T_r = TK / phase_ptr->t_c;
+		oo = phase_ptr->omega;
+		kk = 0.37464 + oo * (1.54226 - 0.26992 * oo);
+		phase_ptr->pr_alpha = pow(1 + kk * (1 - sqrt(T_r)), 2);
+		phase_ptr->pr_tk = TK;
+		calculated = true;
+	}
+	return calculated;
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+pr_binary_factor(const char *name, const char *name1)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Factor for a_aa of the pair of gases, Soreide and Whitson, 1992, FPE 77, 217
+ */
+	if (!strcmp(name1, "H2O(g)"))
+	{
+		const char *temp = name;
+		name = name1;
+		name1 = temp;
+	}
+	if (strcmp(name, "H2O(g)"))
+		return 1.0;
+	if (!strcmp(name1, "CO2(g)"))
+		return 0.81;
+	else if (!strcmp(name1, "H2S(g)") || !strcmp(name1, "H2Sg(g)"))
+		return 0.81;
+	else if (!strcmp(name1, "CH4(g)") || !strcmp(name1, "Mtg(g)") || !strcmp(name1, "Methane(g)"))
+		return 0.51;
+	else if (!strcmp(name1, "N2(g)") || !strcmp(name1, "Ntg(g)"))
+		return 0.51;
+	else if (!strcmp(name1, "Ethane(g)"))
+		return 0.51;
+	else if (!strcmp(name1, "Propane(g)"))
+		return 0.45;
+	return 1.0;
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+calc_PR_mix(const std::vector<class phase *> &phase_ptrs)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   b_sum, a_aa_sum, b2 and pr_aa_sum2 of the gases from their fraction_x,
+ *   pr_a, pr_b and pr_alpha.
+ *
+ *   The pairwise a_aa of a list of gases is kept in pr_mixings and is
+ *   calculated again only when pr_a * pr_alpha of one of the gases changes,
+ *   that is, at a new temperature.
+ */
+	size_t i, j, n = phase_ptrs.size();
+	class pr_mixing *mix_ptr = NULL;
+	for (i = 0; i < pr_mixings.size(); i++)
+	{
+		if (pr_mixings[i].phases == phase_ptrs)
 		{
-			phase_ptr1 = gas_unknowns[i1]->phase;
-			//if (phase_ptr1->t_c == 0.0 || phase_ptr1->p_c == 0.0)
-			//	continue;
-			if (phase_ptr1->fraction_x == 0)
-				continue;
-			a_aa = sqrt(phase_ptr->pr_a * phase_ptr->pr_alpha *
-				        phase_ptr1->pr_a * phase_ptr1->pr_alpha);
-			if (!strcmp(phase_ptr->name, "H2O(g)"))
-			{
-				if (!strcmp(phase_ptr1->name, "CO2(g)"))
-					a_aa *= 0.81; // Soreide and Whitson, 1992, FPE 77, 217
-				else if (!strcmp(phase_ptr1->name, "H2S(g)") || !strcmp(phase_ptr1->name, "H2Sg(g)"))
-					a_aa *= 0.81;
-				else if (!strcmp(phase_ptr1->name, "CH4(g)") || !strcmp(phase_ptr1->name, "Mtg(g)") || !strcmp(phase_ptr1->name, "Methane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr1->name, "N2(g)") || !strcmp(phase_ptr1->name, "Ntg(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr1->name, "Ethane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr1->name, "Propane(g)"))
-					a_aa *= 0.45;
-			}
-			if (!strcmp(phase_ptr1->name, "H2O(g)"))
+			mix_ptr = &pr_mixings[i];
+			break;
+		}
+	}
+	if (mix_ptr == NULL)
+	{
+		if (pr_mixings.size() >= 16)
+		{
+			pr_mixings.clear();
+		}
+		pr_mixings.push_back(pr_mixing());
+		mix_ptr = &pr_mixings.back();
+		mix_ptr->phases = phase_ptrs;
+		mix_ptr->k_ij.resize(n * n);
+		for (i = 0; i < n; i++)
+		{
+			for (j = 0; j < n; j++)
 			{
-				if (!strcmp(phase_ptr->name, "CO2(g)"))
-					a_aa *= 0.81;
-				else if (!strcmp(phase_ptr->name, "H2S(g)") || !strcmp(phase_ptr->name, "H2Sg(g)"))
-					a_aa *= 0.81;
-				else if (!strcmp(phase_ptr->name, "CH4(g)") || !strcmp(phase_ptr->name, "Mtg(g)") || !strcmp(phase_ptr->name, "Methane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr->name, "N2(g)") || !strcmp(phase_ptr->name, "Ntg(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr->name, "Ethane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr->name, "Propane(g)"))
-					a_aa *= 0.45;
+				mix_ptr->k_ij[i * n + j] = pr_binary_factor(phase_ptrs[i]->name, phase_ptrs[j]->name);
 			}
-			a_aa_sum += phase_ptr->fraction_x * phase_ptr1->fraction_x * a_aa;
-			a_aa_sum2 += phase_ptr1->fraction_x * a_aa;
 		}
-		phase_ptr->pr_aa_sum2 = a_aa_sum2;
+		mix_ptr->a_alpha.assign(n, -1.0);
+		mix_ptr->a_aa.resize(n * n);
 	}
-	b2 = b_sum * b_sum;
-
-	if (gas_phase_ptr->Get_type() == cxxGasPhase::GP_VOLUME)
+	bool changed = false;
+	for (i = 0; i < n; i++)
 	{
-		V_m = gas_phase_ptr->Get_volume() / m_sum;
-		P = 0.0;
-		while (P <= 0)
+		LDBLE a_alpha = phase_ptrs[i]->pr_a * phase_ptrs[i]->pr_alpha;
+		if (a_alpha != mix_ptr->a_alpha[i])
 		{
-			P = R_TK / (V_m - b_sum) - a_aa_sum / (V_m * (V_m + 2 * b_sum) - b2);
-			if (P <= 0.0)
+			mix_ptr->a_alpha[i] = a_alpha;
+			changed = true;
+		}
+	}
+	if (changed)
+	{
+		for (i = 0; i < n; i++)
+		{
+			class phase *phase_ptr = phase_ptrs[i];
+			for (j = 0; j < n; j++)
 			{
-				V_m *= 2.0;
-			//a_aa_sum /= 2.0;
+				class phase *phase_ptr1 = phase_ptrs[j];
+				mix_ptr->a_aa[i * n + j] = sqrt(phase_ptr->pr_a * phase_ptr->pr_alpha *
+					phase_ptr1->pr_a * phase_ptr1->pr_alpha) * mix_ptr->k_ij[i * n + j];
 			}
 		}
-		if (iterations > 0 && P < 150 && V_m < 1.01)
+	}
+/*
+ *   Mixing sums; terms of gases with fraction_x == 0 add zero
+ */
+	pr_fractions.resize(n);
+	for (i = 0; i < n; i++)
+	{
+		pr_fractions[i] = phase_ptrs[i]->fraction_x;
+	}
+	const LDBLE *x_ptr = pr_fractions.data();
+	b_sum = a_aa_sum = 0.0;
+	for (i = 0; i < n; i++)
+	{
+		const LDBLE *a_aa_ptr = &mix_ptr->a_aa[i * n];
+		LDBLE x_i = x_ptr[i];
+		LDBLE a_aa_sum2 = 0.0;
+		b_sum += x_i * phase_ptrs[i]->pr_b;
+		for (j = 0; j < n; j++)
+		{
+			a_aa_sum += x_i * x_ptr[j] * a_aa_ptr[j];
+			a_aa_sum2 += x_ptr[j] * a_aa_ptr[j];
+		}
+		phase_ptrs[i]->pr_aa_sum2 = a_aa_sum2;
+	}
+	b2 = b_sum * b_sum;
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+calc_PR_P(LDBLE V_m)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Pressure at molar volume V_m from b_sum, a_aa_sum and b2. If the cubic
+ *   has 3 roots, V_m is compared with the volume of the local maximum of P.
+ */
+	LDBLE P, r3[4];
+	LDBLE disct, vinit, v1, ddp, dp_dv, dp_dv2;
+	int it;
+	bool halved;
+
+	P = R_TK / (V_m - b_sum) - a_aa_sum / (V_m * (V_m + 2 * b_sum) - b2);
+	if (iterations > 0 && P < 150 && V_m < 1.01)
+	{
+		// check for 3-roots...
+		r3[1] = b_sum - R_TK / P;
+		r3[2] = -3.0 * b2 + (a_aa_sum - R_TK * 2.0 * b_sum) / P;
+		r3[3] = b2 * b_sum + (R_TK * b2 - b_sum * a_aa_sum) / P;
+		// the discriminant of the cubic eqn...
+		disct = 18. * r3[1] * r3[2] * r3[3] -
+			4. * pow(r3[1], 3) * r3[3] + 
+			r3[1] * r3[1] * r3[2] * r3[2] -
+			4. * pow(r3[2], 3) - 
+			27. * r3[3] * r3[3];
+		if (disct > 0)
 		{
-			// check for 3-roots...
-			r3[1] = b_sum - R_TK / P;
-			r3[2] = -3.0 * b2 + (a_aa_sum - R_TK * 2.0 * b_sum) / P;
-			r3[3] = b2 * b_sum + (R_TK * b2 - b_sum * a_aa_sum) / P;
-			// the discriminant of the cubic eqn...
-			disct = 18. * r3[1] * r3[2] * r3[3] -
-				4. * pow(r3[1], 3) * r3[3] + 
-				r3[1] * r3[1] * r3[2] * r3[2] -
-				4. * pow(r3[2], 3) - 
-				27. * r3[3] * r3[3];
-			if (disct > 0)
+			// 3-roots, find the largest P...
+			it = 0;
+			halved = false;
+			ddp = 1e-9;
+			v1 = vinit = 0.729;
+			dp_dv = f_Vm(v1, this);
+			while (fabs(dp_dv) > 1e-11 && it < 40)
 			{
-				// 3-roots, find the largest P...
-				it = 0;
-				halved = false;
-				ddp = 1e-9;
-				v1 = vinit = 0.729;
-				dp_dv = f_Vm(v1, this);
-				while (fabs(dp_dv) > 1e-11 && it < 40)
+				it +=1;
+				dp_dv2 = f_Vm(v1 - ddp, this);
+				v1 -= (dp_dv * ddp / (dp_dv - dp_dv2));
+				if (!halved && (v1 > vinit || v1 < 0.03))
 				{
-					it +=1;
-					dp_dv2 = f_Vm(v1 - ddp, this);
-					v1 -= (dp_dv * ddp / (dp_dv - dp_dv2));
-					if (!halved && (v1 > vinit || v1 < 0.03))
+					if (vinit > 0.329)
+						vinit -= 0.1;
+					else
+						vinit -=0.05;
+					if (vinit < 0.03)
 					{
-						if (vinit > 0.329)
-							vinit -= 0.1;
-						else
-							vinit -=0.05;
-						if (vinit < 0.03)
-						{
-							vinit = halve(f_Vm, 0.03, 1.0, 1e-3);
-							if (f_Vm(vinit - 2e-3, this) < 0)
-								vinit = halve(f_Vm, vinit + 2e-3, 1.0, 1e-3);
-							halved = true;
-						}
-						v1 = vinit;
+						vinit = halve(f_Vm, 0.03, 1.0, 1e-3);
+						if (f_Vm(vinit - 2e-3, this) < 0)
+							vinit = halve(f_Vm, vinit + 2e-3, 1.0, 1e-3);
+						halved = true;
 					}
-					dp_dv = f_Vm(v1, this);
-					if (fabs(dp_dv) < 1e-11)
+					v1 = vinit;
+				}
+				dp_dv = f_Vm(v1, this);
+				if (fabs(dp_dv) < 1e-11)
+				{
+					if (f_Vm(v1 - 1e-4, this) < 0)
 					{
-						if (f_Vm(v1 - 1e-4, this) < 0)
-						{
-							v1 = halve(f_Vm, v1 + 1e-4, 1.0, 1e-3);
-							dp_dv = f_Vm(v1, this);
-						}
+						v1 = halve(f_Vm, v1 + 1e-4, 1.0, 1e-3);
+						dp_dv = f_Vm(v1, this);
 					}
 				}
-				if (it == 40)
-				{
+			}
+			if (it == 40)
+			{
 // accept a (possible) whobble in the curve...
-//					error_msg("No convergence when calculating P in Peng-Robinson.", STOP);
-				}
-				if (V_m < v1 && it < 40)
-					P = R_TK / (v1 - b_sum) - a_aa_sum / (v1 * (v1 + 2 * b_sum) - b2);
+//				error_msg("No convergence when calculating P in Peng-Robinson.", STOP);
 			}
+			if (V_m < v1 && it < 40)
+				P = R_TK / (v1 - b_sum) - a_aa_sum / (v1 * (v1 + 2 * b_sum) - b2);
 		}
-		if (P <= 0) // iterations = -1
-			P = 1.;
-		gas_phase_ptr->Set_total_p(P);												// phase_ptr->total_p updated
-		gas_phase_ptr->Set_v_m(V_m);
 	}
-	else
+	return (P);
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+calc_PR_V_m(LDBLE P)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Molar volume at pressure P from b_sum, a_aa_sum and b2,
+ *   the largest root of the cubic
+ */
+	LDBLE V_m, r3[4], r3_12, rp, rp3, rq, rz, ri, ri1, one_3 = 0.33333333333333333;
+
+	r3[1] = b_sum - R_TK / P;
+	r3_12 = r3[1] * r3[1];
+	r3[2] = -3.0 * b2 + (a_aa_sum - R_TK * 2.0 * b_sum) / P;
+	r3[3] = b2 * b_sum + (R_TK * b2 - b_sum * a_aa_sum) / P;
+	// solve t^3 + rp*t + rq = 0.
+	// molar volume V_m = t - r3[1] / 3... 
+	rp = r3[2] - r3_12 / 3;
+	rp3 = rp * rp * rp;
+	rq = (2.0 * r3_12 * r3[1] - 9.0 * r3[1] * r3[2]) / 27 + r3[3];
+	rz = rq * rq / 4 + rp3 / 27;
+	if (rz >= 0) // Cardono's method...
 	{
-		assert(false);
-		P = gas_phase_ptr->Get_total_p();
-		r3[1] = b_sum - R_TK / P;
-		r3_12 = r3[1] * r3[1];
-		r3[2] = -3.0 * b2 + (a_aa_sum - R_TK * 2.0 * b_sum) / P;
-		r3[3] = b2 * b_sum + (R_TK * b2 - b_sum * a_aa_sum) / P;
-		// solve t^3 + rp*t + rq = 0.
-		// molar volume V_m = t - r3[1] / 3... 
-		rp = r3[2] - r3_12 / 3;
-		rp3 = rp * rp * rp;
-		rq = (2.0 * r3_12 * r3[1] - 9.0 * r3[1] * r3[2]) / 27 + r3[3];
-		rz = rq * rq / 4 + rp3 / 27;
-		if (rz >= 0) // Cardono's method...
+		ri = sqrt(rz);
+		if (ri + rq / 2 <= 0)
 		{
-			ri = sqrt(rz);
-			if (ri + rq / 2 <= 0)
-			{
-				V_m = pow(ri - rq / 2, one_3) + pow(- ri - rq / 2, one_3) - r3[1] / 3;
-			} else
-			{
-				ri = - pow(ri + rq / 2, one_3);
-				V_m = ri - rp / (3.0 * ri) - r3[1] / 3;
-			}
-		} else // use complex plane...
+			V_m = pow(ri - rq / 2, one_3) + pow(- ri - rq / 2, one_3) - r3[1] / 3;
+		}
+		else
 		{
-			ri = sqrt(- rp3 / 27); // rp < 0
-			ri1 = acos(- rq / 2 / ri);
-			V_m = 2.0 * pow(ri, one_3) * cos(ri1 / 3) - r3[1] / 3;
+			ri = - pow(ri + rq / 2, one_3);
+			V_m = ri - rp / (3.0 * ri) - r3[1] / 3;
 		}
-		gas_phase_ptr->Set_v_m(V_m);												 // phase_ptr->fraction_x updated
 	}
- // calculate the fugacity coefficients...
-	for (i = 0; i < gas_unknowns.size(); i++)
+	else // use complex plane...
 	{
-		phase_ptr = gas_unknowns[i]->phase;
-		if (phase_ptr->fraction_x == 0.0)
-		{
-			phase_ptr->pr_p = 0;
-			phase_ptr->pr_phi = 1;
-			phase_ptr->pr_si_f = 0.0;
-			//phase_ptr->logk[vm0] = 0.0; // ***
-			continue;
-		}	
-		phase_ptr->pr_p = phase_ptr->fraction_x * P;
-
-		//if (phase_ptr->t_c == 0.0 || phase_ptr->p_c == 0.0)
-		//{
-		//	phase_ptr->pr_phi = 1;
-		//	continue;
-		//}
-		rz = P * V_m / R_TK;
-		A = a_aa_sum * P / (R_TK * R_TK);
-		B = b_sum * P / R_TK;
-		B_r = phase_ptr->pr_b / b_sum;
-		if (rz > B)
-		{
-			phi = B_r * (rz - 1) - log(rz - B) + A / (2.828427 * B) * (B_r - 2.0 * phase_ptr->pr_aa_sum2 / a_aa_sum) *
-				  log((rz + 2.41421356 * B) / (rz - 0.41421356 * B));
-			phi = (phi > 4.44 ? 4.44 : (phi < -4.6 ? -4.6 : phi));
-		}
-		else
-			phi = -4.6; // fugacity coefficient = 0.01
-		phase_ptr->pr_phi = exp(phi);
-		phase_ptr->pr_si_f = phi / LOG_10;										// pr_si_f updated
-		// ****
-		//phase_ptr->logk[vm0] = V_m * 1e3 * phase_ptr->fraction_x;
-		phase_ptr->pr_in = true;
+		ri = sqrt(- rp3 / 27); // rp < 0
+		ri1 = acos(- rq / 2 / ri);
+		V_m = 2.0 * pow(ri, one_3) * cos(ri1 / 3) - r3[1] / 3;
 	}
 	return (V_m);
 }
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+calc_PR_phi(class phase *phase_ptr, LDBLE P, LDBLE V_m)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Partial pressure, fugacity coefficient and pr_si_f of a gas
+ */
+	LDBLE A, B, B_r, rz, phi;
+
+	if (phase_ptr->fraction_x == 0.0)
+	{
+		phase_ptr->pr_p = 0;
+		phase_ptr->pr_phi = 1;
+		phase_ptr->pr_si_f = 0.0;
+		return;
+	}
+	phase_ptr->pr_p = phase_ptr->fraction_x * P;
+	rz = P * V_m / R_TK;
+	A = a_aa_sum * P / (R_TK * R_TK);
+	B = b_sum * P / R_TK;
+	B_r = phase_ptr->pr_b / b_sum;
+	if (rz > B)
+	{
+		phi = B_r * (rz - 1) - log(rz - B) + A / (2.828427 * B) * (B_r - 2.0 * phase_ptr->pr_aa_sum2 / a_aa_sum) *
+			  log((rz + 2.41421356 * B) / (rz - 0.41421356 * B));
+		phi = (phi > 4.44 ? 4.44 : (phi < -4.6 ? -4.6 : phi));
+	}
+	else
+		phi = -4.6; // fugacity coefficient = 0.01
+	phase_ptr->pr_phi = exp(phi);
+	phase_ptr->pr_si_f = phi / LOG_10;
+}
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
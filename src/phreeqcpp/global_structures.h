@@ -2,6 +2,13 @@
 #define _INC_GLOBAL_STRUCTURES_H
 #include "Surface.h"
 #include "GasPhase.h"
+#ifdef SWIG_SHARED_OBJ
+#include "RunStatistics.h"        /* RS_ATTEMPT_COUNT, RS_CALCULATION_COUNT */
+#include "PhaseCounters.h"        /* PhaseCounters::Wall_time */
+#else
+#define RS_ATTEMPT_COUNT      15
+#define RS_CALCULATION_COUNT  10
+#endif
 /* ----------------------------------------------------------------------
  *   #define DEFINITIONS
  * ---------------------------------------------------------------------- */
@@ -118,6 +125,9 @@
 #define PRESSURE 1
 #define VOLUME 2
 
+/* calculate_value->calculated while its Basic program runs */
+#define CALCULATING 2
+
 #define MAX_PP_ASSEMBLAGE 10	/* default estimate of the number of phase assemblages */
 #define MAX_ADD_EQUATIONS 20	/* maximum number of equations added together to reduce eqn to
 								   master species */
@@ -630,6 +640,239 @@ public:
 	int print;
 	int same_model;
 };
+/*----------------------------------------------------------------------
+ *   Solve cost of a transport or advection cell, parallel to cell_data
+ *---------------------------------------------------------------------- */
+class cell_cost
+{
+public:
+	~cell_cost() {};
+	cell_cost()
+	{
+		iterations = 0;
+		retries = 0;
+		solves = 0;
+		kinetic_steps = 0;
+		time = 0;
+	}
+	// model() iterations, summed over all attempts
+	int iterations;
+	// failed attempts in set_and_run_wrapper
+	int retries;
+	// calls to set_and_run_wrapper
+	int solves;
+	// CVODE or Runge-Kutta integration steps
+	int kinetic_steps;
+	// elapsed seconds spent in run_reactions and set_and_run_wrapper
+	LDBLE time;
+};
+/*
+ *   Adds the elapsed time of the outermost run_reactions or
+ *   set_and_run_wrapper to a cell_cost, also when a STOP unwinds it
+ */
+class cell_cost_scope
+{
+public:
+	cell_cost_scope(class cell_cost *c, int & d) : cost_ptr(c), depth(d)
+	{
+		start = PhaseCounters::Wall_time();
+		depth++;
+	}
+	~cell_cost_scope(void)
+	{
+		depth--;
+		if (cost_ptr != NULL && depth == 0)
+		{
+			cost_ptr->time += PhaseCounters::Wall_time() - start;
+		}
+	}
+protected:
+	class cell_cost *cost_ptr;
+	int & depth;
+	LDBLE start;
+};
+/*----------------------------------------------------------------------
+ *   Solver statistics of a run
+ *---------------------------------------------------------------------- */
+class run_statistics
+{
+public:
+	~run_statistics() {};
+	run_statistics()
+	{
+		iterations = 0;
+		jacobians = 0;
+		for (int i = 0; i < RS_ATTEMPT_COUNT; i++)
+		{
+			attempts[i] = 0;
+		}
+		failures = 0;
+		for (int i = 0; i < RS_CALCULATION_COUNT; i++)
+		{
+			calculations[i] = 0;
+		}
+		cvode_steps = 0;
+		rk_steps = 0;
+		rk_rejected = 0;
+		line_searches = 0;
+		g_sweeps = 0;
+		donnan_sweeps = 0;
+	}
+	// model() iterations
+	int iterations;
+	// numerical_jacobian, jacobian_pz and jacobian_sit evaluations
+	int jacobians;
+	// set_and_run calls by set_and_run_wrapper attempt, 0 is the first try
+	int attempts[RS_ATTEMPT_COUNT];
+	// set_and_run_wrapper calls that did not converge
+	int failures;
+	// model() calls by state
+	int calculations[RS_CALCULATION_COUNT];
+	// CVODE integration steps
+	int cvode_steps;
+	// accepted and rejected Runge-Kutta steps
+	int rk_steps;
+	int rk_rejected;
+	// Newton steps shortened by line_search_step
+	int line_searches;
+	// surface_model sweeps, full integration and Donnan
+	int g_sweeps;
+	int donnan_sweeps;
+};
+/*----------------------------------------------------------------------
+ *   Element stoichiometry of the kinetic reactions, per mole of reaction
+ *---------------------------------------------------------------------- */
+class kinetics_stoichiometry
+{
+public:
+	~kinetics_stoichiometry() {};
+	kinetics_stoichiometry()
+	{
+		kinetics_ptr = NULL;
+		exchange_ptr = NULL;
+		surface_ptr = NULL;
+		count_comps = 0;
+	}
+	// surface related to a kinetic reactant; added only while the reactant remains
+	class related_surface
+	{
+	public:
+		size_t comp;
+		LDBLE proportion;
+		class master *master_ptr;
+		std::vector<size_t> rows;
+		std::vector<LDBLE> coefs;
+	};
+	// entities the matrix was compiled for
+	class cxxKinetics *kinetics_ptr;
+	class cxxExchange *exchange_ptr;
+	class cxxSurface *surface_ptr;
+	size_t count_comps;
+	// matrix rows
+	std::vector<class element *> elts;
+	// elts.size() x count_comps, one column per kinetic component
+	std::vector<LDBLE> matrix;
+	// element appears in the formulas of the component, even if coefficients cancel
+	std::vector<bool> present;
+	std::vector<related_surface> surfaces;
+};
+/*----------------------------------------------------------------------
+ *   Peng-Robinson mixing terms of a list of gases, cached by calc_PR_mix
+ *---------------------------------------------------------------------- */
+class pr_mixing
+{
+public:
+	~pr_mixing() {};
+	pr_mixing()
+	{
+	}
+	std::vector<class phase *> phases;
+	// binary interaction factors, phases.size() x phases.size(), row major
+	std::vector<LDBLE> k_ij;
+	// pr_a * pr_alpha of the phases when a_aa was calculated
+	std::vector<LDBLE> a_alpha;
+	// k_ij * (a_i * alpha_i * a_j * alpha_j)^0.5, row major
+	std::vector<LDBLE> a_aa;
+};
+/*----------------------------------------------------------------------
+ *   Spinodal and miscibility gaps of a solid solution, cached by ss_prep
+ *---------------------------------------------------------------------- */
+class ss_gap
+{
+public:
+	~ss_gap() {};
+	ss_gap()
+	{
+		ag0 = 0;
+		ag1 = 0;
+		spinodal = false;
+		xsm1 = 0.5;
+		xsm2 = 0.5;
+		xc1 = 0;
+		xc2 = 0;
+	}
+	// Guggenheim parameters (kJ/mol) the gaps were calculated for
+	LDBLE ag0, ag1;
+	// a spinodal gap, and so a miscibility gap, was found
+	bool spinodal;
+	// spinodal-gap mole fractions of component 2
+	LDBLE xsm1, xsm2;
+	// miscibility-gap mole fractions of component 1, as solved by solve_misc
+	LDBLE xc1, xc2;
+};
+/*----------------------------------------------------------------------
+ *   Unknowns before a Newton step, kept by line_search_save
+ *---------------------------------------------------------------------- */
+class newton_step
+{
+public:
+	~newton_step() {};
+	newton_step()
+	{
+		saved = false;
+		alpha = 1.0;
+		merit = 0;
+		count_basis_change = 0;
+		mu_x = 0;
+		ah2o_x = 0;
+		h2o_la = 0;
+		eminus_la = 0;
+		mass_water_aq_x = 0;
+		mass_water_bulk_x = 0;
+		h2o_moles = 0;
+	}
+	// true if the unknowns below were saved before the last reset
+	bool saved;
+	// fraction of the Newton step that was taken
+	LDBLE alpha;
+	// residual_merit before the step
+	LDBLE merit;
+	// basis changes before the step; a new basis ends the line search
+	int count_basis_change;
+	// delta from ineq, before reset limits it
+	std::vector<LDBLE> delta;
+	// la of the first master species, moles and related_moles of each unknown
+	std::vector<LDBLE> la, moles, related_moles;
+	// grams of the surface charge of SURFACE_CB unknowns
+	std::vector<LDBLE> grams;
+	LDBLE mu_x, ah2o_x, h2o_la, eminus_la;
+	LDBLE mass_water_aq_x, mass_water_bulk_x, h2o_moles;
+};
+/*----------------------------------------------------------------------
+ *   Debye-Huckel terms of gammas, shared by the gammas_species loops
+ *---------------------------------------------------------------------- */
+class gammas_constants
+{
+public:
+	~gammas_constants() {};
+	gammas_constants()
+	{
+		mu = a = b = muhalf = c1 = c2 = c2_llnl = 0;
+		log_g_co2 = dln_g_co2 = 0;
+	}
+	LDBLE mu, a, b, muhalf, c1, c2, c2_llnl;
+	LDBLE log_g_co2, dln_g_co2;
+};
 /*----------------------------------------------------------------------
  *   Keywords
  *---------------------------------------------------------------------- */
@@ -1366,6 +1609,7 @@ public:
 	LDBLE value;
 	std::string commands;
 	int new_def;
+	// FALSE, TRUE, or CALCULATING
 	int calculated;
 	void* linebase;
 	void* varbase;
@@ -1380,6 +1624,7 @@ public:
 		isotope_name = NULL;
 		ratio = 0;
 		converted_ratio = 0;
+		calculated = FALSE;
 	}
 	~isotope_ratio() {};
 
@@ -1387,6 +1632,7 @@ public:
 	const char* isotope_name;
 	LDBLE ratio;
 	LDBLE converted_ratio;
+	int calculated;
 };
 class isotope_alpha
 {
@@ -1396,11 +1642,13 @@ public:
 		name = NULL;
 		named_logk = NULL;
 		value = 0;
+		calculated = FALSE;
 	}
 	~isotope_alpha() {};
 	const char* name;
 	const char* named_logk;
 	LDBLE value;
+	int calculated;
 };
 class system_species
 {
@@ -1579,6 +1827,31 @@ public:
 	const char* name;
 	LDBLE tot1, tot2, tot_stag, charge;
 };
+struct CURRENT_CELLS
+{
+	LDBLE dif, ele, R; // diffusive and electric components, relative cell resistance
+};
+struct V_M   // For calculating Vinograd and McBain's zero-charge, diffusive tranfer of individual solutes
+{
+	LDBLE grad, D, z, c, zc, Dz, Dzc;
+	LDBLE b_ij; // harmonic mean of cell properties, with EDL enrichment
+};
+struct CT /* summed parts of V_M and mcd transfer in a timestep for all cells, for free + DL water */
+{
+	LDBLE kgw, dl_s, Dz2c, Dz2c_stag, visc1, visc2, J_ij_sum;
+	LDBLE A_ij_il, Dz2c_il, mixf_il;
+	int J_ij_count_spec, J_ij_il_count_spec;
+	struct V_M *v_m, *v_m_il;
+	class J_ij *J_ij, *J_ij_il;
+	int count_m_s;
+	class M_S *m_s;
+	int v_m_size, J_ij_size, m_s_size;
+};
+struct MOLES_ADDED /* total moles added to balance negative conc's */
+{
+	char *name;
+	LDBLE moles;
+};
 // Pitzer definitions
 typedef enum
 { TYPE_B0, TYPE_B1, TYPE_B2, TYPE_C0, TYPE_THETA, TYPE_LAMDA, TYPE_ZETA,
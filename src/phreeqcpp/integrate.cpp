@@ -39,6 +39,19 @@ calc_all_g(void)
 	}
 
 	converge = TRUE;
+	/*
+	 *   moles of the charged aqueous species, summed by charge, for
+	 *   g_function; the moles do not change during the integrations
+	 */
+	std::map<LDBLE, LDBLE> moles_by_z;
+	for (int i = 0; i < (int)this->s_x.size(); i++)
+	{
+		if (s_x[i]->type < H2O && s_x[i]->z != 0.0)
+		{
+			moles_by_z[s_x[i]->z] += s_x[i]->moles;
+		}
+	}
+	g_function_moles.assign(moles_by_z.begin(), moles_by_z.end());
 
 	for (int j = 0; j < count_unknowns; j++)
 	{
@@ -254,18 +267,10 @@ g_function(LDBLE x_value)
 	sum = 0.0;
 	ln_x_value = log(x_value);
 
-	cxxSurfaceCharge *charge_ptr = &(use.Get_surface_ptr()->Get_surface_charges()[0]);
-	std::map<LDBLE, cxxSurfDL>::iterator it = charge_ptr->Get_g_map().begin();
-	for (; it != charge_ptr->Get_g_map().end(); it++)
-	{
-		it->second.Set_psi_to_z(exp(ln_x_value * it->first) - 1.0);
-	}
-	for (i = 0; i < (int)this->s_x.size(); i++)
+	/* g_function_moles is filled by calc_all_g */
+	for (size_t k = 0; k < g_function_moles.size(); k++)
 	{
-		if (s_x[i]->type < H2O && s_x[i]->z != 0.0)
-		{
-			sum += s_x[i]->moles * charge_ptr->Get_g_map()[s_x[i]->z].Get_psi_to_z();
-		}
+		sum += g_function_moles[k].second * (exp(ln_x_value * g_function_moles[k].first) - 1.0);
 	}
 	if (sum < 0.0)
 	{
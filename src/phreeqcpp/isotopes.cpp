@@ -1,6 +1,7 @@
 #include "Phreeqc.h"
 #include "phqalloc.h"
 #include "Solution.h"
+#include "PBasic.h"
 #include "Utils.h"
 
 #if defined(PHREEQCI_GUI)
@@ -804,6 +805,8 @@ punch_isotopes(void)
 	//if (punch.count_isotopes == 0)
 	//	return (OK);
 	//for (i = 0; i < punch.count_isotopes; i++)
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_isotopes(), "I_");
 	for (size_t i = 0; i < current_selected_output->Get_isotopes().size(); i++)
 	{
 		iso = MISSING;
@@ -826,17 +829,18 @@ punch_isotopes(void)
 			isotope_ratio_ptr = isotope_ratio_search(current_selected_output->Get_isotopes()[i].first.c_str());
 			if (isotope_ratio_ptr != NULL)
 			{
+				isotope_ratio_calculate(isotope_ratio_ptr);
 				iso = isotope_ratio_ptr->converted_ratio;
 			}
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("I_%s", current_selected_output->Get_isotopes()[i].first.c_str()), "%12.4e\t",
+			fpunchf(headings[i].c_str(), "%12.4e\t",
 				(double) iso);
 		}
 		else
 		{
-			fpunchf(sformatf("I_%s", current_selected_output->Get_isotopes()[i].first.c_str()), "%20.12e\t",
+			fpunchf(headings[i].c_str(), "%20.12e\t",
 				(double) iso);
 		}
 
@@ -855,11 +859,12 @@ punch_calculate_values(void)
 	//int i;
 	LDBLE result;
 	class calculate_value *calculate_value_ptr;
-	char l_command[] = "run";
 
 	if (current_selected_output->Get_calculate_values().size() == 0)
 		return OK;
 
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_calculate_values(), "V_");
 	for (size_t i = 0; i < current_selected_output->Get_calculate_values().size(); i++)
 	{
 		result = MISSING;
@@ -876,55 +881,15 @@ punch_calculate_values(void)
 #endif
 		}
 
-		if (calculate_value_ptr->calculated == FALSE)
-		{
-			rate_moles = NAN;
-			if (calculate_value_ptr->new_def == TRUE)
-			{
-				if (basic_compile
-					(calculate_value_ptr->commands.c_str(), &calculate_value_ptr->linebase,
-					&calculate_value_ptr->varbase,
-					&calculate_value_ptr->loopbase) != 0)
-				{
-					error_string = sformatf(
-						"Fatal Basic error in CALCULATE_VALUES %s.",
-						calculate_value_ptr->name);
-					error_msg(error_string, STOP);
-				}
-				calculate_value_ptr->new_def = FALSE;
-			}
-			if (basic_run
-				(l_command, calculate_value_ptr->linebase,
-				calculate_value_ptr->varbase, calculate_value_ptr->loopbase) != 0)
-			{
-				error_string = sformatf( "Fatal Basic error in calculate_value %s.",
-					calculate_value_ptr->name);
-				error_msg(error_string, STOP);
-			}
-			if (std::isnan(rate_moles))
-			{
-				error_string = sformatf( "Calculated value not SAVEed for %s.",
-					calculate_value_ptr->name);
-				error_msg(error_string, STOP);
-			}
-			else
-			{
-				calculate_value_ptr->calculated = TRUE;
-				calculate_value_ptr->value = rate_moles;
-			}
-		}
-		if (calculate_value_ptr != NULL)
-		{
-			result = calculate_value_ptr->value;
-		}
+		result = calculate_value_get(calculate_value_ptr);
 		if (!current_selected_output->Get_high_precision())
 		{
-		  fpunchf(sformatf("V_%s", current_selected_output->Get_calculate_values()[i].first.c_str()),
+		  fpunchf(headings[i].c_str(),
 				"%12.4e\t", (double) result);
 		}
 		else
 		{
-		  fpunchf(sformatf("V_%s", current_selected_output->Get_calculate_values()[i].first.c_str()),
+		  fpunchf(headings[i].c_str(),
 				"%20.12e\t", (double) result);
 		}
 	}
@@ -976,6 +941,7 @@ print_isotope_ratios(void)
 
 	for (j = 0; j < (int)isotope_ratio.size(); j++)
 	{
+		isotope_ratio_calculate(isotope_ratio[j]);
 		if (isotope_ratio[j]->ratio == MISSING)
 			continue;
 		master_isotope_ptr =
@@ -1041,6 +1007,7 @@ print_isotope_alphas(void)
 
 	for (j = 0; j < (int)isotope_alpha.size(); j++)
 	{
+		isotope_alpha_calculate(isotope_alpha[j]);
 		if (isotope_alpha[j]->value == MISSING)
 			continue;
 		/*
@@ -1080,141 +1047,138 @@ int Phreeqc::
 calculate_values(void)
 /* ---------------------------------------------------------------------- */
 {
-	int j;
-	class calculate_value *calculate_value_ptr;
-	class isotope_ratio *isotope_ratio_ptr;
-	class isotope_alpha *isotope_alpha_ptr;
-	class master_isotope *master_isotope_ptr;
-	char l_command[] = "run";
-
-
-	/*
-	 * initialize ratios as missing
-	 */
-	for (j = 0; j < calculate_value.size(); j++)
+/*
+ *   Called when the system changes. Calculate values, isotope ratios
+ *   and isotope alphas are marked not calculated; each is run when it
+ *   is first used by output, a BASIC program, or another calculate value
+ *   (calculate_value_get, isotope_ratio_calculate, isotope_alpha_calculate),
+ *   and is then reused until the next call.
+ */
+	for (size_t j = 0; j < calculate_value.size(); j++)
 	{
 		calculate_value[j]->calculated = FALSE;
 		calculate_value[j]->value = MISSING;
 	}
-	if (pr.isotope_ratios == TRUE)
+	for (size_t j = 0; j < isotope_ratio.size(); j++)
 	{
-		for (j = 0; j < (int)isotope_ratio.size(); j++)
-		{
-			isotope_ratio_ptr = isotope_ratio[j];
-			master_isotope_ptr =
-				master_isotope_search(isotope_ratio_ptr->isotope_name);
-			if (master_isotope_ptr->master->s->in == FALSE) continue;
-			calculate_value_ptr = calculate_value_search(isotope_ratio_ptr->name);
-			if (calculate_value_ptr->calculated == FALSE)
-			{
-				rate_moles = NAN;
-				if (calculate_value_ptr->new_def == TRUE)
-				{
-					if (basic_compile
-						(calculate_value_ptr->commands.c_str(), &calculate_value_ptr->linebase,
-						&calculate_value_ptr->varbase,
-						&calculate_value_ptr->loopbase) != 0)
-					{
-						error_string = sformatf(
-							"Fatal Basic error in CALCULATE_VALUES %s.",
-							calculate_value_ptr->name);
-						error_msg(error_string, STOP);
-					}
-					calculate_value_ptr->new_def = FALSE;
-				}
-				if (basic_run
-					(l_command, calculate_value_ptr->linebase,
-					calculate_value_ptr->varbase, calculate_value_ptr->loopbase) != 0)
-				{
-					error_string = sformatf( "Fatal Basic error in calculate_value %s.",
-						calculate_value_ptr->name);
-					error_msg(error_string, STOP);
-				}
-				if (std::isnan(rate_moles))
-				{
-					error_string = sformatf( "Calculated value not SAVEed for %s.",
-						calculate_value_ptr->name);
-					error_msg(error_string, STOP);
-				}
-				else
-				{
-					calculate_value_ptr->calculated = TRUE;
-					calculate_value_ptr->value = rate_moles;
-				}
-			}
-			/*
-			*  Calculate converted isotope ratio
-			*/
-			if (calculate_value_ptr->value == MISSING)
-			{
-				isotope_ratio_ptr->ratio = MISSING;
-				isotope_ratio_ptr->converted_ratio = MISSING;
-			}
-			else
-			{
-				isotope_ratio_ptr->ratio = calculate_value_ptr->value;
-				isotope_ratio_ptr->converted_ratio =
-					convert_isotope(master_isotope_ptr,
-					calculate_value_ptr->value);
-			}
-		}
+		isotope_ratio[j]->calculated = FALSE;
+	}
+	for (size_t j = 0; j < isotope_alpha.size(); j++)
+	{
+		isotope_alpha[j]->calculated = FALSE;
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+calculate_value_get(class calculate_value *calculate_value_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns the value, running the Basic program if it has not been
+ *   run since the system last changed. Values used by the program
+ *   through CALC_VALUE are calculated in turn.
+ */
+	if (calculate_value_ptr->calculated == TRUE)
+	{
+		return (calculate_value_ptr->value);
+	}
+	if (calculate_value_ptr->calculated == CALCULATING)
+	{
+		error_string = sformatf( "Circular reference in CALCULATE_VALUES %s.",
+			calculate_value_ptr->name);
+		error_msg(error_string, STOP);
 	}
-	if (pr.isotope_alphas == TRUE)
+	char l_command[] = "run";
+	LDBLE rate_moles_save = rate_moles;
+	PhaseCounters::Scope basic_scope(phase_counters, PhaseCounters::BASIC);
+	PBasic interp(this, this->phrq_io);
+	if (calculate_value_ptr->new_def == TRUE)
 	{
-		for (j = 0; j < (int)isotope_alpha.size(); j++)
+		if (interp.basic_compile
+			(calculate_value_ptr->commands.c_str(), &calculate_value_ptr->linebase,
+			&calculate_value_ptr->varbase,
+			&calculate_value_ptr->loopbase) != 0)
 		{
-			isotope_alpha_ptr = isotope_alpha[j];
-			calculate_value_ptr = calculate_value_search(isotope_alpha_ptr->name);
-			/*
-			*  Calculate converted isotope ratio
-			*/
-			if (calculate_value_ptr->calculated == FALSE)
-			{
-				rate_moles = NAN;
-				if (calculate_value_ptr->new_def == TRUE)
-				{
-					if (basic_compile
-						(calculate_value_ptr->commands.c_str(), &calculate_value_ptr->linebase,
-						&calculate_value_ptr->varbase,
-						&calculate_value_ptr->loopbase) != 0)
-					{
-						error_string = sformatf(
-							"Fatal Basic error in CALCULATE_VALUES %s.",
-							calculate_value_ptr->name);
-						error_msg(error_string, STOP);
-					}
-					calculate_value_ptr->new_def = FALSE;
-				}
-				if (basic_run
-					(l_command, calculate_value_ptr->linebase,
-					calculate_value_ptr->varbase, calculate_value_ptr->loopbase) != 0)
-				{
-					error_string = sformatf( "Fatal Basic error in calculate_value %s.",
-						calculate_value_ptr->name);
-					error_msg(error_string, STOP);
-				}
-				if (std::isnan(rate_moles))
-				{
-					error_string = sformatf( "Calculated value not SAVEed for %s.",
-						calculate_value_ptr->name);
-					error_msg(error_string, STOP);
-				}
-				else
-				{
-					calculate_value_ptr->calculated = TRUE;
-					calculate_value_ptr->value = rate_moles;
-				}
-			}
-			if (calculate_value_ptr->value == MISSING)
-			{
-				isotope_alpha_ptr->value = MISSING;
-			}
-			else
-			{
-				isotope_alpha_ptr->value = calculate_value_ptr->value;
-			}
+			error_string = sformatf(
+				"Fatal Basic error in CALCULATE_VALUES %s.",
+				calculate_value_ptr->name);
+			error_msg(error_string, STOP);
 		}
+		calculate_value_ptr->new_def = FALSE;
+	}
+	rate_moles = NAN;
+	calculate_value_ptr->calculated = CALCULATING;
+	if (interp.basic_run
+		(l_command, calculate_value_ptr->linebase,
+		calculate_value_ptr->varbase, calculate_value_ptr->loopbase) != 0)
+	{
+		error_string = sformatf( "Fatal Basic error in calculate_value %s.",
+			calculate_value_ptr->name);
+		error_msg(error_string, STOP);
+	}
+	if (std::isnan(rate_moles))
+	{
+		error_string = sformatf( "Calculated value not SAVEed for %s.",
+			calculate_value_ptr->name);
+		error_msg(error_string, STOP);
+	}
+	else
+	{
+		calculate_value_ptr->calculated = TRUE;
+		calculate_value_ptr->value = rate_moles;
+	}
+	/* may be called from a RATES program */
+	rate_moles = rate_moles_save;
+	return (calculate_value_ptr->value);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+isotope_ratio_calculate(class isotope_ratio *isotope_ratio_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Sets ratio and converted_ratio, if not set since the system last
+ *   changed. Ratios of isotopes not in the system are left unchanged.
+ */
+	if (pr.isotope_ratios == FALSE || isotope_ratio_ptr->calculated == TRUE)
+		return (OK);
+	isotope_ratio_ptr->calculated = TRUE;
+	class master_isotope *master_isotope_ptr =
+		master_isotope_search(isotope_ratio_ptr->isotope_name);
+	if (master_isotope_ptr->master->s->in == FALSE)
+		return (OK);
+	class calculate_value *calculate_value_ptr = calculate_value_search(isotope_ratio_ptr->name);
+	LDBLE value = calculate_value_get(calculate_value_ptr);
+	/*
+	 *  Calculate converted isotope ratio
+	 */
+	if (value == MISSING)
+	{
+		isotope_ratio_ptr->ratio = MISSING;
+		isotope_ratio_ptr->converted_ratio = MISSING;
 	}
+	else
+	{
+		isotope_ratio_ptr->ratio = value;
+		isotope_ratio_ptr->converted_ratio =
+			convert_isotope(master_isotope_ptr, value);
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+isotope_alpha_calculate(class isotope_alpha *isotope_alpha_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Sets value, if not set since the system last changed.
+ */
+	if (pr.isotope_alphas == FALSE || isotope_alpha_ptr->calculated == TRUE)
+		return (OK);
+	isotope_alpha_ptr->calculated = TRUE;
+	class calculate_value *calculate_value_ptr = calculate_value_search(isotope_alpha_ptr->name);
+	isotope_alpha_ptr->value = calculate_value_get(calculate_value_ptr);
 	return (OK);
 }
 /* ---------------------------------------------------------------------- */
@@ -3,6 +3,7 @@
 #include "phqalloc.h"
 
 #include <time.h>
+#include <float.h>
 
 #include "StorageBin.h"
 #include "Reaction.h"
@@ -89,6 +90,8 @@ calc_kinetic_reaction(cxxKinetics *kinetics_ptr, LDBLE time_step)
 		}
 		else
 		{
+			/* values for CALC_VALUE may depend on M, M0 and PARM of this rate */
+			calculate_values();
 			rate_moles = NAN;
 			rate_m = kinetics_comp_ptr->Get_m();
 			rate_m0 = kinetics_comp_ptr->Get_m0();
@@ -150,20 +153,24 @@ calc_final_kinetic_reaction(cxxKinetics *kinetics_ptr)
  *	stored in moles in run_kinetics
  */
 	LDBLE coef;
-	class phase *phase_ptr;
-	class master *master_ptr;
 	int count= 0;
 /*
- *   Go through list and generate list of elements and
- *   coefficient of elements in reaction
+ *   Element stoichiometry is compiled once per integration;
+ *   the reaction is the matrix times the moles of each component
  */
+	const class kinetics_stoichiometry &stoich = kinetics_stoichiometry_get(kinetics_ptr);
+	size_t n_elts = stoich.elts.size();
+	std::vector<LDBLE> &column = kinetics_stoich_column;
+	std::vector<bool> &column_present = kinetics_stoich_present;
+	std::vector<LDBLE> &totals = kinetics_stoich_totals;
+	std::vector<bool> &totals_present = kinetics_stoich_totals_present;
 RESTART:   // if limiting rates, jump to here
 	count++;
 	kinetics_ptr->Get_totals().clear();
+	totals.assign(n_elts, 0.0);
+	totals_present.assign(n_elts, false);
 	for (size_t i = 0; i < kinetics_ptr->Get_kinetics_comps().size(); i++)
 	{
-		count_elts = 0;
-		paren_count = 0;
 		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[i]);
 		if (kinetics_comp_ptr->Get_moles() > m_temp[i])
 		{
@@ -173,36 +180,143 @@ RESTART:   // if limiting rates, jump to here
 		coef = kinetics_comp_ptr->Get_moles();
 		if (coef == 0.0)
 			continue;
+		const LDBLE *stoich_column = (n_elts > 0) ? &stoich.matrix[i * n_elts] : NULL;
+		column.assign(n_elts, 0.0);
+		column_present.assign(n_elts, false);
+		for (size_t r = 0; r < n_elts; r++)
+		{
+			if (stoich.present[i * n_elts + r])
+			{
+				column[r] = coef * stoich_column[r];
+				column_present[r] = true;
+			}
+		}
+		for (size_t j = 0; j < stoich.surfaces.size(); j++)
+		{
+			const kinetics_stoichiometry::related_surface &surf = stoich.surfaces[j];
+			if (surf.comp != i)
+				continue;
+			/* Surface = 0 when m becomes low ...
+			*/
+			if (0.9 * surf.proportion * (kinetics_comp_ptr->Get_m()) < MIN_RELATED_SURFACE)
+			{
+				if (surf.master_ptr != NULL)
+				{
+					surf.master_ptr->total = 0.0;
+				}
+			}
+			else
+			{
+				for (size_t k = 0; k < surf.rows.size(); k++)
+				{
+					column[surf.rows[k]] += coef * surf.coefs[k];
+					column_present[surf.rows[k]] = true;
+				}
+			}
+		}
+		cxxNameDouble moles_of_reaction;
+		for (size_t r = 0; r < n_elts; r++)
+		{
+			if (column_present[r])
+			{
+				moles_of_reaction[stoich.elts[r]->name] = column[r];
+				totals[r] += column[r];
+				totals_present[r] = true;
+			}
+		}
+		kinetics_comp_ptr->Set_moles_of_reaction(moles_of_reaction);
+	}
+	for (size_t r = 0; r < n_elts; r++)
+	{
+		if (totals_present[r])
+		{
+			kinetics_ptr->Get_totals()[stoich.elts[r]->name] = totals[r];
+		}
+	}
+	if (count > 2)
+	{
+#if !defined(R_SO)
+		fprintf(stderr, "Too many limit_rates-.\n");
+#else
+		error_msg("Too many limit_rates-.\n");
+#endif
+	}
+	else
+	{
+		if (limit_rates(kinetics_ptr))
+			goto RESTART;
+	}
+	if (count > 2)
+	{
+#if !defined(R_SO)
+		fprintf(stderr, "Too many limit_rates+.\n");
+#else
+		error_msg("Too many limit_rates+.\n");
+#endif
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+const class kinetics_stoichiometry & Phreeqc::
+kinetics_stoichiometry_get(cxxKinetics *kinetics_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns the element stoichiometry of the kinetic reactions per mole
+ *   of reaction: the -formula of each component, less the formulas of
+ *   related exchangers, and, separately, of related surfaces.
+ *   Compiled on first use in run_reactions and reused for every
+ *   Runge-Kutta stage and CVODE function evaluation.
+ */
+	class kinetics_stoichiometry &stoich = kinetics_stoich;
+	cxxExchange *exchange_ptr = use.Get_exchange_ptr();
+	cxxSurface *surface_ptr = use.Get_surface_ptr();
+	if (stoich.kinetics_ptr == kinetics_ptr &&
+		stoich.exchange_ptr == exchange_ptr &&
+		stoich.surface_ptr == surface_ptr &&
+		stoich.count_comps == kinetics_ptr->Get_kinetics_comps().size())
+	{
+		return stoich;
+	}
+	stoich = kinetics_stoichiometry();
+	stoich.kinetics_ptr = kinetics_ptr;
+	stoich.exchange_ptr = exchange_ptr;
+	stoich.surface_ptr = surface_ptr;
+	stoich.count_comps = kinetics_ptr->Get_kinetics_comps().size();
+
+	std::vector< std::vector<size_t> > comp_rows(stoich.count_comps);
+	std::vector< std::vector<LDBLE> > comp_coefs(stoich.count_comps);
+	for (size_t i = 0; i < stoich.count_comps; i++)
+	{
+		count_elts = 0;
+		paren_count = 0;
+		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[i]);
 /*
  *   Reactant is a pure phase, copy formula into token
  */
 		cxxNameDouble::iterator it = kinetics_comp_ptr->Get_namecoef().begin();
-		for ( ; it != kinetics_comp_ptr->Get_namecoef().end(); it++)	
+		for ( ; it != kinetics_comp_ptr->Get_namecoef().end(); it++)
 		{
 			std::string name = it->first;
 			LDBLE coef1 = it->second;
-			phase_ptr = NULL;
 			int k;
-			phase_ptr = phase_bsearch(name.c_str(), &k, FALSE);
+			class phase *phase_ptr = phase_bsearch(name.c_str(), &k, FALSE);
 			if (phase_ptr != NULL)
 			{
-				add_elt_list(phase_ptr->next_elt,
-							 coef *coef1);
+				add_elt_list(phase_ptr->next_elt, coef1);
 			}
 			else
 			{
 				const char* ptr = name.c_str();
-				if (get_elts_in_species(&ptr, coef * coef1) == ERROR)
+				if (get_elts_in_species(&ptr, coef1) == ERROR)
 				{
 					error_string = sformatf("Error in -formula: %s", name.c_str());
 					error_msg(error_string, CONTINUE);
 				}
 			}
 		}
-		if (use.Get_exchange_ptr() != NULL
-			&& use.Get_exchange_ptr()->Get_related_rate())
+		if (exchange_ptr != NULL && exchange_ptr->Get_related_rate())
 		{
-			cxxExchange * exchange_ptr = use.Get_exchange_ptr();
 			for(size_t j = 0; j < exchange_ptr->Get_exchange_comps().size(); j++)
 			{
 				std::string name(exchange_ptr->Get_exchange_comps()[j].Get_rate_name());
@@ -215,7 +329,7 @@ RESTART:   // if limiting rates, jump to here
 						/* found kinetics component */
 						std::string formula = exchange_ptr->Get_exchange_comps()[j].Get_formula().c_str();
 						const char* ptr = formula.c_str();
-						if (get_elts_in_species(&ptr, -coef*exchange_ptr->Get_exchange_comps()[j].Get_phase_proportion()) == ERROR)
+						if (get_elts_in_species(&ptr, -exchange_ptr->Get_exchange_comps()[j].Get_phase_proportion()) == ERROR)
 						{
 							error_string = sformatf("Error in -formula: %s", formula.c_str());
 							error_msg(error_string, CONTINUE);
@@ -223,13 +337,22 @@ RESTART:   // if limiting rates, jump to here
 					}
 				}
 			}
-
 		}
-		if (use.Get_surface_ptr() != NULL && use.Get_surface_ptr()->Get_related_rate())
+		for (int l = 0; l < count_elts; l++)
+		{
+			size_t r = 0;
+			while (r < stoich.elts.size() && stoich.elts[r] != elt_list[l].elt)
+				r++;
+			if (r == stoich.elts.size())
+				stoich.elts.push_back(elt_list[l].elt);
+			comp_rows[i].push_back(r);
+			comp_coefs[i].push_back(elt_list[l].coef);
+		}
+		if (surface_ptr != NULL && surface_ptr->Get_related_rate())
 		{
-			for (size_t j = 0; j < use.Get_surface_ptr()->Get_surface_comps().size(); j++)
+			for (size_t j = 0; j < surface_ptr->Get_surface_comps().size(); j++)
 			{
-				cxxSurfaceComp *surface_comp_ptr = &(use.Get_surface_ptr()->Get_surface_comps()[j]);
+				cxxSurfaceComp *surface_comp_ptr = &(surface_ptr->Get_surface_comps()[j]);
 				if (surface_comp_ptr->Get_rate_name().size() > 0)
 				{
 					if (strcmp_nocase
@@ -237,56 +360,47 @@ RESTART:   // if limiting rates, jump to here
 						surface_comp_ptr->Get_rate_name().c_str()) == 0)
 					{
 						/* found kinetics component */
+						kinetics_stoichiometry::related_surface surf;
+						surf.comp = i;
+						surf.proportion = surface_comp_ptr->Get_phase_proportion();
+						surf.master_ptr = master_bsearch(surface_comp_ptr->Get_master_element().c_str());
 						std::string temp_formula = surface_comp_ptr->Get_formula().c_str();
 						const char* cptr = temp_formula.c_str();
-						/* Surface = 0 when m becomes low ...
-						*/
-						if (0.9 * surface_comp_ptr->Get_phase_proportion() *
-							(kinetics_comp_ptr->Get_m()) < MIN_RELATED_SURFACE)
+						count_elts = 0;
+						paren_count = 0;
+						if (get_elts_in_species(&cptr, -surf.proportion) == ERROR)
 						{
-							master_ptr = master_bsearch(surface_comp_ptr->Get_master_element().c_str());
-							if (master_ptr != NULL) 
-							{
-								master_ptr->total = 0.0;
-							}
+							error_string = sformatf("Error in -formula: %s", temp_formula.c_str());
+							error_msg(error_string, CONTINUE);
 						}
-						else
+						for (int l = 0; l < count_elts; l++)
 						{
-							if (get_elts_in_species(&cptr, -coef * surface_comp_ptr->Get_phase_proportion()) == ERROR)
-							{
-								error_string = sformatf("Error in -formula: %s", temp_formula.c_str());
-								error_msg(error_string, CONTINUE);
-							}
+							size_t r = 0;
+							while (r < stoich.elts.size() && stoich.elts[r] != elt_list[l].elt)
+								r++;
+							if (r == stoich.elts.size())
+								stoich.elts.push_back(elt_list[l].elt);
+							surf.rows.push_back(r);
+							surf.coefs.push_back(elt_list[l].coef);
 						}
+						stoich.surfaces.push_back(surf);
 					}
 				}
 			}
 		}
-		kinetics_comp_ptr->Set_moles_of_reaction(elt_list_NameDouble());
-		kinetics_ptr->Get_totals().add_extensive(kinetics_comp_ptr->Get_moles_of_reaction(), 1.0);	
-	}
-	if (count > 2)
-	{
-#if !defined(R_SO)
-		fprintf(stderr, "Too many limit_rates-.\n");
-#else
-		error_msg("Too many limit_rates-.\n");
-#endif
-	}
-	else
-	{
-		if (limit_rates(kinetics_ptr))
-			goto RESTART;
 	}
-	if (count > 2)
+	size_t n_elts = stoich.elts.size();
+	stoich.matrix.assign(n_elts * stoich.count_comps, 0.0);
+	stoich.present.assign(n_elts * stoich.count_comps, false);
+	for (size_t i = 0; i < stoich.count_comps; i++)
 	{
-#if !defined(R_SO)
-		fprintf(stderr, "Too many limit_rates+.\n");
-#else
-		error_msg("Too many limit_rates+.\n");
-#endif
+		for (size_t k = 0; k < comp_rows[i].size(); k++)
+		{
+			stoich.matrix[i * n_elts + comp_rows[i][k]] += comp_coefs[i][k];
+			stoich.present[i * n_elts + comp_rows[i][k]] = true;
+		}
 	}
-	return (OK);
+	return stoich;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -546,6 +660,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 					delete ss_assemblage_save;
 					ss_assemblage_save = NULL;
 				}
+				step_ok++;	/* equal rates, the whole interval is one step */
 				goto EQUAL_RATE_OUT;
 			}
 			else
@@ -680,6 +795,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 				Rxn_ss_assemblage_map[ss_assemblage_save->Get_n_user()] = *ss_assemblage_save;
 				use.Set_ss_assemblage_ptr(Utilities::Rxn_find(Rxn_ss_assemblage_map, ss_assemblage_save->Get_n_user()));
 			}
+			step_ok++;	/* equal rates, the whole interval is one step */
 			goto EQUAL_RATE_OUT;
 		}
 /*
@@ -803,6 +919,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 				delete ss_assemblage_save;
 				ss_assemblage_save = NULL;
 				}
+			step_ok++;	/* equal rates, the whole interval is one step */
 			goto EQUAL_RATE_OUT;
 		}
 /*
@@ -1114,6 +1231,12 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 
 	rate_sim_time = rate_sim_time_start + kin_time;
 	use.Set_kinetics_in(true);
+	if (cell_cost_ptr(i) != NULL)
+	{
+		cell_cost_ptr(i)->kinetic_steps += step_ok + step_bad;
+	}
+	run_stats.rk_steps += step_ok;
+	run_stats.rk_rejected += step_bad;
 
 	/*  Free space */
 
@@ -1150,6 +1273,11 @@ set_and_run_wrapper(int i, int use_mix, int use_kinetics, int nsaver,
 	std::auto_ptr<cxxKinetics> kinetics_save(NULL);
 #endif
 	int restart = 0;
+	int attempts = 0, solve_iterations = 0;
+	class cell_cost *cost_ptr = cell_cost_ptr(i);
+	cell_cost_scope cost_scope(cost_ptr, cell_cost_depth);
+	LDBLE solve_start;
+	std::string capture_input;
 	
 	small_pe_step = 5.;
 	small_step = 10.;
@@ -1203,6 +1331,11 @@ set_and_run_wrapper(int i, int use_mix, int use_kinetics, int nsaver,
 	}
 	max_try = (max_tries < max_try) ? max_tries : max_try;
 	/*max_try = 1; */
+	if ((capture_iterations > 0 || capture_time > 0) && capture_count < capture_max)
+	{
+		capture_input = slow_cell_input(use_kinetics, step_fraction);
+	}
+	solve_start = PhaseCounters::Wall_time();
 
 restart:
 	for (j = 0; j < max_try; j++)
@@ -1417,9 +1550,19 @@ restart:
 			}
 		}
 		set_and_run_attempt = j;
+		if (j < RS_ATTEMPT_COUNT)
+		{
+			run_stats.attempts[j]++;
+		}
 
 		converge =
 			set_and_run(i, use_mix, use_kinetics, nsaver, step_fraction);
+		attempts++;
+		solve_iterations += iterations;
+		if (cost_ptr != NULL)
+		{
+			cost_ptr->iterations += iterations;
+		}
 		/* reset values */
 		diagonal_scale = old_diag;
 		itmax = old_itmax;
@@ -1443,6 +1586,25 @@ restart:
 		warning_msg
 			("Numerical method failed with this set of convergence parameters.\n");
 	}
+	if (cost_ptr != NULL)
+	{
+		cost_ptr->solves++;
+		cost_ptr->retries += (attempts > 0) ? attempts - 1 : 0;
+	}
+	if (capture_input.size() > 0)
+	{
+		LDBLE solve_time = PhaseCounters::Wall_time() - solve_start;
+		if ((capture_iterations > 0 && solve_iterations >= capture_iterations) ||
+			(capture_time > 0 && solve_time >= capture_time))
+		{
+			slow_cell_capture(i, capture_input, solve_iterations,
+				(attempts > 0) ? attempts - 1 : 0, solve_time);
+		}
+	}
+	if (converge == FALSE)
+	{
+		run_stats.failures++;
+	}
 	if (converge == FALSE && use.Get_kinetics_ptr() != NULL
 		&& use.Get_kinetics_ptr()->Get_use_cvode())
 	{
@@ -1491,6 +1653,199 @@ restart:
 	return (OK);
 }
 
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+cell_costs_reset(int count)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Clears the solve-cost counters for a TRANSPORT or ADVECTION run,
+ *   one entry per cell, indexed like cell_data
+ */
+	cell_costs.clear();
+	cell_costs.resize((size_t) ((count > 0) ? count : 0));
+}
+/* ---------------------------------------------------------------------- */
+class cell_cost * Phreeqc::
+cell_cost_ptr(int i)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns the cost counters of cell i, or NULL if costs are not
+ *   being collected for the current calculation
+ */
+	if ((state == TRANSPORT || state == ADVECTION) &&
+		i >= 0 && (size_t) i < cell_costs.size())
+	{
+		return &cell_costs[(size_t) i];
+	}
+	return (NULL);
+}
+/* ---------------------------------------------------------------------- */
+std::string Phreeqc::
+slow_cell_input(int use_kinetics, LDBLE step_fraction)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Writes the reactants of the calculation that is about to be made
+ *   as stand-alone input: KNOBS, raw entities and USE lines.
+ *   The current step of the irreversible reaction and, when use_kinetics
+ *   is true, the kinetic totals that have already been integrated are
+ *   written as one REACTION in place of USE kinetics, so that the replay
+ *   makes the same equilibrium calculation.
+ */
+	std::ostringstream oss;
+	cxxStorageBin capture_bin(this->Get_phrq_io());
+	Use2cxxStorageBin(capture_bin);
+	// the calculation uses the working copies that use points to, such as
+	// solution -1 of a batch reaction, which already hold earlier substeps
+	if (!use.Get_mix_in() && use.Get_solution_ptr() != NULL)
+		capture_bin.Set_Solution(use.Get_n_solution_user(), use.Get_solution_ptr());
+	if (use.Get_pp_assemblage_ptr() != NULL)
+		capture_bin.Set_PPassemblage(use.Get_n_pp_assemblage_user(), use.Get_pp_assemblage_ptr());
+	if (use.Get_exchange_ptr() != NULL)
+		capture_bin.Set_Exchange(use.Get_n_exchange_user(), use.Get_exchange_ptr());
+	if (use.Get_surface_ptr() != NULL)
+		capture_bin.Set_Surface(use.Get_n_surface_user(), use.Get_surface_ptr());
+	if (use.Get_gas_phase_ptr() != NULL)
+		capture_bin.Set_GasPhase(use.Get_n_gas_phase_user(), use.Get_gas_phase_ptr());
+	if (use.Get_ss_assemblage_ptr() != NULL)
+		capture_bin.Set_SSassemblage(use.Get_n_ss_assemblage_user(), use.Get_ss_assemblage_ptr());
+	bool fold_reaction = (use.Get_reaction_in() && use.Get_reaction_ptr() != NULL);
+	bool fold_kinetics = (use_kinetics == TRUE &&
+		use.Get_kinetics_in() && use.Get_kinetics_ptr() != NULL);
+	int n_reaction = fold_reaction ? use.Get_n_reaction_user() : use.Get_n_kinetics_user();
+	cxxNameDouble step_totals;
+	if (fold_reaction)
+	{
+		cxxReaction *reaction_ptr = use.Get_reaction_ptr();
+		reaction_calc(reaction_ptr);
+		step_totals.add_extensive(reaction_ptr->Get_elementList(),
+			reaction_step_moles(reaction_ptr, reaction_step) * step_fraction);
+		capture_bin.Remove_Reaction(use.Get_n_reaction_user());
+	}
+	if (fold_kinetics)
+	{
+		step_totals.add_extensive(use.Get_kinetics_ptr()->Get_totals(), 1.0);
+	}
+	// kinetics are either folded or not part of this calculation
+	if (use.Get_kinetics_in())
+		capture_bin.Remove_Kinetics(use.Get_n_kinetics_user());
+
+	oss.precision(DBL_DIG - 1);
+	oss << "KNOBS\n";
+	oss << "\t-iterations            " << itmax << "\n";
+	oss << "\t-tolerance             " << ineq_tol << "\n";
+	oss << "\t-convergence_tolerance " << convergence_tolerance << "\n";
+	oss << "\t-step_size             " << step_size << "\n";
+	oss << "\t-pe_step_size          " << pe_step_size << "\n";
+	oss << "\t-scale_pure_phases     " << pp_scale << "\n";
+	oss << "\t-diagonal_scale        " << ((diagonal_scale == TRUE) ? "true" : "false") << "\n";
+	oss << "\t-delay_mass_water      " << ((delay_mass_water == TRUE) ? "true" : "false") << "\n";
+	oss << "\t-line_search           " << ((line_search == TRUE) ? "true" : "false") << "\n";
+	oss << "\t-threads               " << loop_threads.Get_threads() << "\n";
+	oss << "\t-thread_threshold      " << loop_threads.Get_threshold() << "\n";
+	oss << "\t-numerical_derivatives " << ((numerical_deriv == TRUE) ? "true" : "false") << "\n";
+	oss << "\t-numerical_fixed_volume " << (numerical_fixed_volume ? "true" : "false") << "\n";
+	oss << "\t-force_numerical_fixed_volume " << (force_numerical_fixed_volume ? "true" : "false") << "\n";
+	oss << "\t-equi_delay            " << equi_delay << "\n";
+	oss << "\t-tries                 " << max_tries << "\n";
+	oss << "\t-minimum_total         " << MIN_TOTAL << "\n";
+	capture_bin.dump_raw(oss, 0);
+	// cxxStorageBin::dump_raw does not write pressures
+	if (use.Get_pressure_in())
+	{
+		cxxPressure *pressure_ptr = capture_bin.Get_Pressure(use.Get_n_pressure_user());
+		if (pressure_ptr != NULL)
+		{
+			pressure_ptr->dump_raw(oss, 0);
+		}
+	}
+	if (step_totals.size() > 0)
+	{
+		oss << "REACTION " << n_reaction << " Step " << reaction_step;
+		if (fold_reaction)
+			oss << " of reaction " << use.Get_n_reaction_user();
+		if (fold_kinetics)
+			oss << (fold_reaction ? " and" : "") << " kinetics " << use.Get_n_kinetics_user();
+		oss << "\n";
+		cxxNameDouble::const_iterator it = step_totals.begin();
+		for (; it != step_totals.end(); it++)
+		{
+			oss << "\t" << it->first << "  " << it->second << "\n";
+		}
+		oss << "\t1 moles\n";
+	}
+	if (use.Get_mix_in())
+		oss << "USE mix " << use.Get_n_mix_user() << "\n";
+	else if (use.Get_solution_in())
+		oss << "USE solution " << use.Get_n_solution_user() << "\n";
+	if (use.Get_pp_assemblage_in())
+		oss << "USE equilibrium_phases " << use.Get_n_pp_assemblage_user() << "\n";
+	if (use.Get_exchange_in())
+		oss << "USE exchange " << use.Get_n_exchange_user() << "\n";
+	if (use.Get_surface_in())
+		oss << "USE surface " << use.Get_n_surface_user() << "\n";
+	if (use.Get_gas_phase_in())
+		oss << "USE gas_phase " << use.Get_n_gas_phase_user() << "\n";
+	if (use.Get_ss_assemblage_in())
+		oss << "USE solid_solutions " << use.Get_n_ss_assemblage_user() << "\n";
+	if (step_totals.size() > 0)
+		oss << "USE reaction " << n_reaction << "\n";
+	if (use.Get_temperature_in())
+		oss << "USE reaction_temperature " << use.Get_n_temperature_user() << "\n";
+	if (use.Get_pressure_in())
+		oss << "USE reaction_pressure " << use.Get_n_pressure_user() << "\n";
+	oss << "END\n";
+	return oss.str();
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+slow_cell_capture(int i, const std::string& input, int l_iterations,
+				  int retries, LDBLE seconds)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Writes a replay file for a calculation that exceeded the KNOBS
+ *   -capture_iterations or -capture_time threshold
+ */
+	const char *state_name;
+	switch (state)
+	{
+	case TRANSPORT:
+		state_name = "TRANSPORT";
+		break;
+	case ADVECTION:
+		state_name = "ADVECTION";
+		break;
+	case REACTION:
+		state_name = "REACTION";
+		break;
+	default:
+		state_name = "OTHER";
+		break;
+	}
+	capture_count++;
+	std::string file_name = sformatf("%s_%d.pqi", capture_prefix.c_str(), capture_count);
+	std::ofstream capture_file(file_name.c_str());
+	if (!capture_file.is_open())
+	{
+		error_string = sformatf("Could not open slow-cell capture file %s.", file_name.c_str());
+		warning_msg(error_string);
+		return;
+	}
+	capture_file << "# Slow-cell capture " << capture_count << "\n";
+	capture_file << "#   simulation " << simulation << ", " << state_name;
+	if (state == TRANSPORT || state == ADVECTION)
+		capture_file << ", cell " << i << "\n";
+	else
+		capture_file << ", solution " << use.Get_n_solution_user() << "\n";
+	capture_file << "#   iterations " << l_iterations << ", retries " << retries
+		<< ", seconds " << seconds << "\n";
+	capture_file << "#   database_hash " << (database_hash.size() > 0 ? database_hash.c_str() : "unknown") << "\n";
+	capture_file << input;
+	capture_file.close();
+}
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 set_and_run(int i, int use_mix, int use_kinetics, int nsaver,
@@ -1992,6 +2347,10 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 	realtype ropt[OPT_SIZE], reltol, t, tout, tout1, sum_t;
 	long int iopt[OPT_SIZE];
 	int flag;
+	class cell_cost *cost_ptr = cell_cost_ptr(i);
+	cell_cost_scope cost_scope(cost_ptr, cell_cost_depth);
+	/* recompile the kinetic stoichiometry for this cell */
+	kinetics_stoich = kinetics_stoichiometry();
 /*
  *   Set nsaver
  */
@@ -2194,6 +2553,11 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 			/*ropt[HMIN] = 1e-17; */
 			use_save = use;
 			flag = CVode(kinetics_cvode_mem, tout, kinetics_y, &t, NORMAL);
+			if (cost_ptr != NULL)
+			{
+				cost_ptr->kinetic_steps += (int) iopt[NST];
+			}
+			run_stats.cvode_steps += (int) iopt[NST];
 			rate_sim_time = rate_sim_time_start + t;
 			/*
 			   printf("At t = %0.4e   y =%14.6e  %14.6e  %14.6e\n",
@@ -2273,6 +2637,11 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 				}
 				flag =
 					CVode(kinetics_cvode_mem, tout1, kinetics_y, &t, NORMAL);
+				if (cost_ptr != NULL)
+				{
+					cost_ptr->kinetic_steps += (int) iopt[NST];
+				}
+				run_stats.cvode_steps += (int) iopt[NST];
 				/*
 				   error_string = sformatf( "CVode failed, flag=%d.\n", flag);
 				   error_msg(error_string, STOP);
@@ -45,6 +45,11 @@ model(void)
  *	  An additional pass through may be needed if unstable phases still exist
  *		 in the phase assemblage.
  */
+	PhaseCounters::Scope model_scope(phase_counters, PhaseCounters::MODEL);
+	if (state >= 0 && state < RS_CALCULATION_COUNT)
+	{
+		run_stats.calculations[state]++;
+	}
 	int l_kode, return_kode;
 	int r;
 	int count_infeasible, count_basis_change;
@@ -66,6 +71,26 @@ model(void)
 		input_error++;
 		error_msg("Cannot use LLNL_AQUEOUS_MODEL_PARAMETERS with PITZER or SIT data blocks in same run (database + input file).", STOP);
 	}
+	if (line_search == TRUE)
+	{
+		/* line_search_step restores only the unknowns of model() */
+		if (pitzer_model == TRUE || sit_model == TRUE)
+		{
+			input_error++;
+			error_msg("KNOBS -line_search cannot be used with PITZER or SIT data blocks.", STOP);
+		}
+		if (dl_type_x != cxxSurface::NO_DL)
+		{
+			input_error++;
+			error_msg("KNOBS -line_search cannot be used with a diffuse-layer surface.", STOP);
+		}
+		if (gas_unknown != NULL && use.Get_gas_phase_ptr() != NULL &&
+			use.Get_gas_phase_ptr()->Get_type() == cxxGasPhase::GP_VOLUME)
+		{
+			input_error++;
+			error_msg("KNOBS -line_search cannot be used with a fixed-volume gas phase.", STOP);
+		}
+	}
 	if (pitzer_model == TRUE)
 	{
 
@@ -97,6 +122,7 @@ model(void)
 	count_basis_change = count_infeasible = 0;
 	stop_program = FALSE;
 	remove_unstable_phases = FALSE;
+	newton_step_save.saved = false;
 	for (;;)
 	{
 		mb_gases();
@@ -108,8 +134,16 @@ model(void)
 #if defined(PHREEQCI_GUI)
 			PhreeqcIWait(this);
 #endif
+/*
+ *   Take a shorter step if the last one increased the residuals
+ */
+			if (newton_step_save.saved && line_search_step(count_basis_change))
+			{
+				continue;
+			}
 			iterations++;
 			overall_iterations++;
+			run_stats.iterations++;
 			if (iterations > itmax - 1 && debug_model == FALSE
 				&& pr.logfile == TRUE)
 			{
@@ -173,6 +207,10 @@ model(void)
 				{
 					ineq(0);
 				}
+				if (line_search == TRUE && line_search_ok())
+				{
+					line_search_save(count_basis_change);
+				}
 				reset();
 			}
 			gammas(mu_x);
@@ -219,6 +257,7 @@ model(void)
 				break;
 			}
 		}
+		newton_step_save.saved = false;
 /*
  *   Check for stop_program
  */
@@ -267,6 +306,125 @@ model(void)
 	return (OK);
 }
 
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+line_search_ok(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Steps that remove unstable phases and the passes of the numerical
+ *   derivatives are always taken in full. model() rejects the models
+ *   whose state the line search does not restore.
+ */
+	if (remove_unstable_phases == TRUE || calculating_deriv)
+		return (false);
+	return (true);
+}
+
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+line_search_save(int count_basis_change)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Saves the unknowns and the Newton step from ineq before reset
+ */
+	class newton_step &ns = newton_step_save;
+	ns.saved = true;
+	ns.alpha = 1.0;
+	ns.merit = residual_merit();
+	ns.count_basis_change = count_basis_change;
+	ns.delta.assign(delta.begin(), delta.begin() + count_unknowns);
+	ns.la.resize(count_unknowns);
+	ns.moles.resize(count_unknowns);
+	ns.related_moles.resize(count_unknowns);
+	ns.grams.assign(count_unknowns, 0.0);
+	for (int i = 0; i < count_unknowns; i++)
+	{
+		ns.la[i] = (x[i]->master.size() > 0) ? x[i]->master[0]->s->la : 0.0;
+		ns.moles[i] = x[i]->moles;
+		ns.related_moles[i] = x[i]->related_moles;
+		if (x[i]->type == SURFACE_CB || x[i]->type == SURFACE_CB1
+			|| x[i]->type == SURFACE_CB2)
+		{
+			ns.grams[i] = use.Get_surface_ptr()->Find_charge(x[i]->surface_charge)->Get_grams();
+		}
+	}
+	ns.mu_x = mu_x;
+	ns.ah2o_x = ah2o_x;
+	ns.h2o_la = s_h2o->la;
+	ns.eminus_la = s_eminus->la;
+	ns.mass_water_aq_x = mass_water_aq_x;
+	ns.mass_water_bulk_x = mass_water_bulk_x;
+	ns.h2o_moles = s_h2o->moles;
+}
+
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+line_search_step(int count_basis_change)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Backtracking line search on the Newton step of the last iteration.
+ *   reset already limits the step, so only a step that increased
+ *   residual_merit more than tenfold is shortened: the unknowns are
+ *   restored and half the step is taken, at most four halvings. A
+ *   sufficient-decrease (Armijo) test rejected too many useful steps
+ *   near phase boundaries. Returns true if a shorter step was taken,
+ *   the residuals must then be calculated again.
+ */
+	class newton_step &ns = newton_step_save;
+	if (ns.count_basis_change != count_basis_change || stop_program == TRUE ||
+		ns.alpha < 0.1 ||
+		residual_merit() <= 10.0 * ns.merit)
+	{
+		ns.saved = false;
+		return (false);
+	}
+	ns.alpha *= 0.5;
+	for (int i = 0; i < count_unknowns; i++)
+	{
+		if (x[i]->master.size() > 0)
+			x[i]->master[0]->s->la = ns.la[i];
+		x[i]->moles = ns.moles[i];
+		x[i]->related_moles = ns.related_moles[i];
+		if (x[i]->type == SS_MOLES)
+		{
+			cxxSScomp *comp_ptr = (cxxSScomp *) x[i]->ss_comp_ptr;
+			comp_ptr->Set_moles(x[i]->moles);
+		}
+		else if (x[i]->type == SURFACE_CB || x[i]->type == SURFACE_CB1
+				 || x[i]->type == SURFACE_CB2)
+		{
+			cxxSurfaceCharge *charge_ptr = use.Get_surface_ptr()->Find_charge(x[i]->surface_charge);
+			charge_ptr->Set_grams(ns.grams[i]);
+		}
+		delta[i] = ns.alpha * ns.delta[i];
+	}
+	mu_x = ns.mu_x;
+	ah2o_x = ns.ah2o_x;
+	s_h2o->la = ns.h2o_la;
+	s_eminus->la = ns.eminus_la;
+	mass_water_aq_x = ns.mass_water_aq_x;
+	mass_water_bulk_x = ns.mass_water_bulk_x;
+	s_h2o->moles = ns.h2o_moles;
+	run_stats.line_searches++;
+	if (debug_model == TRUE)
+	{
+		output_msg(sformatf("\nLine search, step %g\n", (double) ns.alpha));
+	}
+	reset();
+	gammas(mu_x);
+	if (molalities(FALSE) == ERROR)
+	{
+		revise_guesses();
+	}
+	mb_sums();
+	mb_gases();
+	mb_ss();
+	return (true);
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 check_residuals(void)
@@ -545,6 +703,103 @@ check_residuals(void)
 	}
 	return (return_value);
 }
+class gammas_loop_cookie
+{
+public:
+	Phreeqc *phreeqc;
+	const class gammas_constants *constants;
+};
+
+/* ---------------------------------------------------------------------- */
+static void
+gammas_loop(void *cookie, int first, int last)
+/* ---------------------------------------------------------------------- */
+{
+	gammas_loop_cookie *c = (gammas_loop_cookie *) cookie;
+	c->phreeqc->gammas_species(*c->constants, first, last);
+}
+
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+gammas_species(const class gammas_constants &c, int first, int last)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Activity coefficients of the aqueous species first to last - 1 of
+ *   s_x; exchange and surface species are left to gammas. Writes lg and
+ *   dg of these species only, so blocks can run on different threads.
+ */
+	for (int i = first; i < last; i++)
+	{
+		switch (s_x[i]->gflag)
+		{
+		case 0:				/* uncharged */
+			s_x[i]->lg = s_x[i]->dhb * c.mu;
+			s_x[i]->dg = s_x[i]->dhb * LOG_10 * s_x[i]->moles;
+			break;
+		case 1:				/* Davies */
+			s_x[i]->lg = -s_x[i]->z * s_x[i]->z * c.a *
+				(c.muhalf / (1.0 + c.muhalf) - 0.3 * c.mu);
+			s_x[i]->dg = c.c1 * s_x[i]->z * s_x[i]->z * s_x[i]->moles;
+			break;
+		case 2:				/* Extended D-H, WATEQ D-H */
+			s_x[i]->lg = -c.a * c.muhalf * s_x[i]->z * s_x[i]->z /
+				(1.0 + s_x[i]->dha * c.b * c.muhalf) + s_x[i]->dhb * c.mu;
+			s_x[i]->dg = (c.c2 * s_x[i]->z * s_x[i]->z /
+						  ((1.0 + s_x[i]->dha * c.b * c.muhalf) * (1.0 +
+															   s_x[i]->dha *
+															   c.b * c.muhalf)) +
+						  s_x[i]->dhb) * LOG_10 * s_x[i]->moles;
+/*			if (mu_x < 1e-6) s_x[i]->dg = 0.0; */
+			break;
+		case 3:				/* Always 1.0 */
+			s_x[i]->lg = 0.0;
+			s_x[i]->dg = 0.0;
+			break;
+		case 5:				/* Always 1.0 */
+			s_x[i]->lg = 0.0;
+			s_x[i]->dg = 0.0;
+			break;
+		case 7:				/* LLNL */
+			if (llnl_temp.size() > 0)
+			{
+				if (s_x[i]->z == 0)
+				{
+					s_x[i]->lg = 0.0;
+					s_x[i]->dg = 0.0;
+				}
+				else
+				{
+					s_x[i]->lg = -a_llnl * c.muhalf * s_x[i]->z * s_x[i]->z /
+						(1.0 + s_x[i]->dha * b_llnl * c.muhalf) +
+						bdot_llnl * c.mu;
+					s_x[i]->dg =
+						(c.c2_llnl * s_x[i]->z * s_x[i]->z /
+						 ((1.0 + s_x[i]->dha * b_llnl * c.muhalf) * (1.0 +
+																   s_x[i]->
+																   dha *
+																   b_llnl *
+																   c.muhalf)) +
+						 bdot_llnl) * LOG_10 * s_x[i]->moles;
+					break;
+				}
+			}
+			break;
+		case 8:				/* LLNL CO2 */
+			if (llnl_temp.size() > 0)
+			{
+				s_x[i]->lg = c.log_g_co2;
+				s_x[i]->dg = c.dln_g_co2 * s_x[i]->moles;
+			}
+			break;
+		case 9:				/* activity water */
+			s_x[i]->lg = log10(exp(s_h2o->la * LOG_10) * gfw_water);
+			s_x[i]->dg = 0.0;
+			break;
+		}
+	}
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 gammas(LDBLE mu)
@@ -554,6 +809,7 @@ gammas(LDBLE mu)
  *   Calculates gammas and [moles * d(ln gamma)/d mu] for all aqueous
  *   species.
  */
+	PhaseCounters::Scope gammas_scope(phase_counters, PhaseCounters::GAMMAS);
 	int i, j;
 	int ifirst, ilast;
 	LDBLE f, log_g_co2, dln_g_co2, c2_llnl;
@@ -643,35 +899,30 @@ gammas(LDBLE mu)
 	}
 
 /*
- *   Calculate activity coefficients
+ *   Calculate activity coefficients of aqueous species, on the loop
+ *   threads for large models
+ */
+	class gammas_constants c;
+	c.mu = mu;
+	c.a = a;
+	c.b = b;
+	c.muhalf = muhalf;
+	c.c1 = c1;
+	c.c2 = c2;
+	c.c2_llnl = c2_llnl;
+	c.log_g_co2 = log_g_co2;
+	c.dln_g_co2 = dln_g_co2;
+	class gammas_loop_cookie cookie;
+	cookie.phreeqc = this;
+	cookie.constants = &c;
+	loop_threads.Run((int)this->s_x.size(), gammas_loop, &cookie);
+/*
+ *   Exchange and surface species
  */
 	for (i = 0; i < (int)this->s_x.size(); i++)
 	{
 		switch (s_x[i]->gflag)
 		{
-		case 0:				/* uncharged */
-			s_x[i]->lg = s_x[i]->dhb * mu;
-			s_x[i]->dg = s_x[i]->dhb * LOG_10 * s_x[i]->moles;
-			break;
-		case 1:				/* Davies */
-			s_x[i]->lg = -s_x[i]->z * s_x[i]->z * a *
-				(muhalf / (1.0 + muhalf) - 0.3 * mu);
-			s_x[i]->dg = c1 * s_x[i]->z * s_x[i]->z * s_x[i]->moles;
-			break;
-		case 2:				/* Extended D-H, WATEQ D-H */
-			s_x[i]->lg = -a * muhalf * s_x[i]->z * s_x[i]->z /
-				(1.0 + s_x[i]->dha * b * muhalf) + s_x[i]->dhb * mu;
-			s_x[i]->dg = (c2 * s_x[i]->z * s_x[i]->z /
-						  ((1.0 + s_x[i]->dha * b * muhalf) * (1.0 +
-															   s_x[i]->dha *
-															   b * muhalf)) +
-						  s_x[i]->dhb) * LOG_10 * s_x[i]->moles;
-/*			if (mu_x < 1e-6) s_x[i]->dg = 0.0; */
-			break;
-		case 3:				/* Always 1.0 */
-			s_x[i]->lg = 0.0;
-			s_x[i]->dg = 0.0;
-			break;
 		case 4:				/* Exchange */
 /*
  *   Find CEC
@@ -774,10 +1025,6 @@ gammas(LDBLE mu)
 					gammas_a_f(i); // appt
 			}
 			break;
-		case 5:				/* Always 1.0 */
-			s_x[i]->lg = 0.0;
-			s_x[i]->dg = 0.0;
-			break;
 		case 6:				/* Surface */
 /*
  *   Find moles of sites.
@@ -813,49 +1060,12 @@ gammas(LDBLE mu)
 			}
 			break;
 		case 7:				/* LLNL */
-			if (llnl_temp.size() > 0)
-			{
-				if (s_x[i]->z == 0)
-				{
-					s_x[i]->lg = 0.0;
-					s_x[i]->dg = 0.0;
-				}
-				else
-				{
-					s_x[i]->lg = -a_llnl * muhalf * s_x[i]->z * s_x[i]->z /
-						(1.0 + s_x[i]->dha * b_llnl * muhalf) +
-						bdot_llnl * mu;
-					s_x[i]->dg =
-						(c2_llnl * s_x[i]->z * s_x[i]->z /
-						 ((1.0 + s_x[i]->dha * b_llnl * muhalf) * (1.0 +
-																   s_x[i]->
-																   dha *
-																   b_llnl *
-																   muhalf)) +
-						 bdot_llnl) * LOG_10 * s_x[i]->moles;
-					break;
-				}
-			}
-			else
-			{
-				error_msg("LLNL_AQUEOUS_MODEL_PARAMETERS not defined.", STOP);
-			}
-			break;
 		case 8:				/* LLNL CO2 */
-			if (llnl_temp.size() > 0)
-			{
-				s_x[i]->lg = log_g_co2;
-				s_x[i]->dg = dln_g_co2 * s_x[i]->moles;
-			}
-			else
+			if (llnl_temp.size() == 0)
 			{
 				error_msg("LLNL_AQUEOUS_MODEL_PARAMETERS not defined.", STOP);
 			}
 			break;
-		case 9:				/* activity water */
-			s_x[i]->lg = log10(exp(s_h2o->la * LOG_10) * gfw_water);
-			s_x[i]->dg = 0.0;
-			break;
 		}
 /*
 		if (mu_unknown != NULL) {
@@ -2327,6 +2537,50 @@ mb_ss(void)
 	}
 	return (OK);
 }
+/* ---------------------------------------------------------------------- */
+static void
+molalities_loop(void *cookie, int first, int last)
+/* ---------------------------------------------------------------------- */
+{
+	((Phreeqc *) cookie)->molalities_species(first, last);
+}
+
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+molalities_species(int first, int last)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   lm and moles of species first to last - 1 of s_x; writes nothing
+ *   else, so blocks of species can run on different threads
+ */
+	class rxn_token *rxn_ptr;
+	for (int i = first; i < last; i++)
+	{
+		if (s_x[i]->type > HPLUS && s_x[i]->type != EX
+			&& s_x[i]->type != SURF)
+			continue;
+		s_x[i]->lm = s_x[i]->lk - s_x[i]->lg;
+		for (rxn_ptr = &s_x[i]->rxn_x.token[0] + 1; rxn_ptr->s != NULL;
+			 rxn_ptr++)
+		{
+			s_x[i]->lm += rxn_ptr->s->la * rxn_ptr->coef;
+		}
+		if (s_x[i]->type == EX)
+		{
+			s_x[i]->moles = Utilities::safe_exp(s_x[i]->lm * LOG_10);
+		}
+		else if (s_x[i]->type == SURF)
+		{
+			s_x[i]->moles = Utilities::safe_exp(s_x[i]->lm * LOG_10);
+		}
+		else
+		{
+			s_x[i]->moles = under(s_x[i]->lm) * mass_water_aq_x;
+		}
+	}
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 molalities(int allow_overflow)
@@ -2339,16 +2593,12 @@ molalities(int allow_overflow)
  */
 	int i, j;
 	LDBLE total_g;
-	class rxn_token *rxn_ptr;
 /*
  *   la for master species
  */
-	for (i = 0; i < (int)master.size(); i++)
+	for (i = 0; i < (int)master_rewrite.size(); i++)
 	{
-		if (master[i]->in == REWRITE)
-		{
-			master[i]->s->la = master[i]->s->lm + master[i]->s->lg;
-		}
+		master_rewrite[i]->s->la = master_rewrite[i]->s->lm + master_rewrite[i]->s->lg;
 	}
 	if (dl_type_x != cxxSurface::NO_DL)
 	{
@@ -2361,39 +2611,15 @@ molalities(int allow_overflow)
 		s_h2o->tot_g_moles = s_h2o->moles;
 		s_h2o->tot_dh2o_moles = 0.0;
 	}
-	for (i = 0; i < (int)this->s_x.size(); i++)
-	{
-		if (s_x[i]->type > HPLUS && s_x[i]->type != EX
-			&& s_x[i]->type != SURF)
-			continue;
 /*
- *   lm and moles for all aqueous species
+ *   lm and moles for all aqueous species, on the loop threads for large
+ *   models; overflows are checked in species order afterwards
  */
-		s_x[i]->lm = s_x[i]->lk - s_x[i]->lg;
-		for (rxn_ptr = &s_x[i]->rxn_x.token[0] + 1; rxn_ptr->s != NULL;
-			 rxn_ptr++)
-		{
-			s_x[i]->lm += rxn_ptr->s->la * rxn_ptr->coef;
-			/*
-			if (isnan(rxn_ptr->s->la))
-			{
-				fprintf(stderr,"molalities la %s %e\n", rxn_ptr->s->name, rxn_ptr->s->la);
-			}
-			*/
-		}
-		if (s_x[i]->type == EX)
-		{
-			s_x[i]->moles = Utilities::safe_exp(s_x[i]->lm * LOG_10);
-
-		}
-		else if (s_x[i]->type == SURF)
-		{
-			s_x[i]->moles = Utilities::safe_exp(s_x[i]->lm * LOG_10);
-
-		}
-		else
+	loop_threads.Run((int)this->s_x.size(), molalities_loop, this);
+	for (i = 0; i < (int)this->s_x.size(); i++)
+	{
+		if (s_x[i]->type <= HPLUS)
 		{
-			s_x[i]->moles = under(s_x[i]->lm) * mass_water_aq_x;
 			if (s_x[i]->moles / mass_water_aq_x > 100)
 			{
 				log_msg(sformatf( "Overflow: %s\t%e\t%e\t%d\n",
@@ -2406,7 +2632,6 @@ molalities(int allow_overflow)
 					return (ERROR);
 				}
 			}
-
 		}
 	}
 /*
@@ -4543,6 +4768,62 @@ residuals(void)
 	return (OK);
 }
 
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+residual_merit(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Sum of squares of the residuals of the solution, exchange and
+ *   surface equations, each divided by the scale of its convergence
+ *   test in residuals. Phase equations are inequalities in ineq and
+ *   are not included.
+ */
+	LDBLE merit = 0.0, scale, r;
+	for (int i = 0; i < count_unknowns; i++)
+	{
+		switch (x[i]->type)
+		{
+		case MB:
+		case ALK:
+			scale = (x[i]->moles > MIN_TOTAL) ? x[i]->moles : MIN_TOTAL;
+			break;
+		case EXCH:
+		case SURFACE:
+			scale = (x[i]->moles > MIN_RELATED_SURFACE) ? x[i]->moles : 1.0;
+			break;
+		case CB:
+		case MU:
+			scale = mu_x * mass_water_aq_x;
+			break;
+		case MH:
+			scale = x[i]->moles;
+			if (mass_oxygen_unknown != NULL)
+				scale += 2 * mass_oxygen_unknown->moles;
+			break;
+		case MH2O:
+			if (mass_water_switch == TRUE)
+				continue;
+			scale = 0.01 * x[i]->moles;
+			break;
+		case AH2O:
+		case SOLUTION_PHASE_BOUNDARY:
+		case SURFACE_CB:
+		case SURFACE_CB1:
+		case SURFACE_CB2:
+			scale = 1.0;
+			break;
+		default:
+			continue;
+		}
+		if (scale <= 0)
+			continue;
+		r = residual[i] / scale;
+		merit += r * r;
+	}
+	return (merit);
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 set(int initial)
@@ -5078,6 +5359,7 @@ surface_model(void)
 		do
 		{
 			g_iterations++;
+			run_stats.donnan_sweeps++;
 			prev_aq_x = mass_water_aq_x;
 			k_temp(tc_x, patm_x);
 			gammas(mu_x);
@@ -5105,6 +5387,7 @@ surface_model(void)
 		do
 		{
 			g_iterations++;
+			run_stats.g_sweeps++;
 			if (g_iterations > itmax - 10)
 			{
 				debug_model = TRUE;
@@ -5161,6 +5444,8 @@ free_model_allocs(void)
 	delta.clear();
 	residual.clear();
 	s_x.clear();
+	phases_x.clear();
+	master_rewrite.clear();
 	sum_mb1.clear();
 	sum_mb2.clear();
 	sum_jacob0.clear();
@@ -5566,6 +5851,7 @@ numerical_jacobian(void)
 				(gas_phase_ptr->Get_pr_in() || force_numerical_fixed_volume) && numerical_fixed_volume)
 			))
 		return(OK);
+	run_stats.jacobians++;
 
 	//jacobian_sums();
 	if (use.Get_surface_ptr() != NULL)
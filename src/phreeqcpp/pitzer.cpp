@@ -1956,6 +1956,7 @@ jacobian_pz(void)
 	cxxSurface base_surface;
 	LDBLE d, d1, d2;
 	int i, j;
+	run_stats.jacobians++;
 Restart:
 	if (use.Get_surface_ptr() != NULL)
 	{
@@ -2267,6 +2268,7 @@ model_pz(void)
 #endif
 			iterations++;
 			overall_iterations++;
+			run_stats.iterations++;
 			if (iterations > itmax - 1 && debug_model == FALSE
 				&& pr.logfile == TRUE)
 			{
@@ -2472,6 +2474,7 @@ gammas_pz(bool exch_a_f)
 /*
  *   Need exchange gammas for pitzer
  */
+	PhaseCounters::Scope gammas_scope(phase_counters, PhaseCounters::GAMMAS);
 	int i, j;
 	LDBLE coef, equiv;
 	/* Initialize */
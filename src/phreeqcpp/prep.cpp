@@ -34,6 +34,7 @@ prep(void)
  *   Routine builds a set of lists for calculating mass balance and
  *      for building jacobian.
  */
+	PhaseCounters::Scope prep_scope(phase_counters, PhaseCounters::PREP);
 	cxxSolution *solution_ptr;
 
 	if (state >= REACTION)
@@ -108,6 +109,7 @@ prep(void)
  */
 		quick_setup();
 	}
+	set_master_rewrite();
 	if (debug_mass_balance)
 	{
 		output_msg(sformatf("\nTotals for the equation solver.\n"));
@@ -1116,10 +1118,10 @@ build_model(void)
 	s_x.clear();
 	compute_gfw("H2O", &gfw_water);
 	gfw_water *= 0.001;
-	for (i = 0; i < (int)s.size(); i++)
+	model_scope();
+	for (size_t k = 0; k < scope_s.size(); k++)
 	{
-		if (s[i]->type > H2O && s[i]->type != EX && s[i]->type != SURF)
-			continue;
+		i = scope_s[k];
 		s[i]->in = FALSE;
 		count_trxn = 0;
 		trxn_add(s[i]->rxn_s, 1.0, false);	/* rxn_s is set in tidy_model */
@@ -1289,14 +1291,17 @@ build_model(void)
 	/*
  *   Rewrite phases to current master species
  */
-	for (i = 0; i < (int)phases.size(); i++)
+	phases_x.clear();
+	for (size_t k = 0; k < scope_phases.size(); k++)
 	{
+		i = scope_phases[k];
 		count_trxn = 0;
 		trxn_add_phase(phases[i]->rxn_s, 1.0, false);
 		trxn_reverse_k();
 		phases[i]->in = inout();
 		if (phases[i]->in == TRUE)
 		{
+			phases_x.push_back(phases[i]);
 /*
  *   Replace e- in original equation with default redox reaction
  */
@@ -2089,6 +2094,91 @@ inout(void)
 	return (TRUE);
 }
 
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+model_scope(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Finds the elements of the model, those with a master species that is
+ *   in, and lists the species and phases with reactions that contain only
+ *   these elements. Other species and phases can not be in the model,
+ *   inout would return FALSE, and build_model skips them.
+ *   The lists are kept until the set of elements changes, or tidy_model
+ *   reads new species or phases.
+ */
+	std::vector<bool> elts(master.size(), false);
+	for (size_t i = 0; i < master.size(); i++)
+	{
+		if (master[i]->in != FALSE && master[i]->elt->primary != NULL)
+		{
+			elts[master[i]->elt->primary->number] = true;
+		}
+	}
+	if (scope_valid && elts == scope_elements)
+		return (OK);
+	scope_elements.swap(elts);
+	scope_s.clear();
+	for (size_t i = 0; i < s.size(); i++)
+	{
+		if (s[i]->type > H2O && s[i]->type != EX && s[i]->type != SURF)
+			continue;
+		if (rxn_in_scope(s[i]->rxn_s))
+			scope_s.push_back((int) i);
+	}
+	/* phases outside the scope are not visited by build_model */
+	scope_phases.clear();
+	for (size_t i = 0; i < phases.size(); i++)
+	{
+		phases[i]->in = FALSE;
+		if (rxn_in_scope(phases[i]->rxn_s))
+			scope_phases.push_back((int) i);
+	}
+	scope_valid = true;
+	return (OK);
+}
+
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+rxn_in_scope(CReaction &rxn_ref)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns false if a master species of the reaction belongs to an
+ *   element that is not in scope_elements.
+ *   Assumes equation is written in terms of primary and secondary species
+ */
+	if (rxn_ref.token.size() == 0)
+		return (true);
+	for (class rxn_token *token_ptr = &rxn_ref.token[0] + 1; token_ptr->s != NULL; token_ptr++)
+	{
+		class master *master_ptr = token_ptr->s->primary;
+		if (master_ptr == NULL)
+			master_ptr = token_ptr->s->secondary;
+		if (master_ptr == NULL || master_ptr->elt->primary == NULL)
+			continue;
+		if (!scope_elements[master_ptr->elt->primary->number])
+			return (false);
+	}
+	return (true);
+}
+
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+set_master_rewrite(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Lists the master species with in == REWRITE for molalities
+ */
+	master_rewrite.clear();
+	for (size_t i = 0; i < master.size(); i++)
+	{
+		if (master[i]->in == REWRITE)
+			master_rewrite.push_back(master[i]);
+	}
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 is_special(class species *l_spec)
@@ -2564,6 +2654,7 @@ reprep(void)
  *   Build model again
  */
 	build_model();
+	set_master_rewrite();
 	k_temp(tc_x, patm_x);
 
 	return (OK);
@@ -3763,21 +3854,15 @@ calc_PR(std::vector<class phase *> phase_ptrs, LDBLE P, LDBLE TK, LDBLE V_m)
      a_aa_sum2 = Sum_j(x_j * (a_aa_i * a_aa_j)^0.5
   3) correct the solubility of gas i with:
   pr_si_f = log10(phi_i) -  Delta_V_i * (P - 1) / (2.303 * R * TK);
+
+  The equation of state itself is in gases.cpp, shared with calc_PR().
 */
 {
-	int i, i1, n_g = (int) phase_ptrs.size();
-	LDBLE T_c, P_c;
-	LDBLE A, B, B_r, /*b2,*/ kk, oo, a_aa, T_r;
-	LDBLE m_sum, /*b_sum, a_aa_sum,*/ a_aa_sum2;
-	LDBLE phi;
-	LDBLE /*R_TK,*/ R = R_LITER_ATM; /* L atm / (K mol) */
-	LDBLE r3[4], r3_12, rp, rp3, rq, rz, ri, ri1, one_3 = 0.33333333333333333;
-	LDBLE disct, vinit, v1, ddp, dp_dv, dp_dv2;
-	int it;
-	class phase *phase_ptr, *phase_ptr1;
+	int i, n_g = (int) phase_ptrs.size();
+	LDBLE m_sum;
+	class phase *phase_ptr;
 	cxxGasPhase * gas_phase_ptr = use.Get_gas_phase_ptr();
-	bool halved;
-	R_TK = R * TK;
+	R_TK = R_LITER_ATM * TK;
 	m_sum = b_sum = a_aa_sum = 0.0;
 	for (i = 0; i < n_g; i++)
 	{
@@ -3791,28 +3876,7 @@ calc_PR(std::vector<class phase *> phase_ptrs, LDBLE P, LDBLE TK, LDBLE V_m)
 		if (phase_ptr->t_c == 0.0 || phase_ptr->p_c == 0.0)
 			error_msg("Cannot calculate a mixture of ideal and Peng_Robinson gases,\n       please define Tc and Pc for the active gases in PHASES.", STOP);
 			//continue;
-		if (!phase_ptr->pr_a)
-		{
-			T_c = phase_ptr->t_c;
-			P_c = phase_ptr->p_c;
-			phase_ptr->pr_a = 0.457235 * R * R * T_c * T_c / P_c;
-			phase_ptr->pr_b = 0.077796 * R * T_c / P_c;
-			T_r = TK / T_c;
-			oo = phase_ptr->omega;
-			kk = 0.37464 + oo * (1.54226 - 0.26992 * oo);
-			phase_ptr->pr_alpha = pow(1 + kk * (1 - sqrt(T_r)), 2);
-			phase_ptr->pr_tk = TK;
-//			phase_ptr->pr_in = true;
-		}
-		if (phase_ptr->pr_tk != TK)
-		{
-			T_r = TK / phase_ptr->t_c;
-			oo = phase_ptr->omega;
-			kk = 0.37464 + oo * (1.54226 - 0.26992 * oo);
-			phase_ptr->pr_alpha = pow(1 + kk * (1 - sqrt(T_r)), 2);
-			phase_ptr->pr_tk = TK;
-//			phase_ptr->pr_in = true;
-		}
+		calc_PR_parameters(phase_ptr, TK);
 	}
 	for (i = 0; i < n_g; i++)
 	{
@@ -3826,193 +3890,26 @@ calc_PR(std::vector<class phase *> phase_ptrs, LDBLE P, LDBLE TK, LDBLE V_m)
 			return (OK);
 		phase_ptr->fraction_x = phase_ptr->moles_x / m_sum;
 	}
-	 
-	for (i = 0; i < n_g; i++)
-	{
-		a_aa_sum2 = 0.0;
-		phase_ptr = phase_ptrs[i];
-		//if (phase_ptr->t_c == 0.0 || phase_ptr->p_c == 0.0)
-		//	continue;
-		b_sum += phase_ptr->fraction_x * phase_ptr->pr_b;
-		for (i1 = 0; i1 < n_g; i1++)
-		{
-			phase_ptr1 = phase_ptrs[i1];
-			//if (phase_ptr1->t_c == 0.0 || phase_ptr1->p_c == 0.0)
-			//	continue;
-			if (phase_ptr1->fraction_x == 0)
-				continue;
-			a_aa = sqrt(phase_ptr->pr_a * phase_ptr->pr_alpha *
-				        phase_ptr1->pr_a * phase_ptr1->pr_alpha);
-			if (!strcmp(phase_ptr->name, "H2O(g)"))
-			{
-				if (!strcmp(phase_ptr1->name, "CO2(g)"))
-					a_aa *= 0.81; // Soreide and Whitson, 1992, FPE 77, 217
-				else if (!strcmp(phase_ptr1->name, "H2S(g)") || !strcmp(phase_ptr1->name, "H2Sg(g)"))
-					a_aa *= 0.81;
-				else if (!strcmp(phase_ptr1->name, "CH4(g)") || !strcmp(phase_ptr1->name, "Mtg(g)") || !strcmp(phase_ptr1->name, "Methane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr1->name, "N2(g)") || !strcmp(phase_ptr1->name, "Ntg(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr1->name, "Ethane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr1->name, "Propane(g)"))
-					a_aa *= 0.45;
-			}
-			if (!strcmp(phase_ptr1->name, "H2O(g)"))
-			{
-				if (!strcmp(phase_ptr->name, "CO2(g)"))
-					a_aa *= 0.81;
-				else if (!strcmp(phase_ptr->name, "H2S(g)") || !strcmp(phase_ptr->name, "H2Sg(g)"))
-					a_aa *= 0.81;
-				else if (!strcmp(phase_ptr->name, "CH4(g)") || !strcmp(phase_ptr->name, "Mtg(g)") || !strcmp(phase_ptr->name, "Methane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr->name, "N2(g)") || !strcmp(phase_ptr->name, "Ntg(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr->name, "Ethane(g)"))
-					a_aa *= 0.51;
-				else if (!strcmp(phase_ptr->name, "Propane(g)"))
-					a_aa *= 0.45;
-			}
-			a_aa_sum += phase_ptr->fraction_x * phase_ptr1->fraction_x * a_aa;
-			a_aa_sum2 += phase_ptr1->fraction_x * a_aa;
-		}
-		phase_ptr->pr_aa_sum2 = a_aa_sum2;
-	}
-	b2 = b_sum * b_sum;
+	calc_PR_mix(phase_ptrs);
 
 	if (V_m)
 	{
-		P = R_TK / (V_m - b_sum) - a_aa_sum / (V_m * (V_m + 2 * b_sum) - b2);
-		if (iterations > 0 && P < 150 && V_m < 1.01)
-		{
-			// check for 3-roots...
-			r3[1] = b_sum - R_TK / P;
-			r3[2] = -3.0 * b2 + (a_aa_sum - R_TK * 2.0 * b_sum) / P;
-			r3[3] = b2 * b_sum + (R_TK * b2 - b_sum * a_aa_sum) / P;
-			// the discriminant of the cubic eqn...
-			disct = 18. * r3[1] * r3[2] * r3[3] -
-				4. * pow(r3[1], 3) * r3[3] + 
-				r3[1] * r3[1] * r3[2] * r3[2] -
-				4. * pow(r3[2], 3) - 
-				27. * r3[3] * r3[3];
-			//if (iterations > 50)
-			//	it = 0;	// debug
-			if (disct > 0)
-			{
-				// 3-roots, find the largest P...
-				it = 0;
-				halved = false;
-				ddp = 1e-9;
-				v1 = vinit = 0.729;
-				dp_dv = f_Vm(v1, this);
-				while (fabs(dp_dv) > 1e-11 && it < 40)
-				{
-					it +=1;
-					dp_dv2 = f_Vm(v1 - ddp, this);
-					v1 -= (dp_dv * ddp / (dp_dv - dp_dv2));
-					if (!halved && (v1 > vinit || v1 < 0.03))
-					{
-						if (vinit > 0.329)
-							vinit -= 0.1;
-						else
-							vinit -=0.05;
-						if (vinit < 0.03)
-						{
-							vinit = halve(f_Vm, 0.03, 1.0, 1e-3);
-							if (f_Vm(vinit - 2e-3, this) < 0)
-								vinit = halve(f_Vm, vinit + 2e-3, 1.0, 1e-3);
-							halved = true;
-						}
-						v1 = vinit;
-					}
-					dp_dv = f_Vm(v1, this);
-					if (fabs(dp_dv) < 1e-11)
-					{
-						if (f_Vm(v1 - 1e-4, this) < 0)
-						{
-							v1 = halve(f_Vm, v1 + 1e-4, 1.0, 1e-3);
-							dp_dv = f_Vm(v1, this);
-						}
-					}
-				}
-				if (it == 40)
-				{
-// accept a (possible) whobble in the curve...
-//					error_msg("No convergence when calculating P in Peng-Robinson.", STOP);
-				}
-				if (V_m < v1 && it < 40)
-					P = R_TK / (v1 - b_sum) - a_aa_sum / (v1 * (v1 + 2 * b_sum) - b2);
-			}
-		}
+		P = calc_PR_P(V_m);
 		if (P <= 0) // iterations = -1
 			P = 1;
 	} else
 	{
 		if (P < 1e-10)
 			P = 1e-10;
-		r3[1] = b_sum - R_TK / P;
-		r3_12 = r3[1] * r3[1];
-		r3[2] = -3.0 * b2 + (a_aa_sum - R_TK * 2.0 * b_sum) / P;
-		r3[3] = b2 * b_sum + (R_TK * b2 - b_sum * a_aa_sum) / P;
-		// solve t^3 + rp*t + rq = 0.
-		// molar volume V_m = t - r3[1] / 3... 
-		rp = r3[2] - r3_12 / 3;
-		rp3 = rp * rp * rp;
-		rq = (2.0 * r3_12 * r3[1] - 9.0 * r3[1] * r3[2]) / 27 + r3[3];
-		rz = rq * rq / 4 + rp3 / 27;
-		if (rz >= 0) // Cardono's method...
-		{
-			ri = sqrt(rz);
-			if (ri + rq / 2 <= 0)
-			{
-				V_m = pow(ri - rq / 2, one_3) + pow(- ri - rq / 2, one_3) - r3[1] / 3;
-			}
-			else
-			{
-				ri = - pow(ri + rq / 2, one_3);
-				V_m = ri - rp / (3.0 * ri) - r3[1] / 3;
-			}
-		}
-		else // use complex plane...
-		{
-			ri = sqrt(- rp3 / 27); // rp < 0
-			ri1 = acos(- rq / 2 / ri);
-			V_m = 2.0 * pow(ri, one_3) * cos(ri1 / 3) - r3[1] / 3;
-		}
+		V_m = calc_PR_V_m(P);
 	}
  // calculate the fugacity coefficients...
 	for (i = 0; i < n_g; i++)
 	{
 		phase_ptr = phase_ptrs[i];
+		calc_PR_phi(phase_ptr, P, V_m);
 		if (phase_ptr->fraction_x == 0.0)
-		{
-			phase_ptr->pr_p = 0;
-			phase_ptr->pr_phi = 1;
-			phase_ptr->pr_si_f = 0.0;
 			continue;
-		}
-		phase_ptr->pr_p = phase_ptr->fraction_x * P;
-		rz = P * V_m / R_TK;
-		A = a_aa_sum * P / (R_TK * R_TK);
-		B = b_sum * P / R_TK;
-		B_r = phase_ptr->pr_b / b_sum;
-		if (rz > B)
-		{
-			phi = B_r * (rz - 1) - log(rz - B) + A / (2.828427 * B) * (B_r - 2.0 * phase_ptr->pr_aa_sum2 / a_aa_sum) *
-				log((rz + 2.41421356 * B) / (rz - 0.41421356 * B));
-			phi = (phi > 4.44 ? 4.44 : (phi < -4.6 ? -4.6 : phi));
-			//if (phi > 4.44)
-			//	phi = 4.44;
-		}
-		else
-			phi = -4.6; // fugacity coefficient = 0.01
-		//if (!strcmp(phase_ptr->name, "H2O(g)") && phi < -4.6)
-		//{
-		////	 avoid such phi...
-		//	phi = -4.6;
-		//}
-		phase_ptr->pr_phi = exp(phi);
-		phase_ptr->pr_si_f = phi / LOG_10;
 		// for initial equilibrations, adapt log_k of the gas phase...
 		if (state < REACTION)
 		{
@@ -5462,6 +5359,7 @@ k_temp(LDBLE tc, LDBLE pa) /* pa - pressure in atm */
 /*
  *  Calculates log k's for all species and pure_phases
  */
+	PhaseCounters::Scope k_temp_scope(phase_counters, PhaseCounters::K_TEMP);
 
 	// if (tc == current_tc && pa == current_pa && ((fabs(mu_x - current_mu) < 1e-3 * mu_x) || !mu_terms_in_logk))
 	// 	return OK;
@@ -5500,16 +5398,16 @@ proceed:
 /*
  *    Calculate log k for all pure phases
  */
-	for (i = 0; i < (int)phases.size(); i++)
+	for (i = 0; i < (int)phases_x.size(); i++)
 	{
-		if (phases[i]->in == TRUE)  
+		if (phases_x[i]->in == TRUE)  
 		{
 
-			phases[i]->rxn_x.logk[delta_v] = calc_delta_v(*&phases[i]->rxn_x, true) -
-				phases[i]->logk[vm0];
-			if (phases[i]->rxn_x.logk[delta_v])
+			phases_x[i]->rxn_x.logk[delta_v] = calc_delta_v(*&phases_x[i]->rxn_x, true) -
+				phases_x[i]->logk[vm0];
+			if (phases_x[i]->rxn_x.logk[delta_v])
 				mu_terms_in_logk = true;
-			phases[i]->lk = k_calc(phases[i]->rxn_x.logk, tempk, pa * PASCAL_PER_ATM);
+			phases_x[i]->lk = k_calc(phases_x[i]->rxn_x.logk, tempk, pa * PASCAL_PER_ATM);
 
 		}
 	}
@@ -1246,20 +1246,20 @@ print_saturation_indices(void)
 	output_msg(sformatf("  %-15s%9s%8s%9s%3d%4s%3d%4s\n\n", "Phase", "SI**",
 			   "log IAP", "log K(", int(tk_x), " K, ", int(floor(patm_x + 0.5)), " atm)"));
 
-	for (i = 0; i < (int)phases.size(); i++)
+	for (i = 0; i < (int)phases_x.size(); i++)
 	{
-		if (phases[i]->in == FALSE || phases[i]->type != SOLID)
+		if (phases_x[i]->in == FALSE || phases_x[i]->type != SOLID)
 			continue;
 		/* check for solids and gases in equation */
-		if (phases[i]->replaced)
-			reaction_ptr = &phases[i]->rxn_s;
+		if (phases_x[i]->replaced)
+			reaction_ptr = &phases_x[i]->rxn_s;
 		else
-			reaction_ptr = &phases[i]->rxn;
+			reaction_ptr = &phases_x[i]->rxn;
 /*
  *   Print saturation index
  */
 		reaction_ptr->logk[delta_v] = calc_delta_v(*reaction_ptr, true) -
-			 phases[i]->logk[vm0];
+			 phases_x[i]->logk[vm0];
 		if (reaction_ptr->logk[delta_v])
 				mu_terms_in_logk = true;
 		lk = k_calc(reaction_ptr->logk, tk_x, patm_x * PASCAL_PER_ATM);
@@ -1279,31 +1279,31 @@ print_saturation_indices(void)
 		si = -lk + iap;
 
 		output_msg(sformatf("  %-15s%7.2f  %8.2f%8.2f  %s",
-				   phases[i]->name, (double) si, (double) iap, (double) lk,
-				   phases[i]->formula));
-		if (gas && phases[i]->pr_in && phases[i]->pr_p)
+				   phases_x[i]->name, (double) si, (double) iap, (double) lk,
+				   phases_x[i]->formula));
+		if (gas && phases_x[i]->pr_in && phases_x[i]->pr_p)
 		{
-			if (phases[i]->moles_x || state == INITIAL_SOLUTION)
+			if (phases_x[i]->moles_x || state == INITIAL_SOLUTION)
 			{
 				output_msg(sformatf("\t%s%5.1f%s%5.3f",
-					    " Pressure ", (double) phases[i]->pr_p, " atm, phi ", (double) phases[i]->pr_phi));
+					    " Pressure ", (double) phases_x[i]->pr_p, " atm, phi ", (double) phases_x[i]->pr_phi));
 			} else
 			{
 				for (int j = 0; j < count_unknowns; j++)
 				{
 					if (x[j]->type != PP)
 						continue;
-					if (!strcmp(x[j]->phase->name, phases[i]->name))
+					if (!strcmp(x[j]->phase->name, phases_x[i]->name))
 					{
 						if (x[j]->moles)
 							output_msg(sformatf("\t%s%5.1f%s%5.3f",
-								" Pressure ", (double) phases[i]->pr_p, " atm, phi ", (double) phases[i]->pr_phi));
+								" Pressure ", (double) phases_x[i]->pr_p, " atm, phi ", (double) phases_x[i]->pr_phi));
 						break;
 					}
 				}
 			}
 		}
-		phases[i]->pr_in = false;
+		phases_x[i]->pr_in = false;
 		output_msg("\n");
 	}
 	output_msg(sformatf("\n%s\n%s",
@@ -2594,6 +2594,8 @@ punch_gas_phase(void)
 		fpunchf("total mol", "%20.12e\t", (double) total_moles);
 		fpunchf("volume", "%20.12e\t", (double) volume);
 	}
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_gases(), "g_");
 	for (size_t i = 0; i < current_selected_output->Get_gases().size(); i++)
 	{
 		moles = 0.0;
@@ -2614,11 +2616,11 @@ punch_gas_phase(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("g_%s", current_selected_output->Get_gases()[i].first.c_str()), "%12.4e\t", (double) moles);
+			fpunchf(headings[i].c_str(), "%12.4e\t", (double) moles);
 		}
 		else
 		{
-			fpunchf(sformatf("g_%s", current_selected_output->Get_gases()[i].first.c_str()), "%20.12e\t",
+			fpunchf(headings[i].c_str(), "%20.12e\t",
 					(double) moles);
 		}
 	}
@@ -2639,6 +2641,8 @@ punch_ss_assemblage(void)
 /*
  *   Print solid solutions
  */
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_s_s(), "s_");
 	for (size_t k = 0; k < current_selected_output->Get_s_s().size(); k++)
 	{
 		found = FALSE;
@@ -2664,12 +2668,12 @@ punch_ss_assemblage(void)
 						}
 						if (!current_selected_output->Get_high_precision())
 						{
-							fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()),
+							fpunchf(headings[k].c_str(),
 									"%12.4e\t", (double) moles);
 						}
 						else
 						{
-							fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()),
+							fpunchf(headings[k].c_str(),
 									"%20.12e\t", (double) moles);
 						}
 						found = TRUE;
@@ -2684,11 +2688,11 @@ punch_ss_assemblage(void)
 		{
 			if (!current_selected_output->Get_high_precision())
 			{
-				fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()), "%12.4e\t", (double) 0.0);
+				fpunchf(headings[k].c_str(), "%12.4e\t", (double) 0.0);
 			}
 			else
 			{
-				fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()), "%20.12e\t",
+				fpunchf(headings[k].c_str(), "%20.12e\t",
 						(double) 0.0);
 			}
 		}
@@ -2707,6 +2711,8 @@ punch_totals(void)
 	//int j;
 	LDBLE molality;
 
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_totals(), "", "(mol/kgw)");
 	for (size_t j = 0; j < current_selected_output->Get_totals().size(); j++)
 	{
 		if (current_selected_output->Get_totals()[j].second == NULL)
@@ -2729,12 +2735,12 @@ punch_totals(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("%s(mol/kgw)", current_selected_output->Get_totals()[j].first.c_str()),
+			fpunchf(headings[j].c_str(),
 					"%12.4e\t", (double) molality);
 		}
 		else
 		{
-			fpunchf(sformatf("%s(mol/kgw)", current_selected_output->Get_totals()[j].first.c_str()),
+			fpunchf(headings[j].c_str(),
 					"%20.12e\t", (double) molality);
 		}
 	}
@@ -2752,6 +2758,8 @@ punch_molalities(void)
 	//int j;
 	LDBLE molality;
 
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_molalities(), "m_", "(mol/kgw)");
 	for (size_t j = 0; j < current_selected_output->Get_molalities().size(); j++)
 	{
 		molality = 0.0;
@@ -2762,12 +2770,12 @@ punch_molalities(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("m_%s(mol/kgw)", current_selected_output->Get_molalities()[j].first.c_str()),
+			fpunchf(headings[j].c_str(),
 					"%12.4e\t", (double) molality);
 		}
 		else
 		{
-			fpunchf(sformatf("m_%s(mol/kgw)", current_selected_output->Get_molalities()[j].first.c_str()),
+			fpunchf(headings[j].c_str(),
 					"%20.12e\t", (double) molality);
 		}
 	}
@@ -2785,6 +2793,8 @@ punch_activities(void)
 	//int j;
 	LDBLE la;
 
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_activities(), "la_");
 	for (size_t j = 0; j < current_selected_output->Get_activities().size(); j++)
 	{
 		la = -999.999;
@@ -2796,12 +2806,12 @@ punch_activities(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("la_%s", current_selected_output->Get_activities()[j].first.c_str()), "%12.4e\t",
+			fpunchf(headings[j].c_str(), "%12.4e\t",
 					(double) la);
 		}
 		else
 		{
-			fpunchf(sformatf("la_%s", current_selected_output->Get_activities()[j].first.c_str()),
+			fpunchf(headings[j].c_str(),
 					"%20.12e\t", (double) la);
 		}
 	}
@@ -2818,6 +2828,8 @@ punch_pp_assemblage(void)
  */
 	//int i, j;
 	LDBLE moles, delta_moles;
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_pure_phases(), "d_");
 	for (size_t i = 0; i < current_selected_output->Get_pure_phases().size(); i++)
 	{
 		delta_moles = 0;
@@ -2854,13 +2866,13 @@ punch_pp_assemblage(void)
 		if (!current_selected_output->Get_high_precision())
 		{
 			fpunchf(current_selected_output->Get_pure_phases()[i].first.c_str(), "%12.4e\t", (double) moles);
-			fpunchf(sformatf("d_%s", current_selected_output->Get_pure_phases()[i].first.c_str()), "%12.4e\t",
+			fpunchf(headings[i].c_str(), "%12.4e\t",
 					(double) delta_moles);
 		}
 		else
 		{
 			fpunchf(current_selected_output->Get_pure_phases()[i].first.c_str(), "%20.12e\t", (double) moles);
-			fpunchf(sformatf("d_%s", current_selected_output->Get_pure_phases()[i].first.c_str()),
+			fpunchf(headings[i].c_str(),
 					"%20.12e\t", (double) delta_moles);
 		}
 	}
@@ -3208,6 +3220,28 @@ punch_identifiers(void)
 					(double) (100 * cb_x / total_ions_x));
 		}
 	}
+	if (current_selected_output->Get_cell_cost())
+	{
+		/* costs accumulated so far by the current cell; zero outside
+		   TRANSPORT and ADVECTION */
+		class cell_cost l_cost;
+		if (cell_cost_ptr(cell_no) != NULL)
+		{
+			l_cost = *cell_cost_ptr(cell_no);
+		}
+		fpunchf("cost_iter", dformat, l_cost.iterations);
+		fpunchf("cost_retries", dformat, l_cost.retries);
+		fpunchf("cost_solves", dformat, l_cost.solves);
+		fpunchf("cost_kin_steps", dformat, l_cost.kinetic_steps);
+		if (!current_selected_output->Get_high_precision())
+		{
+			fpunchf("cost_time", "%12g\t", (double) l_cost.time);
+		}
+		else
+		{
+			fpunchf("cost_time", "%20.12e\t", (double) l_cost.time);
+		}
+	}
 	punch_flush();
 	return (OK);
 }
@@ -3225,6 +3259,8 @@ punch_saturation_indices(void)
 	LDBLE si, iap;
 	class rxn_token *rxn_ptr;
 
+	const std::vector< std::string > &headings =
+		current_selected_output->Get_headings(current_selected_output->Get_si(), "si_");
 	for (size_t i = 0; i < current_selected_output->Get_si().size(); i++)
 	{
 		if (current_selected_output->Get_si()[i].second == NULL || ((class phase *) current_selected_output->Get_si()[i].second)->in == FALSE)
@@ -3246,11 +3282,11 @@ punch_saturation_indices(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("si_%s", current_selected_output->Get_si()[i].first.c_str()), "%12.4f\t", (double) si);
+			fpunchf(headings[i].c_str(), "%12.4f\t", (double) si);
 		}
 		else
 		{
-			fpunchf(sformatf("si_%s", current_selected_output->Get_si()[i].first.c_str()), "%20.12e\t", (double) si);
+			fpunchf(headings[i].c_str(), "%20.12e\t", (double) si);
 		}
 	}
 	return (OK);
@@ -3279,6 +3315,10 @@ punch_kinetics(void)
 			kinetics_ptr = Utilities::Rxn_find(Rxn_kinetics_map, -2);
 		}
 	}
+	const std::vector< std::string > &k_headings =
+		current_selected_output->Get_headings(current_selected_output->Get_kinetics(), "k_");
+	const std::vector< std::string > &dk_headings =
+		current_selected_output->Get_headings(current_selected_output->Get_kinetics(), "dk_");
 	for (size_t i = 0; i < current_selected_output->Get_kinetics().size(); i++)
 	{
 		moles = 0.0;
@@ -3310,16 +3350,16 @@ punch_kinetics(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("k_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%12.4e\t",
+			fpunchf(k_headings[i].c_str(), "%12.4e\t",
 					(double) moles);
-			fpunchf(sformatf("dk_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%12.4e\t",
+			fpunchf(dk_headings[i].c_str(), "%12.4e\t",
 					(double) delta_moles);
 		}
 		else
 		{
-			fpunchf(sformatf("k_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%20.12e\t",
+			fpunchf(k_headings[i].c_str(), "%20.12e\t",
 					(double) moles);
-			fpunchf(sformatf("dk_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%20.12e\t",
+			fpunchf(dk_headings[i].c_str(), "%20.12e\t",
 					(double) delta_moles);
 		}
 	}
@@ -4719,9 +4719,10 @@ read_selected_output(void)
 		"calculate_values",		/* 47 */
 		"equilibrium_phase",    /* 48 */
 		"active",               /* 49 */
-		"new_line"            /* 50 */
+		"new_line",             /* 50 */
+		"cell_cost"             /* 51 */
 	};
-	int count_opt_list = 51;
+	int count_opt_list = 52;
 
 	int i, l;
 	char token[MAX_LENGTH];
@@ -4761,6 +4762,7 @@ read_selected_output(void)
 		temp_selected_output.Set_user_punch       ( so_ref.Get_user_punch() );
 		temp_selected_output.Set_charge_balance   ( so_ref.Get_charge_balance() );
 		temp_selected_output.Set_percent_error    ( so_ref.Get_percent_error() );
+		temp_selected_output.Set_cell_cost        ( so_ref.Get_cell_cost() );
 		temp_selected_output.Set_have_punch_name  ( so_ref.Get_have_punch_name() );
 		temp_selected_output.Set_file_name        ( so_ref.Get_file_name() );
 	}
@@ -5102,6 +5104,12 @@ read_selected_output(void)
 			temp_selected_output.Set_new_line(value != FALSE);
 			opt_save = OPTION_ERROR;
 			break;
+		case 51:				/* cell_cost */
+			temp_selected_output.Set_new_def(true);
+			value = get_true_false(next_char, TRUE);
+			temp_selected_output.Set_cell_cost(value != FALSE);
+			opt_save = OPTION_ERROR;
+			break;
 		}
 		if (return_value == EOF || return_value == KEYWORD)
 			break;
@@ -7773,9 +7781,17 @@ read_debug(void)
 		"minimum_total",                   /* 21 */  
 		"min_total",                       /* 22 */   
 		"debug_mass_action",               /* 23 */
-		"debug_mass_balance"               /* 24 */
+		"debug_mass_balance",              /* 24 */
+		"capture_iterations",              /* 25 */
+		"capture_time",                    /* 26 */
+		"capture_file",                    /* 27 */
+		"capture_max",                     /* 28 */
+		"phase_counters",                  /* 29 */
+		"line_search",                     /* 30 */
+		"threads",                         /* 31 */
+		"thread_threshold"                 /* 32 */
 	};
-	int count_opt_list = 25;
+	int count_opt_list = 33;
 /*
  *   Read parameters:
  *	ineq_tol;
@@ -7883,6 +7899,49 @@ read_debug(void)
 		case 24:				/* debug_mass_balance */
 			debug_mass_balance = get_true_false(next_char, TRUE);
 			break;
+		case 25:				/* capture_iterations */
+			(void)sscanf(next_char, "%d", &capture_iterations);
+			break;
+		case 26:				/* capture_time */
+			(void)sscanf(next_char, SCANFORMAT, &capture_time);
+			break;
+		case 27:				/* capture_file */
+			{
+				std::string token;
+				if (copy_token(token, &next_char) != EMPTY)
+				{
+					capture_prefix = token;
+				}
+				else
+				{
+					input_error++;
+					error_msg("Expected file name prefix for -capture_file.", CONTINUE);
+				}
+			}
+			break;
+		case 28:				/* capture_max */
+			(void)sscanf(next_char, "%d", &capture_max);
+			break;
+		case 29:				/* phase_counters */
+			phase_counters.Set_on(get_true_false(next_char, TRUE) == TRUE);
+			break;
+		case 30:				/* line_search */
+			line_search = get_true_false(next_char, TRUE);
+			break;
+		case 31:				/* threads */
+			{
+				int n = 1;
+				(void)sscanf(next_char, "%d", &n);
+				loop_threads.Set_threads(n);
+			}
+			break;
+		case 32:				/* thread_threshold */
+			{
+				int n = LoopThreads::DEFAULT_THRESHOLD;
+				(void)sscanf(next_char, "%d", &n);
+				loop_threads.Set_threshold(n);
+			}
+			break;
 		}
 		if (return_value == EOF || return_value == KEYWORD)
 			break;
@@ -966,6 +966,7 @@ jacobian_sit(void)
 	std::vector<class phase> base_phases;
 	cxxGasPhase base_gas_phase;
 	cxxSurface base_surface;
+	run_stats.jacobians++;
 Restart:
 	if (use.Get_surface_ptr() != NULL)
 	{
@@ -1233,6 +1234,7 @@ model_sit(void)
 #endif
 			iterations++;
 			overall_iterations++;
+			run_stats.iterations++;
 			if (iterations > itmax - 1 && debug_model == FALSE
 				&& pr.logfile == TRUE)
 			{
@@ -1441,6 +1443,7 @@ gammas_sit()
 /*
  *   Need exchange gammas for pitzer
  */
+	PhaseCounters::Scope gammas_scope(phase_counters, PhaseCounters::GAMMAS);
 	int i, j;
 	LDBLE coef;
 	/* Initialize */
@@ -815,7 +815,6 @@ add_reaction(cxxReaction *reaction_ptr, int step_number, LDBLE step_fraction)
 /*
  *   Add irreversible reaction
  */
-	char c;
 	class master *master_ptr;
 /*
  *   Calculate and save reaction
@@ -828,38 +827,83 @@ add_reaction(cxxReaction *reaction_ptr, int step_number, LDBLE step_fraction)
 
 	reaction_calc(reaction_ptr);
 
+	step_x = reaction_step_moles(reaction_ptr, step_number);
 /*
- *   Step size
+ *   Add reaction to totals
  */
+	cxxNameDouble::const_iterator it = reaction_ptr->Get_elementList().begin();
+	for ( ; it != reaction_ptr->Get_elementList().end(); it++)
+	{
+		class element * elt_ptr = element_store(it->first.c_str());
+		LDBLE coef = it->second;
+		if (elt_ptr == NULL)
+		{
+			assert (false);
+		}
+		else
+		{
+			master_ptr = elt_ptr->primary;
+			if (master_ptr == NULL)
+			{
+				// error msg has been called in reaction_calc
+				continue;
+			}
+			if (master_ptr->s == s_hplus)
+			{
+				total_h_x += coef * step_x * step_fraction;
+			}
+			else if (master_ptr->s == s_h2o)
+			{
+				total_o_x += coef * step_x * step_fraction;
+			}
+			else
+			{
+				master_ptr->total += coef * step_x * step_fraction;
+			}
+		}
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+reaction_step_moles(cxxReaction *reaction_ptr, int step_number)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Moles of irreversible reaction in step step_number
+ */
+	char c;
+	LDBLE l_step_x;
+
 	if (incremental_reactions == FALSE)
 	{
 		if (!reaction_ptr->Get_equalIncrements() && reaction_ptr->Get_steps().size()> 0 )
 		{
 			if (step_number > (int) reaction_ptr->Get_steps().size())
 			{
-				step_x = reaction_ptr->Get_steps()[reaction_ptr->Get_steps().size() - 1];
+				l_step_x = reaction_ptr->Get_steps()[reaction_ptr->Get_steps().size() - 1];
 			}
 			else
 			{
-				step_x = reaction_ptr->Get_steps()[(size_t)step_number - 1];
+				l_step_x = reaction_ptr->Get_steps()[(size_t)step_number - 1];
 			}
 		}
 		else if (reaction_ptr->Get_equalIncrements() && reaction_ptr->Get_steps().size()> 0)
 		{
 			if (step_number > (int) reaction_ptr->Get_reaction_steps())
 			{
-				step_x = reaction_ptr->Get_steps()[0];
+				l_step_x = reaction_ptr->Get_steps()[0];
 			}
 			else
 			{
-				step_x = reaction_ptr->Get_steps()[0] *
+				l_step_x = reaction_ptr->Get_steps()[0] *
 					((LDBLE) step_number) /
 					((LDBLE) (reaction_ptr->Get_reaction_steps()));
 			}
 		}
 		else
 		{
-			step_x = 0.0;
+			l_step_x = 0.0;
 		}
 	}
 	else
@@ -869,27 +913,27 @@ add_reaction(cxxReaction *reaction_ptr, int step_number, LDBLE step_fraction)
 		{
 			if (step_number > (int) reaction_ptr->Get_reaction_steps())
 			{
-				step_x = reaction_ptr->Get_steps()[(size_t)reaction_ptr->Get_reaction_steps() - 1];
+				l_step_x = reaction_ptr->Get_steps()[(size_t)reaction_ptr->Get_reaction_steps() - 1];
 			}
 			else
 			{
-				step_x = reaction_ptr->Get_steps()[(size_t)step_number - 1];
+				l_step_x = reaction_ptr->Get_steps()[(size_t)step_number - 1];
 			}
 		}
 		else if (reaction_ptr->Get_equalIncrements() && reaction_ptr->Get_steps().size()> 0)
 		{
 			if (step_number > (int) reaction_ptr->Get_reaction_steps())
 			{
-				step_x = 0;
+				l_step_x = 0;
 			}
 			else
 			{
-				step_x = reaction_ptr->Get_steps()[0] / ((LDBLE) (reaction_ptr->Get_reaction_steps()));
+				l_step_x = reaction_ptr->Get_steps()[0] / ((LDBLE) (reaction_ptr->Get_reaction_steps()));
 			}
 		}
 		else
 		{
-			step_x = 0.0;
+			l_step_x = 0.0;
 		}
 	}
 /*
@@ -898,51 +942,17 @@ add_reaction(cxxReaction *reaction_ptr, int step_number, LDBLE step_fraction)
 	c = reaction_ptr->Get_units().c_str()[0];
 	if (c == 'm')
 	{
-		step_x *= 1e-3;
+		l_step_x *= 1e-3;
 	}
 	else if (c == 'u')
 	{
-		step_x *= 1e-6;
+		l_step_x *= 1e-6;
 	}
 	else if (c == 'n')
 	{
-		step_x *= 1e-9;
-	}
-/*
- *   Add reaction to totals
- */
-	cxxNameDouble::const_iterator it = reaction_ptr->Get_elementList().begin();
-	for ( ; it != reaction_ptr->Get_elementList().end(); it++)
-	{
-		class element * elt_ptr = element_store(it->first.c_str());
-		LDBLE coef = it->second;
-		if (elt_ptr == NULL)
-		{
-			assert (false);
-		}
-		else
-		{
-			master_ptr = elt_ptr->primary;
-			if (master_ptr == NULL)
-			{
-				// error msg has been called in reaction_calc
-				continue;
-			}
-			if (master_ptr->s == s_hplus)
-			{
-				total_h_x += coef * step_x * step_fraction;
-			}
-			else if (master_ptr->s == s_h2o)
-			{
-				total_o_x += coef * step_x * step_fraction;
-			}
-			else
-			{
-				master_ptr->total += coef * step_x * step_fraction;
-			}
-		}
+		l_step_x *= 1e-9;
 	}
-	return (OK);
+	return (l_step_x);
 }
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -90,6 +90,7 @@ clean_up(void)
 	Rxn_pp_assemblage_map.clear();
 	/* s_s assemblages */
 	Rxn_ss_assemblage_map.clear();
+	ss_gap_cache.clear();
 	/* irreversible reactions */
 	Rxn_reaction_map.clear();
 	/* temperature */
@@ -146,6 +147,7 @@ clean_up(void)
 	species_list.clear();
 	/* transport data */
 	cell_data.clear();
+	cell_costs.clear();
 	/* advection */
 	advection_punch.clear();
 	advection_print.clear();
@@ -244,6 +246,7 @@ reinitialize(void)
 	Rxn_pp_assemblage_map.clear();
 	/* s_s assemblages */
 	Rxn_ss_assemblage_map.clear();
+	ss_gap_cache.clear();
 	/* gases */
 	Rxn_gas_phase_map.clear();
 	/* kinetics */
@@ -1139,6 +1142,10 @@ phase_free(class phase *phase_ptr)
 	phase_ptr->next_elt.clear();
 	phase_ptr->next_sys_total.clear();;
 	phase_ptr->add_logk.clear(); 
+	/* cached Peng-Robinson mixing terms and model lists may refer to the phase */
+	pr_mixings.clear();
+	phases_x.clear();
+	scope_valid = false;
 	return (OK);
 }
 
@@ -1273,6 +1280,7 @@ phase_store(const char *name_in)
 		phase_free(phase_ptr);
 		phase_init(phase_ptr);
 		phase_ptr->name = string_hsave(name_in);
+		tidy_changed_phases.insert(phase_ptr);
 		return (phase_ptr);
 	}
 /*
@@ -1680,6 +1688,7 @@ s_store(const char *name, LDBLE l_z, int replace_if_found)
 	{
 		s_free(s_ptr);
 		s_init(s_ptr);
+		tidy_changed_species.insert(s_ptr);
 	}
 	else
 	{
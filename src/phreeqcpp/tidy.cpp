@@ -47,24 +47,7 @@ tidy_model(void)
 	new_pitzer = FALSE;
 	new_named_logk = FALSE;
 
-	if (keycount[Keywords::KEY_SOLUTION_SPECIES] > 0				||	/*"species" */
-		keycount[Keywords::KEY_SOLUTION_MASTER_SPECIES] > 0			||	/*"master" */
-		keycount[Keywords::KEY_PHASES] > 0							||	/*"phases" */
-		keycount[Keywords::KEY_EXCHANGE_SPECIES] > 0				||	/*"exchange_species" */
-		keycount[Keywords::KEY_EXCHANGE_MASTER_SPECIES] > 0			||	/*"master_exchange_species" */
-		keycount[Keywords::KEY_SURFACE_SPECIES] > 0					||	/*"surface_species" */
-		keycount[Keywords::KEY_SURFACE_MASTER_SPECIES] > 0			||	/*"master_surface_species" */
-		keycount[Keywords::KEY_RATES] > 0							||	/*"rates" */
-		keycount[Keywords::KEY_LLNL_AQUEOUS_MODEL_PARAMETERS] > 0	||	/*"llnl_aqueous_model_parameters" */
-		(keycount[Keywords::KEY_DATABASE] > 0 && simulation == 0)	||	/*"database" */
-		keycount[Keywords::KEY_NAMED_EXPRESSIONS] > 0				||	/*"named_analytical_expressions" */
-		keycount[Keywords::KEY_ISOTOPES] > 0						||	/*"isotopes" */
-		keycount[Keywords::KEY_CALCULATE_VALUES] > 0				||	/*"calculate_values" */
-		keycount[Keywords::KEY_ISOTOPE_RATIOS] > 0					||	/*"isotopes_ratios", */
-		keycount[Keywords::KEY_ISOTOPE_ALPHAS] > 0					||	/*"isotopes_alphas" */
-		keycount[Keywords::KEY_PITZER] > 0							||	/*"pitzer" */
-		keycount[Keywords::KEY_SIT] > 0								/*"sit" */
-		)
+	if (model_keywords_read(true))
 	{							
 		new_model = TRUE;
 	}
@@ -157,6 +140,8 @@ tidy_model(void)
 
 	if (new_model == TRUE)
 	{
+		/* element scope, see model_scope */
+		scope_valid = false;
 		/* species */
 		if (s.size() > 1) //qsort(&s[0], s.size(), sizeof(class species*), s_compare);
 		{
@@ -202,9 +187,21 @@ tidy_model(void)
 	{
 		sum_species_map.clear();
 
-		tidy_species();
-
-		tidy_phases();
+		std::vector<bool> s_affected, phases_affected;
+		if (tidy_affected(s_affected, phases_affected))
+		{
+			tidy_species(&s_affected);
+			tidy_phases(&phases_affected);
+		}
+		else
+		{
+			tidy_species(NULL);
+			tidy_phases(NULL);
+		}
+		tidy_count_s = s.size();
+		tidy_count_phases = phases.size();
+		tidy_count_master = master.size();
+		tidy_count_elements = elements.size();
 
 		tidy_master_isotope();
 /*
@@ -246,6 +243,7 @@ tidy_model(void)
  */
 	if (new_model || new_ss_assemblage)
 	{
+		ss_gap_cache.clear();
 		tidy_ss_assemblage();
 	}
 /*
@@ -459,6 +457,8 @@ tidy_model(void)
 			error_msg("H(1) not defined in solution_master_species.", CONTINUE);
 		}
 	}
+	tidy_changed_species.clear();
+	tidy_changed_phases.clear();
 /*
  *   Error check, program termination
  */
@@ -469,6 +469,43 @@ tidy_model(void)
 
 	return (OK);
 }
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+model_keywords_read(bool species_and_phases)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   True if the input read since the last tidy_model has keywords that
+ *   change the model; SOLUTION_SPECIES and PHASES are included only if
+ *   species_and_phases is true
+ */
+	if (species_and_phases &&
+		(keycount[Keywords::KEY_SOLUTION_SPECIES] > 0 ||			/*"species" */
+		keycount[Keywords::KEY_PHASES] > 0))						/*"phases" */
+	{
+		return true;
+	}
+	if (keycount[Keywords::KEY_SOLUTION_MASTER_SPECIES] > 0			||	/*"master" */
+		keycount[Keywords::KEY_EXCHANGE_SPECIES] > 0				||	/*"exchange_species" */
+		keycount[Keywords::KEY_EXCHANGE_MASTER_SPECIES] > 0			||	/*"master_exchange_species" */
+		keycount[Keywords::KEY_SURFACE_SPECIES] > 0					||	/*"surface_species" */
+		keycount[Keywords::KEY_SURFACE_MASTER_SPECIES] > 0			||	/*"master_surface_species" */
+		keycount[Keywords::KEY_RATES] > 0							||	/*"rates" */
+		keycount[Keywords::KEY_LLNL_AQUEOUS_MODEL_PARAMETERS] > 0	||	/*"llnl_aqueous_model_parameters" */
+		(keycount[Keywords::KEY_DATABASE] > 0 && simulation == 0)	||	/*"database" */
+		keycount[Keywords::KEY_NAMED_EXPRESSIONS] > 0				||	/*"named_analytical_expressions" */
+		keycount[Keywords::KEY_ISOTOPES] > 0						||	/*"isotopes" */
+		keycount[Keywords::KEY_CALCULATE_VALUES] > 0				||	/*"calculate_values" */
+		keycount[Keywords::KEY_ISOTOPE_RATIOS] > 0					||	/*"isotopes_ratios", */
+		keycount[Keywords::KEY_ISOTOPE_ALPHAS] > 0					||	/*"isotopes_alphas" */
+		keycount[Keywords::KEY_PITZER] > 0							||	/*"pitzer" */
+		keycount[Keywords::KEY_SIT] > 0								/*"sit" */
+		)
+	{
+		return true;
+	}
+	return false;
+}
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -1467,11 +1504,95 @@ tidy_inverse(void)
 	return (OK);
 }
 
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+tidy_affected(std::vector<bool> &s_affected, std::vector<bool> &phases_affected)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   If the only model definitions read since the last tidy replace existing
+ *   SOLUTION_SPECIES or PHASES, flags the species and phases that need to
+ *   be tidied again: the replaced species and the species with reactions
+ *   that contain them, recursively; and the replaced phases, the phases
+ *   with reactions that contain flagged species and, if any phase was
+ *   replaced, the phases with solids or gases in their reactions.
+ *
+ *   Returns false if everything must be tidied, that is, after other
+ *   model keywords, new species, phases, master species or elements, or a
+ *   replaced species that is a master species.
+ */
+	size_t i, j;
+
+	if (model_keywords_read(false) ||
+		s.size() != tidy_count_s || phases.size() != tidy_count_phases ||
+		master.size() != tidy_count_master || elements.size() != tidy_count_elements)
+	{
+		return false;
+	}
+	s_affected.assign(s.size(), false);
+	for (i = 0; i < s.size(); i++)
+	{
+		s[i]->number = (int) i;
+		if (tidy_changed_species.find(s[i]) != tidy_changed_species.end())
+		{
+			s_affected[i] = true;
+		}
+	}
+	bool repeat = !tidy_changed_species.empty();
+	while (repeat)
+	{
+		repeat = false;
+		for (i = 0; i < s.size(); i++)
+		{
+			if (s_affected[i])
+				continue;
+			const std::vector<class rxn_token> &token = s[i]->rxn.token;
+			for (j = 1; j < token.size() && token[j].s != NULL; j++)
+			{
+				if (s_affected[token[j].s->number])
+				{
+					s_affected[i] = true;
+					repeat = true;
+					break;
+				}
+			}
+		}
+	}
+	for (i = 0; i < master.size(); i++)
+	{
+		if (master[i]->s != NULL && s_affected[master[i]->s->number])
+		{
+			return false;
+		}
+	}
+	phases_affected.assign(phases.size(), false);
+	for (i = 0; i < phases.size(); i++)
+	{
+		if (tidy_changed_phases.find(phases[i]) != tidy_changed_phases.end())
+		{
+			phases_affected[i] = true;
+			continue;
+		}
+		const std::vector<class rxn_token> &token = phases[i]->rxn.token;
+		for (j = 1; j < token.size() && (token[j].s != NULL || token[j].name != NULL); j++)
+		{
+			if (token[j].s != NULL ? s_affected[token[j].s->number] : !tidy_changed_phases.empty())
+			{
+				phases_affected[i] = true;
+				break;
+			}
+		}
+	}
+	return true;
+}
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-tidy_phases(void)
+tidy_phases(const std::vector<bool> *affected)
 /* ---------------------------------------------------------------------- */
 {
+/*
+ *   Tidies all phases, or only those flagged in affected, see tidy_affected
+ */
 	int i;
 	int replaced;
 	/*
@@ -1479,6 +1600,8 @@ tidy_phases(void)
 	 */
 	for (i = 0; i < (int)phases.size(); i++)
 	{
+		if (affected != NULL && !(*affected)[i])
+			continue;
 		select_log_k_expression(phases[i]->logk, phases[i]->rxn.logk);
 		add_other_logk(phases[i]->rxn.logk, phases[i]->add_logk);
 		phases[i]->rxn.token[0].name = phases[i]->name;
@@ -1489,6 +1612,8 @@ tidy_phases(void)
 	 */
 	for (i = 0; i < (int)phases.size(); i++)
 	{
+		if (affected != NULL && !(*affected)[i])
+			continue;
 		/*
 		 *   Rewrite equation
 		 */
@@ -1976,6 +2101,14 @@ tidy_punch(void)
 		{
 			fpunchf_heading(sformatf("%*s\t", l, "pct_err"));
 		}
+		if (current_selected_output->Get_cell_cost() == TRUE)
+		{
+			fpunchf_heading(sformatf("%*s\t", l, "cost_iter"));
+			fpunchf_heading(sformatf("%*s\t", l, "cost_retries"));
+			fpunchf_heading(sformatf("%*s\t", l, "cost_solves"));
+			fpunchf_heading(sformatf("%*s\t", l, "cost_kin_steps"));
+			fpunchf_heading(sformatf("%*s\t", l, "cost_time"));
+		}
 		/* totals */
 
 		//for (i = 0; i < punch.count_totals; i++)
@@ -2257,9 +2390,13 @@ tidy_punch(void)
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-tidy_species(void)
+tidy_species(const std::vector<bool> *affected)
 /* ---------------------------------------------------------------------- */
 {
+/*
+ *   Tidies all species, or rewrites and checks the equations of only those
+ *   flagged in affected, see tidy_affected
+ */
 	int i, j;
 	class master *master_ptr;
 	char c;
@@ -2279,6 +2416,8 @@ tidy_species(void)
 		s[i]->number = i;
 		s[i]->primary = NULL;
 		s[i]->secondary = NULL;
+		if (affected != NULL && !(*affected)[i])
+			continue;
 		if (s[i]->check_equation == TRUE)
 		{
 			species_rxn_to_trxn(s[i]);
@@ -2343,7 +2482,7 @@ tidy_species(void)
  *   Write equations for all master species in terms of primary
  *   master species, set coefficient of element in master species
  */
-	for (i = 0; i < (int)master.size(); i++)
+	for (i = 0; i < (int)master.size() && affected == NULL; i++)
 	{
 		count_trxn = 0;
 		if (master[i]->s->primary != NULL)
@@ -2364,6 +2503,8 @@ tidy_species(void)
  */
 	for (i = 0; i < (int)s.size(); i++)
 	{
+		if (affected != NULL && !(*affected)[i])
+			continue;
 		count_trxn = 0;
 		if (s[i]->primary != NULL || s[i]->secondary != NULL)
 		{
@@ -4411,6 +4552,7 @@ ss_prep(LDBLE t, cxxSS *ss_ptr, int print)
 	LDBLE xaly, xaly1, xaly2;
 	LDBLE faca, facb, spialy, facal, facbl;
 	LDBLE tol;
+	class ss_gap *gap_ptr = NULL;
 
 	if (pr.ss_assemblage == FALSE)
 		print = FALSE;
@@ -4507,6 +4649,16 @@ ss_prep(LDBLE t, cxxSS *ss_ptr, int print)
  *   Calculate miscibility and spinodal gaps
  */
 		if (tc >= t)
+		{
+			gap_ptr = ss_gap_find(t, ss_ptr);
+		}
+		if (gap_ptr != NULL)
+		{
+			ss_ptr->Set_spinodal(gap_ptr->spinodal);
+			xsm1 = gap_ptr->xsm1;
+			xsm2 = gap_ptr->xsm2;
+		}
+		else if (tc >= t)
 		{
 
 			/* search for sign changes */
@@ -4544,6 +4696,12 @@ ss_prep(LDBLE t, cxxSS *ss_ptr, int print)
 					   "\t Spinodal-gap mole fractions, component 2: %g\t%g\n",
 					   (double) xsm1, (double) xsm2));
 		converged = FALSE;
+		if (gap_ptr != NULL)
+		{
+			xc1 = gap_ptr->xc1;
+			xc2 = gap_ptr->xc2;
+			converged = TRUE;
+		}
 		if (converged == FALSE)
 		{
 			for (i = 1; i < 3; i++)
@@ -4622,6 +4780,10 @@ ss_prep(LDBLE t, cxxSS *ss_ptr, int print)
 		ss_ptr->Set_xb1(xb1);
 		ss_ptr->Set_xb2(xb2);
 	}
+	if (gap_ptr == NULL && crit_pt >= tol && tc >= t)
+	{
+		ss_gap_store(t, ss_ptr, xsm1, xsm2, xc1, xc2);
+	}
 /*
  *   Alyotropic point calculation
  */
@@ -4689,6 +4851,51 @@ ss_prep(LDBLE t, cxxSS *ss_ptr, int print)
 	return (OK);
 }
 /* ---------------------------------------------------------------------- */
+class ss_gap * Phreeqc::
+ss_gap_find(LDBLE t, cxxSS *ss_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns the gaps ss_prep found for a solid solution of the same name
+ *   at exactly temperature t with the same Guggenheim parameters, or NULL
+ */
+	std::map<std::string, std::map<LDBLE, class ss_gap> >::iterator it =
+		ss_gap_cache.find(ss_ptr->Get_name());
+	if (it == ss_gap_cache.end())
+	{
+		return (NULL);
+	}
+	std::map<LDBLE, class ss_gap>::iterator jit = it->second.find(t);
+	if (jit == it->second.end() ||
+		jit->second.ag0 != ss_ptr->Get_ag0() || jit->second.ag1 != ss_ptr->Get_ag1())
+	{
+		return (NULL);
+	}
+	return (&jit->second);
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+ss_gap_store(LDBLE t, cxxSS *ss_ptr, LDBLE xsm1, LDBLE xsm2, LDBLE xc1, LDBLE xc2)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Saves the gaps ss_prep has searched for at temperature t
+ */
+	std::map<LDBLE, class ss_gap> &gaps = ss_gap_cache[ss_ptr->Get_name()];
+	if (gaps.size() >= 256 && gaps.find(t) == gaps.end())
+	{
+		gaps.clear();
+	}
+	class ss_gap &gap = gaps[t];
+	gap.ag0 = ss_ptr->Get_ag0();
+	gap.ag1 = ss_ptr->Get_ag1();
+	gap.spinodal = ss_ptr->Get_spinodal();
+	gap.xsm1 = xsm1;
+	gap.xsm2 = xsm2;
+	gap.xc1 = xc1;
+	gap.xc2 = xc2;
+}
+/* ---------------------------------------------------------------------- */
 LDBLE Phreeqc::
 halve(LDBLE f(LDBLE x, void *), LDBLE x0, LDBLE x1, LDBLE tol)
 /* ---------------------------------------------------------------------- */
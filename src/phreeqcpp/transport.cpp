@@ -9,48 +9,7 @@
 #include "Solution.h"
 #include <limits.h>
 
-LDBLE F_Re3 = F_C_MOL / (R_KJ_DEG_MOL * 1e3);
-LDBLE tk_x2; // average tk_x of icell and jcell
-LDBLE dV_dcell; // difference in Volt among icell and jcell
-int find_current;
-char token[MAX_LENGTH];
-
-// implicit...
-std::set <std::string> dif_spec_names;
-std::set <std::string> dif_els_names;
-std::map<int, std::map<std::string, double> > neg_moles;
-std::map<std::string, double> els;
-double *Ct2, *l_tk_x2, **A, **LU, **mixf, **mixf_stag;
-int mixf_comp_size = 0;
-
-struct CURRENT_CELLS
-{
-	LDBLE dif, ele, R; // diffusive and electric components, relative cell resistance
-} *current_cells;
-LDBLE sum_R, sum_Rd; // sum of R, sum of (current_cells[0].dif - current_cells[i].dif) * R
-struct V_M   // For calculating Vinograd and McBain's zero-charge, diffusive tranfer of individual solutes
-{
-	LDBLE grad, D, z, c, zc, Dz, Dzc;
-	LDBLE b_ij; // harmonic mean of cell properties, with EDL enrichment
-};
-struct CT /* summed parts of V_M and mcd transfer in a timestep for all cells, for free + DL water */
-{
-	LDBLE kgw, dl_s, Dz2c, Dz2c_stag, visc1, visc2, J_ij_sum;
-	LDBLE A_ij_il, Dz2c_il, mixf_il;
-	int J_ij_count_spec, J_ij_il_count_spec;
-	struct V_M *v_m, *v_m_il;
-	class J_ij *J_ij, *J_ij_il;
-	int count_m_s;
-	class M_S *m_s;
-	int v_m_size, J_ij_size, m_s_size;
-} *ct = NULL;
-std::map<int, std::map<std::string, J_ij_save> > cell_J_ij;
-struct MOLES_ADDED /* total moles added to balance negative conc's */
-{
-	char *name;
-	LDBLE moles;
-} *moles_added;
-int count_moles_added;
+static const LDBLE F_Re3 = F_C_MOL / (R_KJ_DEG_MOL * 1e3);
 
 #if defined(PHREEQCI_GUI)
 #ifdef _DEBUG
@@ -78,6 +37,7 @@ transport(void)
 	LDBLE step_fraction;
 
 	state = TRANSPORT;
+	cell_costs_reset(((int) cell_data.size() > all_cells) ? (int) cell_data.size() : all_cells);
 	diffc_tr = diffc;
 	diffc_max = 0.0;
 	transp_surf = warn_fixed_Surf = warn_MCD_X = 0;
@@ -5335,30 +5295,9 @@ std::string charge_name, LDBLE f2, LDBLE new_Dw)
 	*   Add in surface_ptr2
 	*/
 	// Only components with same charge as component k
-	cxxSurface addee(*surface_ptr2);
-	addee.Get_surface_comps().clear();
-	addee.Get_surface_charges().clear();
-
-	for (std::vector<cxxSurfaceComp>::iterator it = surface_ptr2->Get_surface_comps().begin();
-		it != surface_ptr2->Get_surface_comps().end(); it++)
-	{
-		if (it->Get_charge_name() == charge_name)
-		{
-			addee.Get_surface_comps().push_back(*it);
-		}
-	}
-	for (std::vector<cxxSurfaceCharge>::iterator it = surface_ptr2->Get_surface_charges().begin();
-		it != surface_ptr2->Get_surface_charges().end(); it++)
-	{
-		if (it->Get_name() == charge_name)
-		{
-			addee.Get_surface_charges().push_back(*it);
-		}
-	}
-
 	if (f2 == 0)
 		f2 = 1e-30;
-	temp_surface.add(addee, f2);
+	temp_surface.add(*surface_ptr2, f2, charge_name);
 	temp_surface.Set_transport(false);
 	for (size_t i = 0; i < temp_surface.Get_surface_comps().size(); i++)
 	{
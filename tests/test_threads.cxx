@@ -0,0 +1,321 @@
+//
+// Runs PHREEQC inputs on several IPhreeqc instances at once.
+//
+// The inputs are first run -r times in turn on a single instance; the
+// output and selected-output strings of these runs are the reference.
+// Then, for 1, 2, 4, ... threads, every thread creates its own instance,
+// loads the database and makes the same sequence of runs, comparing each
+// result with the reference.  Any difference means that instances share
+// state.
+//
+// Usage: test_threads [-t max_threads] [-r repeats] [-o results.tsv] [-v 1] database input [input ...]
+//
+// -v 1 prints the first differing line of every mismatch.
+//
+// The table printed (and written with -o) gives throughput against
+// thread count and can be kept as a baseline for later runs.
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <IPhreeqc.h>
+
+struct Result
+{
+	int errors;
+	std::string output;
+	std::string selected_output;
+	std::string error_string;
+};
+
+static bool ReadFile(const char *filename, std::string &text)
+{
+	std::ifstream ifs(filename, std::ios_base::binary);
+	if (!ifs.is_open())
+	{
+		return false;
+	}
+	std::ostringstream oss;
+	oss << ifs.rdbuf();
+	text = oss.str();
+	return true;
+}
+
+// removes the run time, and the dashed lines around it, which differ
+// from run to run
+static std::string Normalize(const char *output)
+{
+	static const char end_of_run[] = "End of Run after";
+	std::istringstream iss(output);
+	std::vector<std::string> lines;
+	std::string line;
+	while (std::getline(iss, line))
+	{
+		lines.push_back(line);
+	}
+	std::vector<bool> keep(lines.size(), true);
+	for (size_t i = 0; i < lines.size(); ++i)
+	{
+		if (lines[i].compare(0, sizeof(end_of_run) - 1, end_of_run) == 0)
+		{
+			keep[i] = false;
+			if (i > 0 && lines[i - 1].find_first_not_of('-') == std::string::npos) keep[i - 1] = false;
+			if (i + 1 < lines.size() && lines[i + 1].find_first_not_of('-') == std::string::npos) keep[i + 1] = false;
+		}
+	}
+	std::ostringstream oss;
+	for (size_t i = 0; i < lines.size(); ++i)
+	{
+		if (keep[i])
+		{
+			oss << lines[i] << "\n";
+		}
+	}
+	return oss.str();
+}
+
+// prints the first line that differs
+static void Report(const char *name, const std::string &expected, const std::string &actual)
+{
+	std::istringstream e(expected), a(actual);
+	std::string el, al;
+	for (int line = 1; ; ++line)
+	{
+		bool more_e = (bool)std::getline(e, el);
+		bool more_a = (bool)std::getline(a, al);
+		if (!more_e && !more_a)
+		{
+			return;
+		}
+		if (more_e != more_a || el != al)
+		{
+			std::cerr << name << " line " << line << ":\n  expected: " << el << "\n  actual:   " << al << "\n";
+			return;
+		}
+	}
+}
+
+// runs one input on an instance that has a database loaded
+static void Run(int id, const std::string &input, Result &result)
+{
+	result.errors          = ::RunString(id, input.c_str());
+	result.output          = Normalize(::GetOutputString(id));
+	result.selected_output = ::GetSelectedOutputString(id);
+	result.error_string    = ::GetErrorString(id);
+}
+
+static int Create(const std::string &database)
+{
+	int id = ::CreateIPhreeqc();
+	if (id < 0)
+	{
+		return id;
+	}
+	// every instance would otherwise write phreeqc.<id>.* and the
+	// -file names given in the inputs
+	::SetOutputFileOn(id, 0);
+	::SetErrorFileOn(id, 0);
+	::SetLogFileOn(id, 0);
+	::SetDumpFileOn(id, 0);
+	::SetSelectedOutputFileOn(id, 0);
+	::SetOutputStringOn(id, 1);
+	::SetSelectedOutputStringOn(id, 1);
+	if (::LoadDatabaseString(id, database.c_str()) != 0)
+	{
+		std::cerr << ::GetErrorString(id);
+		::DestroyIPhreeqc(id);
+		return -1;
+	}
+	return id;
+}
+
+class Worker
+{
+public:
+	Worker(const std::string &db, const std::vector<std::string> &in, const std::vector<Result> &ref, int r, bool v)
+		: database(db), inputs(in), reference(ref), repeats(r), verbose(v), runs(0), mismatches(0)
+	{
+	}
+	void operator()(void)
+	{
+		int id = Create(this->database);
+		if (id < 0)
+		{
+			this->mismatches++;
+			return;
+		}
+		Result result;
+		for (int r = 0; r < this->repeats; ++r)
+		{
+			for (size_t i = 0; i < this->inputs.size(); ++i)
+			{
+				// an instance keeps its state from one run to the next
+				const Result &expected = this->reference[r * this->inputs.size() + i];
+				Run(id, this->inputs[i], result);
+				this->runs++;
+				if (result.errors          != expected.errors          ||
+					result.output          != expected.output          ||
+					result.selected_output != expected.selected_output ||
+					result.error_string    != expected.error_string)
+				{
+					this->mismatches++;
+					if (this->verbose)
+					{
+						std::ostringstream name;
+						name << "input " << i + 1 << ", repeat " << r + 1;
+						Report((name.str() + ", output").c_str(), expected.output, result.output);
+						Report((name.str() + ", selected output").c_str(), expected.selected_output, result.selected_output);
+						Report((name.str() + ", errors").c_str(), expected.error_string, result.error_string);
+					}
+				}
+			}
+		}
+		::DestroyIPhreeqc(id);
+	}
+
+	const std::string &database;
+	const std::vector<std::string> &inputs;
+	const std::vector<Result> &reference;
+	int repeats;
+	bool verbose;
+	int runs;
+	int mismatches;
+};
+
+int main(int argc, char *argv[])
+{
+	int max_threads = (int)std::thread::hardware_concurrency();
+	int repeats = 1;
+	const char *results_file = NULL;
+	bool verbose = false;
+
+	int arg = 1;
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+	{
+		if (::strcmp(argv[arg], "-t") == 0)
+		{
+			max_threads = ::atoi(argv[arg + 1]);
+		}
+		else if (::strcmp(argv[arg], "-r") == 0)
+		{
+			repeats = ::atoi(argv[arg + 1]);
+		}
+		else if (::strcmp(argv[arg], "-o") == 0)
+		{
+			results_file = argv[arg + 1];
+		}
+		else if (::strcmp(argv[arg], "-v") == 0)
+		{
+			verbose = (::atoi(argv[arg + 1]) != 0);
+		}
+		else
+		{
+			break;
+		}
+	}
+	if (max_threads < 1)
+	{
+		max_threads = 1;
+	}
+	if (argc - arg < 2 || repeats < 1)
+	{
+		std::cerr << "Usage: " << argv[0] << " [-t max_threads] [-r repeats] [-o results.tsv] [-v 1] database input [input ...]\n";
+		return EXIT_FAILURE;
+	}
+
+	std::string database;
+	if (!ReadFile(argv[arg], database))
+	{
+		std::cerr << "Unable to open " << argv[arg] << ".\n";
+		return EXIT_FAILURE;
+	}
+	std::vector<std::string> inputs;
+	for (++arg; arg < argc; ++arg)
+	{
+		std::string text;
+		if (!ReadFile(argv[arg], text))
+		{
+			std::cerr << "Unable to open " << argv[arg] << ".\n";
+			return EXIT_FAILURE;
+		}
+		inputs.push_back(text);
+	}
+
+	// serial reference
+	std::vector<Result> reference(repeats * inputs.size());
+	int id = Create(database);
+	if (id < 0)
+	{
+		return EXIT_FAILURE;
+	}
+	for (int r = 0; r < repeats; ++r)
+	{
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			Run(id, inputs[i], reference[r * inputs.size() + i]);
+		}
+	}
+	::DestroyIPhreeqc(id);
+
+	std::vector<int> counts;
+	for (int t = 1; t < max_threads; t *= 2)
+	{
+		counts.push_back(t);
+	}
+	counts.push_back(max_threads);
+
+	std::ostringstream table;
+	table << "threads\truns\tmismatches\tseconds\truns_per_second\tspeedup\n";
+	double serial_rate = 0;
+	int failures = 0;
+	for (size_t c = 0; c < counts.size(); ++c)
+	{
+		std::vector<Worker> workers(counts[c], Worker(database, inputs, reference, repeats, verbose));
+		std::vector<std::thread> threads;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (size_t w = 0; w < workers.size(); ++w)
+		{
+			threads.push_back(std::thread(std::ref(workers[w])));
+		}
+		for (size_t w = 0; w < threads.size(); ++w)
+		{
+			threads[w].join();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		int runs = 0, mismatches = 0;
+		for (size_t w = 0; w < workers.size(); ++w)
+		{
+			runs += workers[w].runs;
+			mismatches += workers[w].mismatches;
+		}
+		failures += mismatches;
+		double rate = (seconds > 0) ? runs / seconds : 0;
+		if (c == 0)
+		{
+			serial_rate = rate;
+		}
+		table << counts[c] << "\t" << runs << "\t" << mismatches << "\t" << seconds << "\t"
+			<< rate << "\t" << ((serial_rate > 0) ? rate / serial_rate : 0) << "\n";
+	}
+
+	std::cout << table.str();
+	if (results_file)
+	{
+		std::ofstream ofs(results_file);
+		ofs << table.str();
+	}
+	if (failures)
+	{
+		std::cerr << failures << " run(s) differed from the serial reference.\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}